@@ -5,9 +5,13 @@
 module;
 
 #include "../ScopedTimer/ScopedTimer.h"
+#include "../Allocator/HugePageAllocator.h"
+#include "../Allocator/AlignedAllocator.h"
 
 module modern_cpp:algorithms;
 
+import :perf_counter;
+
 namespace Algorithms {
 
     //static constexpr int Size = 100'000'000;  // release
@@ -428,6 +432,243 @@ namespace Algorithms {
         test_copying_std_copy_parallelized();
         test_copying_std_memcpy();
     }
+
+    // =================================================================================
+    // Large vectors: std::allocator vs memory mapped with (huge) pages
+    // =================================================================================
+
+    using Allocator::HugePages;
+    using Allocator::HugePageAllocator;
+    using Allocator::PageMapper;
+
+    // number of random reads per measurement
+    static constexpr size_t RandomReads = 4'000'000;
+
+    struct LargeVectorResult
+    {
+        double                       m_firstTouch;    // milliseconds
+        double                       m_fill;          // GB/s
+        double                       m_copy;          // GB/s
+        double                       m_randomRead;    // nanoseconds per read
+        std::optional<std::uint64_t> m_tlbMisses;     // per 1000 random reads
+        std::optional<size_t>        m_hugePageBytes; // both vectors, transparent huge pages only
+    };
+
+    template <typename TFunc>
+    static double measureMilliseconds(TFunc func)
+    {
+        const auto begin{ std::chrono::steady_clock::now() };
+        func();
+        const auto end{ std::chrono::steady_clock::now() };
+        return std::chrono::duration<double, std::milli>{ end - begin }.count();
+    }
+
+    static double gigabytesPerSecond(size_t bytes, double milliseconds)
+    {
+        return static_cast<double>(bytes) / (milliseconds * 1'000'000.0);
+    }
+
+    template <typename TVector>
+    static LargeVectorResult measureLargeVector()
+    {
+        constexpr size_t Bytes{ Size * sizeof(double) };
+
+        LargeVectorResult result{};
+
+        // allocation and value-initialization: every page is touched for the first time
+        std::optional<TVector> source{};
+        result.m_firstTouch = measureMilliseconds([&] () { source.emplace(Size); });
+
+        // the pages exist now: memory bandwidth only
+        const double fill{ measureMilliseconds([&] () { std::fill(source->begin(), source->end(), 123.0); }) };
+        result.m_fill = gigabytesPerSecond(Bytes, fill);
+
+        TVector target(Size);
+        const double copy{ measureMilliseconds([&] () { std::copy(source->begin(), source->end(), target.begin()); }) };
+        result.m_copy = gigabytesPerSecond(2 * Bytes, copy);
+
+        result.m_hugePageBytes = PageMapper::transparentHugePageBytes();
+
+        // random reads: (almost) every read needs another page - the TLB decides
+        PerfCounter tlbMisses{ PerfEvent::DataTlbMisses };
+
+        double sum{};
+        std::uint64_t state{ 12345 };
+
+        tlbMisses.start();
+        const double reads{ measureMilliseconds([&] () {
+            for (size_t i{}; i != RandomReads; ++i) {
+                state = state * 6364136223846793005ull + 1442695040888963407ull;
+                sum += target[(state >> 33) % Size];
+            }
+        }) };
+        const auto misses{ tlbMisses.stop() };
+
+        result.m_randomRead = reads * 1'000'000.0 / static_cast<double>(RandomReads);
+        if (misses.has_value()) {
+            result.m_tlbMisses = misses.value() * 1000 / RandomReads;
+        }
+
+        if (sum != 123.0 * RandomReads) {
+            std::println("Unexpected sum: {}", sum);
+        }
+
+        return result;
+    }
+
+    template <typename TVector>
+    static void benchmarkLargeVector(std::string_view name)
+    {
+        LargeVectorResult result{ measureLargeVector<TVector>() };
+
+        std::string tlbMisses{ "-" };
+        if (result.m_tlbMisses.has_value()) {
+            tlbMisses = std::to_string(result.m_tlbMisses.value());
+        }
+
+        std::string hugePages{ "-" };
+        if (result.m_hugePageBytes.has_value()) {
+            hugePages = std::to_string(result.m_hugePageBytes.value() / (1024 * 1024));
+        }
+
+        std::println("{:<30}{:>10.1f}{:>10.2f}{:>10.2f}{:>12.1f}{:>14}{:>10}",
+            name, result.m_firstTouch, result.m_fill, result.m_copy, result.m_randomRead, tlbMisses, hugePages);
+    }
+
+    static void test_huge_pages()
+    {
+        std::println("Large vectors: {} doubles ({} MB), page size {} KB, huge page size {} KB",
+            Size, Size * sizeof(double) / (1024 * 1024), PageMapper::pageSize() / 1024, PageMapper::HugePageSize / 1024);
+        std::println();
+
+        std::println("{:<30}{:>10}{:>10}{:>10}{:>12}{:>14}{:>10}",
+            "Allocator", "Touch ms", "Fill GB/s", "Copy GB/s", "Random ns", "dTLB/1000", "THP MB");
+
+        benchmarkLargeVector<std::vector<double>>("std::allocator");
+        benchmarkLargeVector<Allocator::HugePageVector<double, HugePages::None>>("mmap (4 KB pages)");
+        benchmarkLargeVector<Allocator::HugePageVector<double, HugePages::None, true>>("mmap + MAP_POPULATE");
+        benchmarkLargeVector<Allocator::HugePageVector<double, HugePages::Transparent>>("mmap + MADV_HUGEPAGE");
+        benchmarkLargeVector<Allocator::HugePageVector<double, HugePages::Transparent, true>>("MADV_HUGEPAGE + populate");
+        benchmarkLargeVector<Allocator::HugePageVector<double, HugePages::Explicit>>("MAP_HUGETLB (or fallback)");
+
+        const PageMapper::Statistics statistics{ PageMapper::statistics() };
+
+        std::println();
+        std::println("Mappings: {}, explicit huge pages: {}, transparent huge pages: {}, fallbacks: {}",
+            statistics.m_mappings, statistics.m_explicitHugePages,
+            statistics.m_transparentHugePages, statistics.m_fallbacks);
+    }
+
+    // =================================================================================
+    // Aligned vs misaligned buffers: fill, copy and dot product
+    // =================================================================================
+
+    using Allocator::AlignedVector;
+    using Allocator::CacheLineSize;
+
+    // aligned fast paths: with 'std::assume_aligned' the compiler may use aligned
+    // loads and stores without peeling, otherwise it has to handle any address
+    static void fillValues(std::span<double> values, double value)
+    {
+        if (Allocator::isAligned(values.data(), CacheLineSize)) {
+            double* first{ std::assume_aligned<CacheLineSize>(values.data()) };
+            std::fill(first, first + values.size(), value);
+        }
+        else {
+            std::fill(values.begin(), values.end(), value);
+        }
+    }
+
+    static void copyValues(std::span<const double> source, std::span<double> target)
+    {
+        if (Allocator::isAligned(source.data(), CacheLineSize) && Allocator::isAligned(target.data(), CacheLineSize)) {
+            const double* first{ std::assume_aligned<CacheLineSize>(source.data()) };
+            std::copy(first, first + source.size(), std::assume_aligned<CacheLineSize>(target.data()));
+        }
+        else {
+            std::copy(source.begin(), source.end(), target.begin());
+        }
+    }
+
+    // 'std::execution::unseq' allows the vectorization of the floating-point reduction
+    static double dotProduct(std::span<const double> x, std::span<const double> y)
+    {
+        if (Allocator::isAligned(x.data(), CacheLineSize) && Allocator::isAligned(y.data(), CacheLineSize)) {
+            const double* first{ std::assume_aligned<CacheLineSize>(x.data()) };
+            return std::transform_reduce(std::execution::unseq,
+                first, first + x.size(), std::assume_aligned<CacheLineSize>(y.data()), 0.0);
+        }
+        else {
+            return std::transform_reduce(std::execution::unseq, x.begin(), x.end(), y.begin(), 0.0);
+        }
+    }
+
+    // 'offset': distance in bytes to a 64-byte boundary
+    static void benchmarkAlignment(size_t size, size_t offset, size_t totalElements)
+    {
+        AlignedVector<std::byte> bufferX(size * sizeof(double) + CacheLineSize);
+        AlignedVector<std::byte> bufferY(size * sizeof(double) + CacheLineSize);
+
+        // the buffers hold (trivial) doubles, the bytes are reused as storage
+        std::span<double> x{ reinterpret_cast<double*>(bufferX.data() + offset), size };
+        std::span<double> y{ reinterpret_cast<double*>(bufferY.data() + offset), size };
+
+        fillValues(x, 1.0);
+        fillValues(y, 2.0);
+
+        const size_t repetitions{ std::max<size_t>(totalElements / size, 1) };
+        const double elements{ static_cast<double>(repetitions * size) };
+
+        double sum{};
+
+        const double fill{ measureMilliseconds([&] () {
+            for (size_t i{}; i != repetitions; ++i) {
+                fillValues(x, static_cast<double>(i));
+            }
+        }) };
+
+        const double copy{ measureMilliseconds([&] () {
+            for (size_t i{}; i != repetitions; ++i) {
+                copyValues(x, y);
+            }
+        }) };
+
+        const double dot{ measureMilliseconds([&] () {
+            for (size_t i{}; i != repetitions; ++i) {
+                sum += dotProduct(x, y);
+            }
+        }) };
+
+        std::println("{:>12}{:>10}{:>14.3f}{:>14.3f}{:>14.3f}    (Sum: {})",
+            size, offset, fill * 1'000'000.0 / elements, copy * 1'000'000.0 / elements, dot * 1'000'000.0 / elements, sum);
+    }
+
+    static void test_aligned_buffers()
+    {
+        constexpr size_t TotalElements{ 200'000'000 };
+
+        // over-aligned types: 'new' calls 'operator new(size_t, std::align_val_t)'
+        struct alignas(CacheLineSize) CacheLine
+        {
+            double m_values[CacheLineSize / sizeof(double)];
+        };
+
+        std::unique_ptr<CacheLine> line{ std::make_unique<CacheLine>() };
+        std::println("alignof(CacheLine): {}, aligned: {}", alignof(CacheLine), Allocator::isAligned(line.get(), CacheLineSize));
+
+        Allocator::AlignedArray<double> array{ Allocator::makeAlignedArray<double>(1000) };
+        std::println("makeAlignedArray<double>: aligned: {}", Allocator::isAligned(array.get(), CacheLineSize));
+        std::println();
+
+        std::println("Nanoseconds per element:");
+        std::println("{:>12}{:>10}{:>14}{:>14}{:>14}", "Size", "Offset", "Fill", "Copy", "Dot");
+
+        for (size_t size : { size_t{ 2'048 }, size_t{ 65'536 }, static_cast<size_t>(Size) }) {
+            for (size_t offset : { 0, 8, 16, 32 }) {
+                benchmarkAlignment(size, offset, TotalElements);
+            }
+        }
+    }
 }
 
 void main_algorithms()
@@ -437,6 +678,8 @@ void main_algorithms()
     test_initialization();
     test_sum_calculation();
     test_copying();
+    test_huge_pages();
+    test_aligned_buffers();
 }
 
 // =====================================================================================
@@ -0,0 +1,133 @@
+// ===========================================================================
+// AlignedAllocator.h // Cache-line and SIMD aligned memory
+// ===========================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// 'operator new' guarantees an alignment of __STDCPP_DEFAULT_NEW_ALIGNMENT__ (16 bytes),
+// a 'std::vector<double>' may start anywhere within a cache line (64 bytes).
+// SIMD kernels then need unaligned loads, and a 32-byte (AVX) or 64-byte (AVX-512)
+// load may span two cache lines.
+//
+// Since C++17 'new' respects the alignment of over-aligned types ('alignas'),
+// it calls 'operator new(size_t, std::align_val_t)'. The allocator below uses the
+// same overload to align the elements of a container.
+
+namespace Allocator {
+
+    inline constexpr std::size_t CacheLineSize{ 64 };
+
+    inline bool isAligned(const void* ptr, std::size_t alignment) {
+        return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+    }
+
+    inline constexpr std::size_t Unreachable{ static_cast<std::size_t>(-1) };
+
+    // number of elements to skip until 'ptr' reaches an 'alignment' boundary,
+    // 'Unreachable' if 'ptr' isn't aligned to 'sizeof(T)'
+    template <typename T>
+    std::size_t elementsToAlignment(const T* ptr, std::size_t alignment) {
+
+        const std::size_t offset{ reinterpret_cast<std::uintptr_t>(ptr) % alignment };
+
+        if (offset % sizeof(T) != 0) {
+            return Unreachable;
+        }
+
+        return (alignment - offset) % alignment / sizeof(T);
+    }
+
+    template <typename T, std::size_t Alignment = CacheLineSize>
+    class AlignedAllocator
+    {
+        static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+        static_assert(Alignment >= alignof(T), "Alignment must not be weaker than the alignment of T");
+
+    public:
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        static constexpr std::size_t alignment{ Alignment };
+
+        template <typename U>
+        struct rebind
+        {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        // c'tors
+        AlignedAllocator() noexcept = default;
+
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+        // allocator interface
+        T* allocate(std::size_t n) {
+
+            if (n > static_cast<std::size_t>(-1) / sizeof(T)) {
+                throw std::bad_array_new_length{};
+            }
+
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ Alignment }));
+        }
+
+        void deallocate(T* p, std::size_t n) noexcept {
+            ::operator delete(p, n * sizeof(T), std::align_val_t{ Alignment });
+        }
+
+        template <typename U>
+        bool operator== (const AlignedAllocator<U, Alignment>&) const noexcept {
+            return true;
+        }
+    };
+
+    template <typename T, std::size_t Alignment = CacheLineSize>
+    using AlignedVector = std::vector<T, AlignedAllocator<T, Alignment>>;
+
+    // =======================================================================
+    // arrays of a run-time size with 'new T[]' semantics
+
+    template <typename T, std::size_t Alignment = CacheLineSize>
+    struct AlignedArrayDeleter
+    {
+        std::size_t m_size;
+
+        void operator() (T* ptr) const noexcept {
+            std::destroy_n(ptr, m_size);
+            ::operator delete(ptr, std::align_val_t{ Alignment });
+        }
+    };
+
+    template <typename T, std::size_t Alignment = CacheLineSize>
+    using AlignedArray = std::unique_ptr<T[], AlignedArrayDeleter<T, Alignment>>;
+
+    // elements are value-initialized, like 'new T[size]{}'
+    template <typename T, std::size_t Alignment = CacheLineSize>
+    AlignedArray<T, Alignment> makeAlignedArray(std::size_t size) {
+
+        static_assert(Alignment >= alignof(T), "Alignment must not be weaker than the alignment of T");
+
+        void* memory{ ::operator new(size * sizeof(T), std::align_val_t{ Alignment }) };
+
+        try {
+            std::uninitialized_value_construct_n(static_cast<T*>(memory), size);
+        }
+        catch (...) {
+            ::operator delete(memory, std::align_val_t{ Alignment });
+            throw;
+        }
+
+        return AlignedArray<T, Alignment>{ static_cast<T*>(memory), AlignedArrayDeleter<T, Alignment>{ size } };
+    }
+}
+
+// ===========================================================================
+// End-of-File
+// ===========================================================================
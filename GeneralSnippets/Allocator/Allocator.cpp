@@ -5,6 +5,8 @@
 module modern_cpp:allocator;
 
 import :dummy;
+import :memory_resources;
+import :growth_vector;
 
 namespace Allocator {
 
@@ -132,6 +134,88 @@ namespace Allocator {
         }
     }
 
+    // =================================================================================
+    // the same tests with polymorphic allocators ('std::pmr'):
+    // instead of the output of 'MyAlloc' the requests are counted by a 'TrackingResource'
+
+    static void printTrackingResource(const TrackingResource& resource) {
+
+        const auto& stats{ resource.stats() };
+        std::cout << "allocations: " << stats.m_allocations
+                  << ", bytes: " << stats.m_bytesAllocated
+                  << ", peak: " << stats.m_peakBytesInUse << std::endl;
+
+        // histogram of the request sizes
+        const auto& histogram{ resource.histogram() };
+        for (size_t k{}; k != histogram.size(); ++k) {
+            if (histogram[k] != 0) {
+                std::cout << "  <= " << std::setw(6) << (size_t{ 1 } << k) << " bytes: "
+                          << std::string(histogram[k], '*') << std::endl;
+            }
+        }
+    }
+
+    static void test_04_pmr_allocator() {
+
+        TrackingResource tracking{};
+        {
+            std::pmr::vector<int> vec{ &tracking };
+            // vec.reserve(Max);  // put into comments ... or not
+
+            for (int n = 0; n < Max; ++n) {
+                vec.push_back(n);
+            }
+        }
+        printTrackingResource(tracking);
+    }
+
+    static void test_05_pmr_allocator() {
+
+        // the buffer is used first, the upstream resource only when the buffer is exhausted
+        std::array<std::byte, 256> buffer;
+        TrackingResource tracking{};
+        std::pmr::monotonic_buffer_resource resource{ buffer.data(), buffer.size(), &tracking };
+
+        std::cout << "Insertion: emplace_back - std::pmr::vector" << std::endl;
+        std::pmr::vector<Dummy> vec{ &resource };
+        // vec.reserve(AnotherMax);   // put into comments ... or not
+        for (int n = 0; n < AnotherMax; ++n) {
+            vec.emplace_back(n);
+        }
+
+        printTrackingResource(tracking);
+    }
+
+    // =================================================================================
+    // vector with a configurable growth policy: every reallocation is recorded
+
+    template <typename TVector>
+    static void printReallocations(const TVector& vec) {
+
+        for (const Reallocation& reallocation : vec.reallocations()) {
+            std::cout << "  capacity " << std::setw(4) << reallocation.m_oldCapacity
+                      << " => " << std::setw(4) << reallocation.m_newCapacity
+                      << ", bytes moved: " << std::setw(4) << reallocation.m_bytesMoved
+                      << (reallocation.m_inPlace ? " (in place)" : "") << std::endl;
+        }
+    }
+
+    static void test_06_growth_vector() {
+
+        std::cout << "GrowthVector<int> - golden ratio, relocation with 'realloc':" << std::endl;
+        GrowthVector<int, GrowthPolicy::GoldenRatio, true> numbers;
+        for (int n = 0; n < 100; ++n) {
+            numbers.push_back(n);
+        }
+        printReallocations(numbers);
+
+        std::cout << "GrowthVector<Dummy> - factor 1.5, relocation with move c'tor:" << std::endl;
+        GrowthVector<Dummy, GrowthPolicy::Factor1_5, true> vec;
+        for (int n = 0; n < AnotherMax; ++n) {
+            vec.emplace_back(n);
+        }
+        printReallocations(vec);
+    }
 }
 
 void main_allocator()
@@ -142,6 +226,9 @@ void main_allocator()
     test_03a_allocator();
     test_03b_allocator();
     test_03c_allocator();
+    test_04_pmr_allocator();
+    test_05_pmr_allocator();
+    test_06_growth_vector();
 }
 
 // =====================================================================================
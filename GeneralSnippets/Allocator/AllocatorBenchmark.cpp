@@ -0,0 +1,604 @@
+// =====================================================================================
+// AllocatorBenchmark.cpp // Custom Allocators and Memory Resources in STL Containers
+// =====================================================================================
+
+module modern_cpp:allocator;
+
+import :allocators;
+import :memory_resources;
+import :thread_caching_allocator;
+import :growth_vector;
+import :dummy;
+
+namespace AllocatorBenchmark {
+
+    using namespace Allocator;
+
+    // node size of 'std::list<int>' and 'std::map<int, int>' with MSVC and libstdc++: 24 to 48 bytes
+    constexpr size_t NodeBlockSize{ 48 };
+
+    constexpr size_t StackBufferSize{ 64 * 1024 };
+
+    static void printStats(std::string_view name, const AllocationStats& stats)
+    {
+        std::println("  {:<16} Allocations: {:>6}  Deallocations: {:>6}  Bytes: {:>8}  Peak: {:>8}  Fallbacks: {:>6}",
+            name, stats.m_allocations, stats.m_deallocations, stats.m_bytesAllocated, stats.m_peakBytesInUse, stats.m_fallbacks);
+    }
+
+    static void test_allocators_01()
+    {
+        std::println("std::list<int> with PoolAllocator:");
+
+        PoolResource pool{ NodeBlockSize };
+        {
+            std::list<int, PoolAllocator<int>> list{ PoolAllocator<int>{ &pool } };
+
+            for (int n{}; n != 1000; ++n) {
+                list.push_back(n);
+            }
+
+            // released nodes are reused by the next insertions
+            list.remove_if([](int n) { return n % 2 == 0; });
+            for (int n{}; n != 500; ++n) {
+                list.push_front(n);
+            }
+
+            std::println("  Elements: {}, Slabs: {}", list.size(), pool.slabs());
+        }
+        printStats("PoolAllocator", pool.stats());
+
+        std::println("std::vector<int> with StackAllocator:");
+
+        StackArena<1024> buffer{};
+        {
+            std::vector<int, StackAllocator<int, 1024>> vec{ StackAllocator<int, 1024>{ &buffer } };
+
+            // without 'reserve': the buffer overflows after some reallocations
+            for (int n{}; n != 200; ++n) {
+                vec.push_back(n);
+            }
+        }
+        printStats("StackAllocator", buffer.stats());
+
+        std::println("std::map<int, int> with ArenaAllocator:");
+
+        MonotonicArena arena{};
+        {
+            using Alloc = ArenaAllocator<std::pair<const int, int>>;
+
+            std::map<int, int, std::less<int>, Alloc> map{ Alloc{ &arena } };
+
+            for (int n{}; n != 1000; ++n) {
+                map[n] = n * n;
+            }
+        }
+        printStats("ArenaAllocator", arena.stats());
+        arena.release();
+
+        std::println();
+    }
+
+    // =================================================================================
+
+    // workloads: 'TAlloc' is rebound to the value type of the container
+
+    template <typename TAlloc>
+    static size_t workloadVectorDummy(size_t size, const TAlloc& alloc)
+    {
+        using Alloc = typename std::allocator_traits<TAlloc>::template rebind_alloc<Dummy>;
+
+        // no 'reserve': every reallocation moves all elements
+        std::vector<Dummy, Alloc> vec{ Alloc{ alloc } };
+        for (size_t i{}; i != size; ++i) {
+            vec.emplace_back(static_cast<int>(i));
+        }
+
+        size_t sum{};
+        for (auto& dummy : vec) {
+            sum += static_cast<size_t>(dummy.getValue());
+        }
+        return sum;
+    }
+
+    template <typename TAlloc>
+    static size_t workloadList(size_t size, const TAlloc& alloc)
+    {
+        using Alloc = typename std::allocator_traits<TAlloc>::template rebind_alloc<int>;
+
+        std::list<int, Alloc> list{ Alloc{ alloc } };
+        for (size_t i{}; i != size; ++i) {
+            list.push_back(static_cast<int>(i));
+        }
+
+        // churn: remove every second element, insert the same number again
+        list.remove_if([](int n) { return n % 2 == 0; });
+        for (size_t i{}; i != size / 2; ++i) {
+            list.push_front(static_cast<int>(i));
+        }
+
+        return std::accumulate(list.begin(), list.end(), size_t{});
+    }
+
+    template <typename TAlloc>
+    static size_t workloadMap(size_t size, const TAlloc& alloc)
+    {
+        using Alloc = typename std::allocator_traits<TAlloc>::template rebind_alloc<std::pair<const int, int>>;
+
+        std::map<int, int, std::less<int>, Alloc> map{ Alloc{ alloc } };
+
+        // keys in pseudo random order
+        std::uint32_t key{ 1 };
+        for (size_t i{}; i != size; ++i) {
+            key = key * 1664525u + 1013904223u;
+            map[static_cast<int>(key % (4 * size))] = static_cast<int>(i);
+        }
+
+        size_t sum{};
+        for (const auto& [k, v] : map) {
+            sum += static_cast<size_t>(v);
+        }
+        return sum;
+    }
+
+    // =================================================================================
+
+    // number of elements per measurement, independent of the container size
+    constexpr size_t ElementsPerMeasurement{ 2000000 };
+
+    // one untimed run with statistics, then the timed repetitions
+    template <typename TFunc>
+    static void measure(std::string_view name, size_t size, const AllocationStats* stats, TFunc workload)
+    {
+        const size_t repetitions{ std::max<size_t>(ElementsPerMeasurement / size, 1) };
+
+        size_t checksum{ workload() };
+
+        std::string allocations{ "-" };
+        std::string peak{ "-" };
+        std::string fallbacks{ "-" };
+        if (stats != nullptr) {
+            allocations = std::to_string(stats->m_allocations);
+            peak = std::to_string(stats->m_peakBytesInUse);
+            fallbacks = std::to_string(stats->m_fallbacks);
+        }
+
+        const auto begin{ std::chrono::steady_clock::now() };
+
+        for (size_t i{}; i != repetitions; ++i) {
+            checksum += workload();
+        }
+
+        const auto end{ std::chrono::steady_clock::now() };
+
+        const double nanoseconds{ std::chrono::duration<double, std::nano>{ end - begin }.count() };
+
+        std::println("  {:<24}{:>8.2f} ns/element  Allocations: {:>7}  Peak: {:>9}  Fallbacks: {:>5}  (Checksum: {})",
+            name, nanoseconds / static_cast<double>(repetitions * size), allocations, peak, fallbacks, checksum);
+    }
+
+    template <typename TWorkload>
+    static void benchmarkWorkload(std::string_view title, TWorkload workload)
+    {
+        std::println("Benchmark - {}", title);
+
+        for (size_t size : { 100, 1000, 100000 }) {
+
+            std::println("Elements: {}", size);
+
+            measure("std::allocator", size, nullptr, [&] {
+                return workload(size, std::allocator<int>{});
+            });
+
+            MonotonicArena arena{};
+            measure("ArenaAllocator", size, &arena.stats(), [&] {
+                arena.resetStats();
+                size_t result{ workload(size, ArenaAllocator<int>{ &arena }) };
+                arena.release();
+                return result;
+            });
+
+            PoolResource pool{ NodeBlockSize };
+            measure("PoolAllocator", size, &pool.stats(), [&] {
+                pool.resetStats();
+                return workload(size, PoolAllocator<int>{ &pool });
+            });
+
+            // a large buffer on the stack of the benchmark function
+            StackArena<StackBufferSize> buffer{};
+            measure("StackAllocator", size, &buffer.stats(), [&] {
+                buffer.resetStats();
+                return workload(size, StackAllocator<int, StackBufferSize>{ &buffer });
+            });
+        }
+    }
+
+    static void test_allocators_02_benchmark()
+    {
+        // 'Dummy' prints every call of a special member function
+        isVerbose = false;
+
+        benchmarkWorkload("std::vector<Dummy>", [](size_t size, const auto& alloc) {
+            return workloadVectorDummy(size, alloc);
+        });
+
+        benchmarkWorkload("std::list<int>", [](size_t size, const auto& alloc) {
+            return workloadList(size, alloc);
+        });
+
+        benchmarkWorkload("std::map<int, int>", [](size_t size, const auto& alloc) {
+            return workloadMap(size, alloc);
+        });
+
+        isVerbose = true;
+    }
+
+    // =================================================================================
+    // the same workloads with polymorphic allocators: every resource obtains its memory
+    // from a 'TrackingResource', the allocations are the requests to this upstream resource
+
+    // initial buffer of the monotonic resource, large enough for all workloads
+    constexpr size_t MonotonicBufferSize{ 16 * 1024 * 1024 };
+
+    template <typename TWorkload>
+    static void benchmarkWorkloadPmr(std::string_view title, TWorkload workload)
+    {
+        std::println("Benchmark - {} with std::pmr (Allocations: Requests to the Upstream Resource)", title);
+
+        using PolymorphicAllocator = std::pmr::polymorphic_allocator<int>;
+
+        for (size_t size : { 100, 1000, 100000 }) {
+
+            std::println("Elements: {}", size);
+
+            TrackingResource heap{ std::pmr::new_delete_resource() };
+            measure("new_delete", size, &heap.stats(), [&] {
+                heap.reset();
+                return workload(size, PolymorphicAllocator{ &heap });
+            });
+
+            TrackingResource monotonicUpstream{ std::pmr::new_delete_resource() };
+            std::pmr::monotonic_buffer_resource monotonic{ &monotonicUpstream };
+            measure("monotonic", size, &monotonicUpstream.stats(), [&] {
+                monotonicUpstream.reset();
+                size_t result{ workload(size, PolymorphicAllocator{ &monotonic }) };
+                monotonic.release();
+                return result;
+            });
+
+            // the initial buffer is reused after every 'release'
+            HugePageResource hugePages{};
+            void* buffer{ hugePages.allocate(MonotonicBufferSize) };
+            {
+                TrackingResource bufferUpstream{ std::pmr::new_delete_resource() };
+                std::pmr::monotonic_buffer_resource monotonicBuffer{ buffer, MonotonicBufferSize, &bufferUpstream };
+                measure("monotonic, huge pages", size, &bufferUpstream.stats(), [&] {
+                    bufferUpstream.reset();
+                    size_t result{ workload(size, PolymorphicAllocator{ &monotonicBuffer }) };
+                    monotonicBuffer.release();
+                    return result;
+                });
+            }
+            hugePages.deallocate(buffer, MonotonicBufferSize);
+
+            TrackingResource poolUpstream{ std::pmr::new_delete_resource() };
+            std::pmr::unsynchronized_pool_resource pool{ &poolUpstream };
+            measure("unsynchronized_pool", size, &poolUpstream.stats(), [&] {
+                poolUpstream.reset();
+                return workload(size, PolymorphicAllocator{ &pool });
+            });
+
+            TrackingResource perThreadUpstream{ std::pmr::new_delete_resource() };
+            PerThreadPoolResource perThreadPool{ &perThreadUpstream };
+            measure("PerThreadPool", size, &perThreadUpstream.stats(), [&] {
+                perThreadUpstream.reset();
+                return workload(size, PolymorphicAllocator{ &perThreadPool });
+            });
+        }
+    }
+
+    static void test_allocators_03_pmr_benchmark()
+    {
+        isVerbose = false;
+
+        benchmarkWorkloadPmr("std::vector<Dummy>", [](size_t size, const auto& alloc) {
+            return workloadVectorDummy(size, alloc);
+        });
+
+        benchmarkWorkloadPmr("std::list<int>", [](size_t size, const auto& alloc) {
+            return workloadList(size, alloc);
+        });
+
+        benchmarkWorkloadPmr("std::map<int, int>", [](size_t size, const auto& alloc) {
+            return workloadMap(size, alloc);
+        });
+
+        isVerbose = true;
+    }
+
+    // =================================================================================
+    // allocation throughput with 1 to 64 threads: glibc / MSVC 'malloc' vs 'SmallObjectHeap'
+
+    constexpr size_t OperationsPerMeasurement{ 4000000 };
+    constexpr size_t LiveBlocksPerThread{ 1024 };
+    constexpr size_t HandOverBatch{ 256 };
+
+    // typical node sizes: 16 to 128 bytes
+    static size_t nodeSize(std::uint32_t& random)
+    {
+        random = random * 1664525u + 1013904223u;
+        return 16 + ((random >> 16) % 8) * 16;
+    }
+
+    // every thread keeps a ring of live blocks,
+    // each operation releases the oldest block and allocates a new one
+    template <typename TAllocate, typename TDeallocate>
+    static void churn(size_t operations, TAllocate allocate, TDeallocate deallocate)
+    {
+        std::vector<std::pair<void*, size_t>> ring(LiveBlocksPerThread);
+        std::uint32_t random{ 42 };
+
+        for (auto& [ptr, size] : ring) {
+            size = nodeSize(random);
+            ptr = allocate(size);
+        }
+
+        for (size_t i{}; i != operations; ++i) {
+            auto& [ptr, size] { ring[i % LiveBlocksPerThread] };
+            deallocate(ptr, size);
+            size = nodeSize(random);
+            ptr = allocate(size);
+            *static_cast<std::byte*>(ptr) = std::byte{ 1 };
+        }
+
+        for (auto& [ptr, size] : ring) {
+            deallocate(ptr, size);
+        }
+    }
+
+    // blocks allocated by one thread are released by the next thread:
+    // every thread hands batches of blocks over to its successor
+    struct Mailbox
+    {
+        std::mutex                                         m_mutex;
+        std::vector<std::vector<std::pair<void*, size_t>>> m_batches;
+    };
+
+    template <typename TAllocate, typename TDeallocate>
+    static void crossThread(size_t operations, Mailbox& own, Mailbox& next, TAllocate allocate, TDeallocate deallocate)
+    {
+        std::uint32_t random{ 42 };
+
+        auto releaseReceived = [&] {
+            std::vector<std::vector<std::pair<void*, size_t>>> received;
+            {
+                std::lock_guard<std::mutex> guard{ own.m_mutex };
+                received.swap(own.m_batches);
+            }
+            for (const auto& batch : received) {
+                for (const auto& [ptr, size] : batch) {
+                    deallocate(ptr, size);
+                }
+            }
+        };
+
+        for (size_t done{}; done < operations; done += HandOverBatch) {
+
+            std::vector<std::pair<void*, size_t>> batch(HandOverBatch);
+            for (auto& [ptr, size] : batch) {
+                size = nodeSize(random);
+                ptr = allocate(size);
+            }
+
+            {
+                std::lock_guard<std::mutex> guard{ next.m_mutex };
+                next.m_batches.push_back(std::move(batch));
+            }
+
+            releaseReceived();
+        }
+
+        releaseReceived();
+    }
+
+    template <typename TThreadFunc>
+    static void measureThreads(std::string_view name, size_t numThreads, TThreadFunc threadFunc)
+    {
+        const size_t operations{ OperationsPerMeasurement / numThreads };
+
+        const auto begin{ std::chrono::steady_clock::now() };
+        {
+            std::vector<std::jthread> threads;
+            for (size_t i{}; i != numThreads; ++i) {
+                threads.emplace_back(threadFunc, i, operations);
+            }
+        }   // joins all threads
+        const auto end{ std::chrono::steady_clock::now() };
+
+        const double seconds{ std::chrono::duration<double>{ end - begin }.count() };
+
+        std::println("  {:<24}{:>4} threads {:>10.2f} M operations/s",
+            name, numThreads, static_cast<double>(operations * numThreads) / seconds / 1e6);
+    }
+
+    static void test_allocators_04_threads_benchmark()
+    {
+        auto mallocAllocate = [](size_t size) { return std::malloc(size); };
+        auto mallocDeallocate = [](void* ptr, size_t) { std::free(ptr); };
+
+        auto heapAllocate = [](size_t size) { return SmallObjectHeap::allocate(size); };
+        auto heapDeallocate = [](void* ptr, size_t size) { SmallObjectHeap::deallocate(ptr, size); };
+
+        std::println("Benchmark - Allocation Throughput (Hardware Threads: {})", std::thread::hardware_concurrency());
+
+        const std::vector<size_t> threadCounts{ 1, 2, 4, 8, 16, 32, 64 };
+
+        std::println("Churn (each thread releases its own blocks):");
+        for (size_t numThreads : threadCounts) {
+
+            measureThreads("malloc / free", numThreads, [&](size_t, size_t operations) {
+                churn(operations, mallocAllocate, mallocDeallocate);
+            });
+
+            measureThreads("SmallObjectHeap", numThreads, [&](size_t, size_t operations) {
+                churn(operations, heapAllocate, heapDeallocate);
+            });
+        }
+
+        std::println("Cross-thread (blocks are released by another thread):");
+        for (size_t numThreads : threadCounts) {
+
+            std::vector<Mailbox> mailboxes(numThreads);
+
+            measureThreads("malloc / free", numThreads, [&](size_t i, size_t operations) {
+                crossThread(operations, mailboxes[i], mailboxes[(i + 1) % numThreads], mallocAllocate, mallocDeallocate);
+            });
+
+            // blocks still in a mailbox are released by the main thread
+            for (auto& mailbox : mailboxes) {
+                for (const auto& batch : mailbox.m_batches) {
+                    for (const auto& [ptr, size] : batch) {
+                        std::free(ptr);
+                    }
+                }
+                mailbox.m_batches.clear();
+            }
+
+            measureThreads("SmallObjectHeap", numThreads, [&](size_t i, size_t operations) {
+                crossThread(operations, mailboxes[i], mailboxes[(i + 1) % numThreads], heapAllocate, heapDeallocate);
+            });
+
+            for (auto& mailbox : mailboxes) {
+                for (const auto& batch : mailbox.m_batches) {
+                    for (const auto& [ptr, size] : batch) {
+                        SmallObjectHeap::deallocate(ptr, size);
+                    }
+                }
+                mailbox.m_batches.clear();
+            }
+        }
+
+        std::println("std::list<int> (push_back / pop_front per thread):");
+        for (size_t numThreads : threadCounts) {
+
+            measureThreads("std::allocator", numThreads, [](size_t, size_t operations) {
+                std::list<int> list(LiveBlocksPerThread);
+                for (size_t i{}; i != operations; ++i) {
+                    list.pop_front();
+                    list.push_back(static_cast<int>(i));
+                }
+            });
+
+            measureThreads("ThreadCachingAllocator", numThreads, [](size_t, size_t operations) {
+                std::list<int, ThreadCachingAllocator<int>> list(LiveBlocksPerThread);
+                for (size_t i{}; i != operations; ++i) {
+                    list.pop_front();
+                    list.push_back(static_cast<int>(i));
+                }
+            });
+        }
+
+        const auto statistics{ SmallObjectHeap::statistics() };
+        std::println("Spans: {}, Batches fetched: {}, Batches returned: {}",
+            statistics.m_spans, statistics.m_batchesFetched, statistics.m_batchesReturned);
+    }
+
+    // =================================================================================
+    // push_back without 'reserve': std::vector vs GrowthVector with different growth
+    // policies. The reallocations and moved bytes are taken from a second, traced run
+
+    constexpr size_t GrowthElementsPerMeasurement{ 20'000'000 };
+
+    template <typename TVector, typename TTracedVector, typename TMake>
+    static void measureGrowth(std::string_view name, size_t size, TMake make)
+    {
+        const size_t repetitions{ std::max<size_t>(GrowthElementsPerMeasurement / size, 1) };
+
+        size_t checksum{};
+
+        const auto begin{ std::chrono::steady_clock::now() };
+
+        for (size_t i{}; i != repetitions; ++i) {
+            TVector vec{};
+            for (size_t n{}; n != size; ++n) {
+                vec.push_back(make(n));
+            }
+            checksum += vec.size();
+        }
+
+        const auto end{ std::chrono::steady_clock::now() };
+
+        const double nanoseconds{ std::chrono::duration<double, std::nano>{ end - begin }.count() };
+
+        std::print("  {:<16}{:>8.2f} ns/element", name, nanoseconds / static_cast<double>(repetitions * size));
+
+        if constexpr (requires (const TTracedVector& vec) { vec.reallocations(); }) {
+
+            TTracedVector vec{};
+            for (size_t n{}; n != size; ++n) {
+                vec.push_back(make(n));
+            }
+
+            size_t bytesMoved{};
+            size_t inPlace{};
+            for (const Reallocation& reallocation : vec.reallocations()) {
+                bytesMoved += reallocation.m_bytesMoved;
+                inPlace += reallocation.m_inPlace ? 1 : 0;
+            }
+
+            std::println("  Reallocations: {:>3} (in place: {:>3})  Bytes moved: {:>10}  (Checksum: {})",
+                vec.reallocations().size(), inPlace, bytesMoved, checksum);
+        }
+        else {
+            std::println("  (Checksum: {})", checksum);
+        }
+    }
+
+    template <typename T, typename TMake>
+    static void benchmarkGrowth(std::string_view title, std::initializer_list<size_t> sizes, TMake make)
+    {
+        std::println("Benchmark - push_back {}", title);
+
+        for (size_t size : sizes) {
+
+            std::println("Elements: {}", size);
+
+            measureGrowth<std::vector<T>, std::vector<T>>("std::vector", size, make);
+            measureGrowth<GrowthVector<T, GrowthPolicy::Factor1_5>, GrowthVector<T, GrowthPolicy::Factor1_5, true>>("Factor 1.5", size, make);
+            measureGrowth<GrowthVector<T, GrowthPolicy::Factor2>, GrowthVector<T, GrowthPolicy::Factor2, true>>("Factor 2", size, make);
+            measureGrowth<GrowthVector<T, GrowthPolicy::GoldenRatio>, GrowthVector<T, GrowthPolicy::GoldenRatio, true>>("Golden Ratio", size, make);
+            measureGrowth<GrowthVector<T, GrowthPolicy::PageGranular>, GrowthVector<T, GrowthPolicy::PageGranular, true>>("Page Granular", size, make);
+        }
+    }
+
+    static void test_allocators_05_growth_benchmark()
+    {
+        isVerbose = false;
+
+        benchmarkGrowth<int>("int (realloc / mremap)", { 100, 10'000, 1'000'000, 20'000'000 }, [](size_t n) {
+            return static_cast<int>(n);
+        });
+
+        benchmarkGrowth<Dummy>("Dummy (move c'tor)", { 100, 10'000, 1'000'000 }, [](size_t n) {
+            return Dummy{ static_cast<int>(n) };
+        });
+
+        isVerbose = true;
+    }
+}
+
+// =====================================================================================
+
+void main_allocator_benchmark()
+{
+    using namespace AllocatorBenchmark;
+
+    test_allocators_01();
+    test_allocators_02_benchmark();
+    test_allocators_03_pmr_benchmark();
+    test_allocators_04_threads_benchmark();
+    test_allocators_05_growth_benchmark();
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
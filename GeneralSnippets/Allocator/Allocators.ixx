@@ -0,0 +1,407 @@
+// =====================================================================================
+// Allocators.ixx // Arena, Pool and Stack Buffer Allocators with Statistics
+// =====================================================================================
+
+export module modern_cpp:allocators;
+
+import std;
+
+// all allocators have the shape of 'MyAlloc<T>' (Allocator.cpp): 'value_type',
+// a converting c'tor, 'allocate', 'deallocate' and 'operator=='.
+// the memory is managed by a resource object, the allocators only refer to it:
+// the resource must outlive all containers using one of its allocators
+
+namespace Allocator {
+
+    // counters instead of output - one instance per resource
+    struct AllocationStats
+    {
+        size_t m_allocations;      // number of calls of 'allocate'
+        size_t m_deallocations;    // number of calls of 'deallocate'
+        size_t m_bytesAllocated;   // sum of all requested bytes
+        size_t m_bytesInUse;       // requested bytes minus released bytes
+        size_t m_peakBytesInUse;
+        size_t m_fallbacks;        // requests served by the global heap
+
+        void onAllocate(size_t bytes) {
+            ++m_allocations;
+            m_bytesAllocated += bytes;
+            m_bytesInUse += bytes;
+            m_peakBytesInUse = std::max(m_peakBytesInUse, m_bytesInUse);
+        }
+
+        void onDeallocate(size_t bytes) {
+            ++m_deallocations;
+            m_bytesInUse -= bytes;
+        }
+
+        void onFallback() { ++m_fallbacks; }
+
+        size_t blocksInUse() const { return m_allocations - m_deallocations; }
+
+        void reset() { *this = AllocationStats{}; }
+    };
+
+    // =================================================================================
+    // monotonic arena: memory is handed out by bumping a pointer, single blocks are
+    // never released. 'release' frees all chunks at once (bulk release),
+    // each new chunk is twice as large as the previous one
+
+    class MonotonicArena
+    {
+    public:
+        static constexpr size_t DefaultChunkSize{ 64 * 1024 };
+
+    private:
+        std::vector<std::unique_ptr<std::byte[]>> m_chunks;
+        size_t          m_initialChunkSize;
+        size_t          m_nextChunkSize;
+        std::byte*      m_current;
+        size_t          m_remaining;
+        AllocationStats m_stats;
+
+    public:
+        // c'tor
+        explicit MonotonicArena(size_t initialChunkSize = DefaultChunkSize)
+            : m_chunks{}, m_initialChunkSize{ initialChunkSize }, m_nextChunkSize{ initialChunkSize },
+              m_current{}, m_remaining{}, m_stats{}
+        {}
+
+        // no copying or moving: allocators refer to the arena by address
+        MonotonicArena(const MonotonicArena&) = delete;
+        MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+        MonotonicArena(MonotonicArena&&) = delete;
+        MonotonicArena& operator=(MonotonicArena&&) = delete;
+
+        // public interface
+        void* allocate(size_t bytes, size_t alignment) {
+
+            void* ptr{ m_current };
+            if (std::align(alignment, bytes, ptr, m_remaining) == nullptr) {
+
+                // operator new[] aligns to __STDCPP_DEFAULT_NEW_ALIGNMENT__
+                size_t size{ std::max(m_nextChunkSize, bytes + alignment) };
+                m_chunks.push_back(std::make_unique_for_overwrite<std::byte[]>(size));
+                m_current = m_chunks.back().get();
+                m_remaining = size;
+                m_nextChunkSize = 2 * m_nextChunkSize;
+
+                ptr = m_current;
+                std::align(alignment, bytes, ptr, m_remaining);
+            }
+
+            m_current = static_cast<std::byte*>(ptr) + bytes;
+            m_remaining -= bytes;
+            m_stats.onAllocate(bytes);
+
+            return ptr;
+        }
+
+        // the memory is reused only after 'release'
+        void deallocate(void*, size_t bytes) noexcept {
+            m_stats.onDeallocate(bytes);
+        }
+
+        // all objects allocated in the arena must have been destroyed
+        void release() {
+            m_chunks.clear();
+            m_nextChunkSize = m_initialChunkSize;
+            m_current = nullptr;
+            m_remaining = 0;
+        }
+
+        size_t chunks() const { return m_chunks.size(); }
+
+        const AllocationStats& stats() const { return m_stats; }
+        void resetStats() { m_stats.reset(); }
+    };
+
+    template <typename T>
+    class ArenaAllocator
+    {
+    private:
+        MonotonicArena* m_arena;
+
+        template <typename U>
+        friend class ArenaAllocator;
+
+    public:
+        using value_type = T;
+
+        // c'tors
+        explicit ArenaAllocator(MonotonicArena* arena) noexcept : m_arena{ arena } {}
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) noexcept : m_arena{ other.m_arena } {}
+
+        // allocator interface
+        T* allocate(size_t n) {
+            return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* p, size_t n) noexcept {
+            m_arena->deallocate(p, n * sizeof(T));
+        }
+
+        template <typename U>
+        bool operator== (const ArenaAllocator<U>& other) const noexcept {
+            return m_arena == other.m_arena;
+        }
+    };
+
+    // =================================================================================
+    // pool of equally sized blocks for node based containers ('std::list', 'std::map'):
+    // blocks are carved out of slabs, released blocks are linked into a free list
+    // stored in the blocks themselves (intrusive free list). The block size has to cover
+    // the node type of the container, larger requests or arrays go to the global heap
+
+    class PoolResource
+    {
+    public:
+        static constexpr size_t DefaultBlocksPerSlab{ 1024 };
+
+    private:
+        struct FreeBlock
+        {
+            FreeBlock* m_next;
+        };
+
+        std::vector<std::unique_ptr<std::byte[]>> m_slabs;
+        size_t          m_blockSize;
+        size_t          m_blockAlignment;
+        size_t          m_blocksPerSlab;
+        FreeBlock*      m_freeList;
+        AllocationStats m_stats;
+
+    public:
+        // c'tor
+        explicit PoolResource(size_t blockSize, size_t blocksPerSlab = DefaultBlocksPerSlab)
+            : m_slabs{}, m_blockSize{ roundUp(std::max(blockSize, sizeof(FreeBlock))) },
+              m_blockAlignment{}, m_blocksPerSlab{ blocksPerSlab }, m_freeList{}, m_stats{}
+        {
+            // largest power of two dividing the block size, at most the alignment of the slabs
+            m_blockAlignment = std::min(m_blockSize & (~m_blockSize + 1), size_t{ __STDCPP_DEFAULT_NEW_ALIGNMENT__ });
+        }
+
+        // no copying or moving: allocators refer to the pool by address
+        PoolResource(const PoolResource&) = delete;
+        PoolResource& operator=(const PoolResource&) = delete;
+
+        PoolResource(PoolResource&&) = delete;
+        PoolResource& operator=(PoolResource&&) = delete;
+
+        // public interface
+        void* allocate(size_t bytes, size_t alignment) {
+
+            m_stats.onAllocate(bytes);
+
+            if (!fits(bytes, alignment)) {
+                m_stats.onFallback();
+                return ::operator new(bytes, std::align_val_t{ alignment });
+            }
+
+            if (m_freeList == nullptr) {
+                addSlab();
+            }
+
+            FreeBlock* block{ m_freeList };
+            m_freeList = block->m_next;
+            return block;
+        }
+
+        void deallocate(void* ptr, size_t bytes, size_t alignment) noexcept {
+
+            m_stats.onDeallocate(bytes);
+
+            if (!fits(bytes, alignment)) {
+                ::operator delete(ptr, std::align_val_t{ alignment });
+                return;
+            }
+
+            FreeBlock* block{ ::new (ptr) FreeBlock{ m_freeList } };
+            m_freeList = block;
+        }
+
+        size_t blockSize() const { return m_blockSize; }
+        size_t slabs() const { return m_slabs.size(); }
+
+        const AllocationStats& stats() const { return m_stats; }
+        void resetStats() { m_stats.reset(); }
+
+    private:
+        static constexpr size_t roundUp(size_t size) {
+            return (size + sizeof(FreeBlock) - 1) / sizeof(FreeBlock) * sizeof(FreeBlock);
+        }
+
+        bool fits(size_t bytes, size_t alignment) const {
+            return bytes <= m_blockSize && alignment <= m_blockAlignment;
+        }
+
+        // threads the blocks of the new slab into the free list
+        void addSlab() {
+
+            m_slabs.push_back(std::make_unique_for_overwrite<std::byte[]>(m_blockSize * m_blocksPerSlab));
+            std::byte* slab{ m_slabs.back().get() };
+
+            for (size_t i{ m_blocksPerSlab }; i != 0; --i) {
+                m_freeList = ::new (slab + (i - 1) * m_blockSize) FreeBlock{ m_freeList };
+            }
+        }
+    };
+
+    template <typename T>
+    class PoolAllocator
+    {
+    private:
+        PoolResource* m_pool;
+
+        template <typename U>
+        friend class PoolAllocator;
+
+    public:
+        using value_type = T;
+
+        // c'tors
+        explicit PoolAllocator(PoolResource* pool) noexcept : m_pool{ pool } {}
+
+        template <typename U>
+        PoolAllocator(const PoolAllocator<U>& other) noexcept : m_pool{ other.m_pool } {}
+
+        // allocator interface
+        T* allocate(size_t n) {
+            return static_cast<T*>(m_pool->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* p, size_t n) noexcept {
+            m_pool->deallocate(p, n * sizeof(T), alignof(T));
+        }
+
+        template <typename U>
+        bool operator== (const PoolAllocator<U>& other) const noexcept {
+            return m_pool == other.m_pool;
+        }
+    };
+
+    // =================================================================================
+    // fixed buffer, typically a local variable on the stack. Requests are served by
+    // bumping a pointer, the most recent block can be released again (stack order).
+    // when no block of the buffer is in use any more, the whole buffer is reused.
+    // requests not fitting into the buffer go to the global heap
+
+    template <size_t Size>
+    class StackArena
+    {
+    private:
+        alignas(std::max_align_t) std::byte m_buffer[Size];
+        size_t          m_used;
+        size_t          m_blocksInUse;
+        AllocationStats m_stats;
+
+    public:
+        // c'tor
+        StackArena() noexcept : m_used{}, m_blocksInUse{}, m_stats{} {}
+
+        // no copying or moving: allocators refer to the buffer by address
+        StackArena(const StackArena&) = delete;
+        StackArena& operator=(const StackArena&) = delete;
+
+        StackArena(StackArena&&) = delete;
+        StackArena& operator=(StackArena&&) = delete;
+
+        // public interface
+        void* allocate(size_t bytes, size_t alignment) {
+
+            m_stats.onAllocate(bytes);
+
+            if (alignment <= alignof(std::max_align_t)) {
+
+                void* ptr{ m_buffer + m_used };
+                size_t remaining{ Size - m_used };
+
+                if (std::align(alignment, bytes, ptr, remaining) != nullptr) {
+                    m_used = Size - remaining + bytes;
+                    ++m_blocksInUse;
+                    return ptr;
+                }
+            }
+
+            m_stats.onFallback();
+            return ::operator new(bytes, std::align_val_t{ alignment });
+        }
+
+        void deallocate(void* ptr, size_t bytes, size_t alignment) noexcept {
+
+            m_stats.onDeallocate(bytes);
+
+            if (!owns(ptr)) {
+                ::operator delete(ptr, std::align_val_t{ alignment });
+                return;
+            }
+
+            std::byte* block{ static_cast<std::byte*>(ptr) };
+            if (block + bytes == m_buffer + m_used) {
+                m_used = static_cast<size_t>(block - m_buffer);
+            }
+
+            --m_blocksInUse;
+            if (m_blocksInUse == 0) {
+                m_used = 0;
+            }
+        }
+
+        bool owns(const void* ptr) const noexcept {
+            return std::less_equal<const void*>{}(m_buffer, ptr) && std::less<const void*>{}(ptr, m_buffer + Size);
+        }
+
+        size_t used() const { return m_used; }
+        static constexpr size_t size() { return Size; }
+
+        const AllocationStats& stats() const { return m_stats; }
+        void resetStats() { m_stats.reset(); }
+    };
+
+    template <typename T, size_t Size>
+    class StackAllocator
+    {
+    private:
+        StackArena<Size>* m_arena;
+
+        template <typename U, size_t S>
+        friend class StackAllocator;
+
+    public:
+        using value_type = T;
+
+        // 'std::allocator_traits' can rebind type parameters only
+        template <typename U>
+        struct rebind
+        {
+            using other = StackAllocator<U, Size>;
+        };
+
+        // c'tors
+        explicit StackAllocator(StackArena<Size>* arena) noexcept : m_arena{ arena } {}
+
+        template <typename U>
+        StackAllocator(const StackAllocator<U, Size>& other) noexcept : m_arena{ other.m_arena } {}
+
+        // allocator interface
+        T* allocate(size_t n) {
+            return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* p, size_t n) noexcept {
+            m_arena->deallocate(p, n * sizeof(T), alignof(T));
+        }
+
+        template <typename U>
+        bool operator== (const StackAllocator<U, Size>& other) const noexcept {
+            return m_arena == other.m_arena;
+        }
+    };
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
@@ -0,0 +1,470 @@
+// =====================================================================================
+// GrowthVector.ixx // Vector with configurable Growth Policy and Reallocation Tracing
+// =====================================================================================
+
+module;
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+export module modern_cpp:growth_vector;
+
+import std;
+
+// 'std::vector' grows by a fixed factor (MSVC: 1.5, libstdc++ / libc++: 2),
+// every reallocation moves (or copies) all elements into a new buffer.
+// 'GrowthVector' makes the growth factor a template parameter and relocates
+// trivially relocatable elements with 'realloc' - the memory manager may extend the
+// block in place. Large buffers are mapped directly and grown with 'mremap' (Linux):
+// the pages are remapped by the kernel, no element is copied at all
+
+namespace Allocator {
+
+    // =================================================================================
+    // trivially relocatable: moving an object to another address and ending the lifetime
+    // of the source is equivalent to copying its bytes (e.g. 'std::unique_ptr', most
+    // 'std::string' implementations, but not the implementation of libstdc++)
+
+    template <typename T>
+    struct IsTriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+    template <typename T>
+    constexpr bool IsTriviallyRelocatableV{ IsTriviallyRelocatable<T>::value };
+
+    // moves 'count' elements from 'source' into the uninitialized memory 'target'
+    // and ends the lifetime of the source elements.
+    // Trivially relocatable types (opt-in: 'IsTriviallyRelocatable<T>')
+    // are copied with 'memcpy', no c'tor and no d'tor is called.
+    // All other types are moved - or copied, if their move c'tor may throw:
+    // in case of an exception 'source' remains unchanged (strong exception guarantee)
+
+    template <typename T>
+    void uninitializedRelocate(T* source, size_t count, T* target)
+    {
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            if (count != 0) {
+                std::memcpy(static_cast<void*>(target), static_cast<const void*>(source), count * sizeof(T));
+            }
+        }
+        else {
+            size_t relocated{};
+            try {
+                for (; relocated != count; ++relocated) {
+                    ::new (static_cast<void*>(target + relocated)) T(std::move_if_noexcept(source[relocated]));
+                }
+            }
+            catch (...) {
+                std::destroy_n(target, relocated);
+                throw;
+            }
+
+            std::destroy_n(source, count);
+        }
+    }
+
+    // =================================================================================
+    // common part of 'GrowthVector' and 'PlacementNew::VectorEx': element access,
+    // move, swap and relocation. The derived class allocates and releases the buffer
+
+    template <typename T>
+    class VectorBase
+    {
+    public:
+        using value_type = T;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+    protected:
+        T*     m_data;
+        size_t m_size;
+        size_t m_capacity;
+
+        // c'tors / d'tor
+        VectorBase() noexcept : m_data{}, m_size{}, m_capacity{} {}
+
+        VectorBase(VectorBase&& other) noexcept
+            : m_data{ std::exchange(other.m_data, nullptr) },
+              m_size{ std::exchange(other.m_size, 0) },
+              m_capacity{ std::exchange(other.m_capacity, 0) }
+        {}
+
+        ~VectorBase() = default;
+
+        // copy-and-swap of the derived classes: strong exception guarantee
+        void swap(VectorBase& other) noexcept {
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+            std::swap(m_capacity, other.m_capacity);
+        }
+
+        // slow path of 'emplace_back': the arguments may refer to an element of this vector,
+        // the new element is created in the new buffer 'data' before the elements are relocated.
+        // in case of an exception 'data' contains no object and the vector remains unchanged
+        template <typename... TArgs>
+        void relocateAndEmplace(T* data, TArgs&&... args) {
+
+            ::new (static_cast<void*>(data + m_size)) T(std::forward<TArgs>(args)...);
+
+            try {
+                uninitializedRelocate(m_data, m_size, data);
+            }
+            catch (...) {
+                std::destroy_at(data + m_size);
+                throw;
+            }
+        }
+
+    public:
+        // getter
+        size_t size() const { return m_size; }
+        size_t capacity() const { return m_capacity; }
+        bool empty() const { return m_size == 0; }
+
+        T* data() { return m_data; }
+        const T* data() const { return m_data; }
+
+        T& operator[] (size_t index) { return m_data[index]; }
+        const T& operator[] (size_t index) const { return m_data[index]; }
+
+        T& back() { return m_data[m_size - 1]; }
+        const T& back() const { return m_data[m_size - 1]; }
+
+        // iterators
+        iterator begin() { return m_data; }
+        iterator end() { return m_data + m_size; }
+        const_iterator begin() const { return m_data; }
+        const_iterator end() const { return m_data + m_size; }
+        const_iterator cbegin() const { return m_data; }
+        const_iterator cend() const { return m_data + m_size; }
+
+        // public interface
+        void pop_back() {
+            --m_size;
+            std::destroy_at(m_data + m_size);
+        }
+
+        void clear() {
+            std::destroy_n(m_data, m_size);
+            m_size = 0;
+        }
+    };
+
+    // =================================================================================
+
+    enum class GrowthPolicy { Factor1_5, Factor2, GoldenRatio, PageGranular };
+
+    inline std::string_view toString(GrowthPolicy policy)
+    {
+        switch (policy) {
+        case GrowthPolicy::Factor1_5:    return "Factor 1.5";
+        case GrowthPolicy::Factor2:      return "Factor 2";
+        case GrowthPolicy::GoldenRatio:  return "Golden Ratio";
+        default:                         return "Page Granular";
+        }
+    }
+
+    struct Reallocation
+    {
+        size_t m_oldCapacity;
+        size_t m_newCapacity;
+        size_t m_bytesMoved;     // bytes copied by the vector or by 'realloc'
+        bool   m_inPlace;        // address unchanged
+    };
+
+    template <typename T, GrowthPolicy Policy = GrowthPolicy::Factor2, bool Tracing = false>
+    class GrowthVector : public VectorBase<T>
+    {
+    public:
+        static constexpr size_t PageSize{ 4096 };
+
+        // buffers of at least this size are mapped directly (Linux, trivially relocatable types only)
+        static constexpr size_t MapThreshold{ 256 * 1024 };
+
+    private:
+        static constexpr bool UseRealloc{
+            IsTriviallyRelocatableV<T> && alignof(T) <= alignof(std::max_align_t)
+        };
+
+        struct NoTrace {};
+
+        using Trace = std::conditional_t<Tracing, std::vector<Reallocation>, NoTrace>;
+
+        using Base = VectorBase<T>;
+        using Base::m_data;
+        using Base::m_size;
+        using Base::m_capacity;
+
+        Trace m_trace;
+
+    public:
+        // c'tors / d'tor
+        GrowthVector() : m_trace{} {}
+
+        GrowthVector(std::initializer_list<T> values) : GrowthVector{} {
+            reserve(values.size());
+            for (const T& value : values) {
+                emplace_back(value);
+            }
+        }
+
+        GrowthVector(const GrowthVector& other) : GrowthVector{} {
+            reserve(other.m_size);
+            std::uninitialized_copy_n(other.m_data, other.m_size, m_data);
+            m_size = other.m_size;
+        }
+
+        GrowthVector(GrowthVector&& other) noexcept
+            : Base{ std::move(other) }, m_trace{ std::move(other.m_trace) }
+        {}
+
+        ~GrowthVector() {
+            Base::clear();
+            release(m_data, m_capacity);
+        }
+
+        // copy-and-swap: strong exception guarantee
+        GrowthVector& operator= (GrowthVector other) noexcept {
+            Base::swap(other);
+            std::swap(m_trace, other.m_trace);
+            return *this;
+        }
+
+        // recorded reallocations (tracing mode only)
+        const std::vector<Reallocation>& reallocations() const requires Tracing {
+            return m_trace;
+        }
+
+        // public interface
+        void push_back(const T& value) { emplace_back(value); }
+
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+
+        template <typename... TArgs>
+        T& emplace_back(TArgs&&... args) {
+
+            if (m_size == m_capacity) {
+                growAndEmplace(std::forward<TArgs>(args)...);
+            }
+            else {
+                ::new (static_cast<void*>(m_data + m_size)) T(std::forward<TArgs>(args)...);
+            }
+
+            ++m_size;
+            return m_data[m_size - 1];
+        }
+
+        void reserve(size_t capacity) {
+            if (capacity > m_capacity) {
+                grow(capacity);
+            }
+        }
+
+        // capacity following 'capacity' - at least 'required'
+        static size_t nextCapacity(size_t capacity, size_t required) {
+
+            size_t next{};
+
+            switch (Policy) {
+            case GrowthPolicy::Factor1_5:
+                next = capacity + capacity / 2;
+                break;
+
+            case GrowthPolicy::Factor2:
+                next = 2 * capacity;
+                break;
+
+            case GrowthPolicy::GoldenRatio:
+                next = static_cast<size_t>(static_cast<double>(capacity) * std::numbers::phi);
+                break;
+
+            case GrowthPolicy::PageGranular:
+                // small buffers double, large buffers grow by 1.5 and consist of whole pages
+                next = (capacity * sizeof(T) < MapThreshold) ? 2 * capacity : capacity + capacity / 2;
+                if (next * sizeof(T) >= PageSize) {
+                    next = (next * sizeof(T) + PageSize - 1) / PageSize * PageSize / sizeof(T);
+                }
+                break;
+            }
+
+            return std::max({ next, required, size_t{ 4 } });
+        }
+
+    private:
+        size_t nextCapacity(size_t required) const {
+            return nextCapacity(m_capacity, required);
+        }
+
+        static bool isMapped(size_t capacity) {
+#if defined(__linux__)
+            return UseRealloc && capacity * sizeof(T) >= MapThreshold;
+#else
+            (void) capacity;
+            return false;
+#endif
+        }
+
+        static size_t mappingSize(size_t capacity) {
+            return (capacity * sizeof(T) + PageSize - 1) / PageSize * PageSize;
+        }
+
+        static T* allocate(size_t capacity) {
+
+            void* memory{};
+
+            if constexpr (UseRealloc) {
+#if defined(__linux__)
+                if (isMapped(capacity)) {
+                    memory = ::mmap(nullptr, mappingSize(capacity), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                    if (memory == MAP_FAILED) {
+                        throw std::bad_alloc{};
+                    }
+                    return static_cast<T*>(memory);
+                }
+#endif
+                memory = std::malloc(capacity * sizeof(T));
+                if (memory == nullptr) {
+                    throw std::bad_alloc{};
+                }
+            }
+            else if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                memory = ::operator new(capacity * sizeof(T), std::align_val_t{ alignof(T) });
+            }
+            else {
+                memory = ::operator new(capacity * sizeof(T));
+            }
+
+            return static_cast<T*>(memory);
+        }
+
+        static void release(T* data, size_t capacity) noexcept {
+
+            if (data == nullptr) {
+                return;
+            }
+
+            if constexpr (UseRealloc) {
+#if defined(__linux__)
+                if (isMapped(capacity)) {
+                    ::munmap(data, mappingSize(capacity));
+                    return;
+                }
+#endif
+                std::free(data);
+            }
+            else if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                ::operator delete(data, std::align_val_t{ alignof(T) });
+            }
+            else {
+                ::operator delete(data);
+            }
+        }
+
+        // slow path of 'emplace_back': the arguments may refer to an element of this vector,
+        // the new element is created before the elements are relocated
+        template <typename... TArgs>
+        void growAndEmplace(TArgs&&... args) {
+
+            if constexpr (UseRealloc) {
+                T value(std::forward<TArgs>(args)...);
+                grow(nextCapacity(m_size + 1));
+                ::new (static_cast<void*>(m_data + m_size)) T(std::move(value));
+            }
+            else {
+                if constexpr (Tracing) {
+                    m_trace.reserve(m_trace.size() + 1);
+                }
+
+                const size_t capacity{ nextCapacity(m_size + 1) };
+                T* data{ allocate(capacity) };
+
+                try {
+                    Base::relocateAndEmplace(data, std::forward<TArgs>(args)...);
+                }
+                catch (...) {
+                    release(data, capacity);
+                    throw;
+                }
+
+                replaceBuffer(data, capacity, m_size * sizeof(T));
+            }
+        }
+
+        // the elements have been relocated to 'data': the old buffer is released
+        void replaceBuffer(T* data, size_t capacity, size_t bytesMoved) {
+
+            if constexpr (!UseRealloc) {
+                release(m_data, m_capacity);
+            }
+
+            if constexpr (Tracing) {
+                m_trace.push_back({ m_capacity, capacity, bytesMoved, data == m_data });
+            }
+
+            m_data = data;
+            m_capacity = capacity;
+        }
+
+        void grow(size_t capacity) {
+
+            if constexpr (Tracing) {
+                m_trace.reserve(m_trace.size() + 1);   // 'push_back' mustn't throw after the relocation
+            }
+
+            T* data{};
+            size_t bytesMoved{};
+
+            if constexpr (UseRealloc) {
+                if (m_data == nullptr) {
+                    data = allocate(capacity);
+                }
+#if defined(__linux__)
+                else if (isMapped(m_capacity)) {
+                    // the kernel moves page table entries, not bytes
+                    void* memory{ ::mremap(m_data, mappingSize(m_capacity), mappingSize(capacity), MREMAP_MAYMOVE) };
+                    if (memory == MAP_FAILED) {
+                        throw std::bad_alloc{};
+                    }
+                    data = static_cast<T*>(memory);
+                }
+                else if (isMapped(capacity)) {
+                    data = allocate(capacity);
+                    std::memcpy(data, m_data, m_size * sizeof(T));
+                    std::free(m_data);
+                    bytesMoved = m_size * sizeof(T);
+                }
+#endif
+                else {
+                    void* memory{ std::realloc(m_data, capacity * sizeof(T)) };
+                    if (memory == nullptr) {
+                        throw std::bad_alloc{};
+                    }
+                    data = static_cast<T*>(memory);
+                    if (data != m_data) {
+                        bytesMoved = m_size * sizeof(T);
+                    }
+                }
+            }
+            else {
+                data = allocate(capacity);
+
+                try {
+                    uninitializedRelocate(m_data, m_size, data);
+                }
+                catch (...) {
+                    release(data, capacity);
+                    throw;
+                }
+
+                bytesMoved = m_size * sizeof(T);
+            }
+
+            replaceBuffer(data, capacity, bytesMoved);
+        }
+    };
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
@@ -0,0 +1,318 @@
+// ===========================================================================
+// HugePageAllocator.h // Allocator for large arrays backed by (huge) pages
+// ===========================================================================
+
+#pragma once
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <new>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// A 'std::vector<double>' of 100'000'000 elements occupies 800 MB, that are
+// about 200'000 pages of 4 KB - far more than the TLB can hold.
+// Mapped with huge pages (2 MB) 400 TLB entries are sufficient.
+//
+// Linux:
+//  - HugePages::Explicit:    'mmap' with 'MAP_HUGETLB', requires reserved huge pages
+//                            ('/proc/sys/vm/nr_hugepages'), falls back to HugePages::Transparent
+//  - HugePages::Transparent: 'mmap' at a multiple of 2 MB and 'madvise' with 'MADV_HUGEPAGE'
+//                            (transparent huge pages, mode 'always' or 'madvise')
+// Windows:
+//  - HugePages::Explicit:    'VirtualAlloc' with 'MEM_LARGE_PAGES', requires the privilege
+//                            'SeLockMemoryPrivilege', falls back to normal pages
+//  - HugePages::Transparent: normal pages (Windows has no transparent huge pages)
+//
+// 'Populate': all pages are created at once ('MAP_POPULATE') - the page faults
+// don't occur during the first access of the memory any more
+
+namespace Allocator {
+
+    enum class HugePages { None, Transparent, Explicit };
+
+    class PageMapper
+    {
+    public:
+        static constexpr std::size_t HugePageSize{ 2 * 1024 * 1024 };
+
+        struct Mapping
+        {
+            void*       m_address;
+            std::size_t m_size;
+            bool        m_hugePages;   // huge pages requested successfully (not guaranteed with THP)
+        };
+
+        struct Statistics
+        {
+            std::size_t m_mappings;
+            std::size_t m_explicitHugePages;
+            std::size_t m_transparentHugePages;
+            std::size_t m_fallbacks;
+        };
+
+    private:
+        static inline std::atomic<std::size_t> s_mappings{};
+        static inline std::atomic<std::size_t> s_explicitHugePages{};
+        static inline std::atomic<std::size_t> s_transparentHugePages{};
+        static inline std::atomic<std::size_t> s_fallbacks{};
+
+    public:
+        static std::size_t pageSize() {
+#if defined(_WIN32)
+            SYSTEM_INFO info{};
+            ::GetSystemInfo(&info);
+            return static_cast<std::size_t>(info.dwPageSize);
+#else
+            return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+        }
+
+        static std::size_t roundUp(std::size_t size, std::size_t granularity) {
+            return (size + granularity - 1) / granularity * granularity;
+        }
+
+        // size of the mapping: a multiple of the huge page size or of the page size
+        static std::size_t mappingSize(std::size_t bytes, HugePages policy) {
+            return roundUp(bytes, policy == HugePages::None ? pageSize() : HugePageSize);
+        }
+
+        static Statistics statistics() {
+            return {
+                s_mappings.load(std::memory_order_relaxed),
+                s_explicitHugePages.load(std::memory_order_relaxed),
+                s_transparentHugePages.load(std::memory_order_relaxed),
+                s_fallbacks.load(std::memory_order_relaxed)
+            };
+        }
+
+        // Linux: amount of memory of this process currently backed by transparent huge pages
+        static std::optional<std::size_t> transparentHugePageBytes() {
+
+            std::ifstream smaps{ "/proc/self/smaps_rollup" };
+            std::string key{};
+            std::size_t kiloBytes{};
+            std::string unit{};
+
+            while (smaps >> key) {
+                if (key == "AnonHugePages:" && smaps >> kiloBytes >> unit) {
+                    return kiloBytes * 1024;
+                }
+                smaps.ignore(256, '\n');
+            }
+
+            return std::nullopt;
+        }
+
+        static Mapping map(std::size_t bytes, std::size_t alignment, HugePages policy, bool populate) {
+
+            const std::size_t size{ mappingSize(bytes, policy) };
+            Mapping mapping{ nullptr, size, false };
+
+#if defined(_WIN32)
+            if (policy == HugePages::Explicit) {
+
+                const std::size_t largePageSize{ ::GetLargePageMinimum() };
+                if (largePageSize != 0 && size % largePageSize == 0) {
+                    mapping.m_address = ::VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+                }
+
+                if (mapping.m_address != nullptr) {
+                    mapping.m_hugePages = true;
+                    ++s_explicitHugePages;
+                }
+                else {
+                    ++s_fallbacks;
+                }
+            }
+
+            if (mapping.m_address == nullptr) {
+                mapping.m_address = ::VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+            }
+
+            // 'VirtualAlloc' aligns to the allocation granularity (64 KB)
+            if (mapping.m_address == nullptr || reinterpret_cast<std::uintptr_t>(mapping.m_address) % alignment != 0) {
+                if (mapping.m_address != nullptr) {
+                    ::VirtualFree(mapping.m_address, 0, MEM_RELEASE);
+                }
+                throw std::bad_alloc{};
+            }
+
+            // large pages are always committed, normal pages are created on the first access
+            if (populate && !mapping.m_hugePages) {
+                touch(mapping.m_address, size, pageSize());
+            }
+#else
+#if defined(MAP_POPULATE)
+            const int populateFlag{ populate ? MAP_POPULATE : 0 };
+#else
+            const int populateFlag{ 0 };
+#endif
+
+#if defined(MAP_HUGETLB)
+            if (policy == HugePages::Explicit && alignment <= HugePageSize) {
+
+                void* address{ ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populateFlag, -1, 0) };
+
+                if (address != MAP_FAILED) {
+                    mapping.m_address = address;
+                    mapping.m_hugePages = true;
+                    ++s_explicitHugePages;
+                    ++s_mappings;
+                    return mapping;
+                }
+            }
+#endif
+            if (policy == HugePages::Explicit) {
+                ++s_fallbacks;
+            }
+
+            const std::size_t align{ std::max(alignment, policy == HugePages::None ? pageSize() : HugePageSize) };
+
+            void* address{ nullptr };
+
+            if (align == pageSize()) {
+                address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | populateFlag, -1, 0);
+                if (address == MAP_FAILED) {
+                    throw std::bad_alloc{};
+                }
+            }
+            else {
+                // over-allocation by the alignment, the unaligned head and the tail are unmapped again
+                const std::size_t reserved{ size + align - pageSize() };
+
+                void* reservation{ ::mmap(nullptr, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) };
+                if (reservation == MAP_FAILED) {
+                    throw std::bad_alloc{};
+                }
+
+                std::byte* begin{ static_cast<std::byte*>(reservation) };
+                std::byte* aligned{ reinterpret_cast<std::byte*>(roundUp(reinterpret_cast<std::uintptr_t>(begin), align)) };
+                std::byte* end{ begin + reserved };
+
+                if (aligned != begin) {
+                    ::munmap(begin, static_cast<std::size_t>(aligned - begin));
+                }
+                if (aligned + size != end) {
+                    ::munmap(aligned + size, static_cast<std::size_t>(end - (aligned + size)));
+                }
+
+                address = aligned;
+            }
+
+#if defined(MADV_HUGEPAGE)
+            if (policy != HugePages::None && ::madvise(address, size, MADV_HUGEPAGE) == 0) {
+                mapping.m_hugePages = true;
+                ++s_transparentHugePages;
+            }
+#endif
+            // 'MAP_POPULATE' would create the pages before the advice - as normal pages
+            if (populate && align != pageSize()) {
+                touch(address, size, mapping.m_hugePages ? HugePageSize : pageSize());
+            }
+
+            mapping.m_address = address;
+#endif
+            ++s_mappings;
+            return mapping;
+        }
+
+        static void unmap(void* address, std::size_t bytes, HugePages policy) noexcept {
+#if defined(_WIN32)
+            (void) bytes;
+            (void) policy;
+            ::VirtualFree(address, 0, MEM_RELEASE);
+#else
+            ::munmap(address, mappingSize(bytes, policy));
+#endif
+        }
+
+    private:
+        // one write access per page creates the page (anonymous pages are zero-filled anyway)
+        static void touch(void* address, std::size_t size, std::size_t stride) {
+            volatile char* bytes{ static_cast<volatile char*>(address) };
+            for (std::size_t offset{}; offset < size; offset += stride) {
+                bytes[offset] = 0;
+            }
+        }
+    };
+
+    // STL allocator: large requests (at least 'Threshold' bytes) are mapped directly,
+    // smaller ones (e.g. a vector during its first reallocations) use 'operator new'
+    template <typename T, HugePages Policy = HugePages::Transparent, bool Populate = false>
+    class HugePageAllocator
+    {
+    public:
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        static constexpr std::size_t Threshold{ 1024 * 1024 };
+
+        template <typename U>
+        struct rebind
+        {
+            using other = HugePageAllocator<U, Policy, Populate>;
+        };
+
+        // c'tors
+        HugePageAllocator() noexcept = default;
+
+        template <typename U>
+        HugePageAllocator(const HugePageAllocator<U, Policy, Populate>&) noexcept {}
+
+        // allocator interface
+        T* allocate(std::size_t n) {
+
+            if (n > static_cast<std::size_t>(-1) / sizeof(T)) {
+                throw std::bad_array_new_length{};
+            }
+
+            const std::size_t bytes{ n * sizeof(T) };
+
+            if (bytes < Threshold) {
+                return static_cast<T*>(::operator new(bytes, std::align_val_t{ alignof(T) }));
+            }
+
+            return static_cast<T*>(PageMapper::map(bytes, alignof(T), Policy, Populate).m_address);
+        }
+
+        void deallocate(T* p, std::size_t n) noexcept {
+
+            const std::size_t bytes{ n * sizeof(T) };
+
+            if (bytes < Threshold) {
+                ::operator delete(p, std::align_val_t{ alignof(T) });
+            }
+            else {
+                PageMapper::unmap(p, bytes, Policy);
+            }
+        }
+
+        template <typename U>
+        bool operator== (const HugePageAllocator<U, Policy, Populate>&) const noexcept {
+            return true;
+        }
+    };
+
+    template <typename T, HugePages Policy = HugePages::Transparent, bool Populate = false>
+    using HugePageVector = std::vector<T, HugePageAllocator<T, Policy, Populate>>;
+}
+
+// ===========================================================================
+// End-of-File
+// ===========================================================================
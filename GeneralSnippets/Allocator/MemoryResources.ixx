@@ -0,0 +1,185 @@
+// =====================================================================================
+// MemoryResources.ixx // Memory Resources for Polymorphic Allocators (std::pmr)
+// =====================================================================================
+
+module;
+
+#include "HugePageAllocator.h"
+
+export module modern_cpp:memory_resources;
+
+import std;
+
+import :allocators;
+import :thread_caching_allocator;
+
+// a 'std::pmr::memory_resource' is selected at runtime: all containers using
+// 'std::pmr::polymorphic_allocator' have the same type, independent of the resource.
+// the resources of the standard library ('monotonic_buffer_resource', 'unsynchronized_pool_resource')
+// obtain their memory from an 'upstream' resource - the resources below can be combined with them
+
+namespace Allocator {
+
+    // counts all requests and records a histogram of the request sizes,
+    // the requests are forwarded to the upstream resource
+    class TrackingResource : public std::pmr::memory_resource
+    {
+    public:
+        // bucket k: requests of (2^(k-1), 2^k] bytes
+        static constexpr size_t NumBuckets{ 32 };
+
+    private:
+        std::pmr::memory_resource*     m_upstream;
+        AllocationStats                m_stats;
+        std::array<size_t, NumBuckets> m_histogram;
+
+    public:
+        // c'tor
+        explicit TrackingResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+            : m_upstream{ upstream }, m_stats{}, m_histogram{}
+        {}
+
+        // getter
+        const AllocationStats& stats() const { return m_stats; }
+        const std::array<size_t, NumBuckets>& histogram() const { return m_histogram; }
+
+        void reset() {
+            m_stats.reset();
+            m_histogram.fill(0);
+        }
+
+        static constexpr size_t bucketOf(size_t bytes) {
+            return std::min<size_t>(std::bit_width(bytes > 0 ? bytes - 1 : 0), NumBuckets - 1);
+        }
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            void* ptr{ m_upstream->allocate(bytes, alignment) };
+            m_stats.onAllocate(bytes);
+            ++m_histogram[bucketOf(bytes)];
+            return ptr;
+        }
+
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+            m_stats.onDeallocate(bytes);
+            m_upstream->deallocate(ptr, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    // =================================================================================
+    // memory directly from the operating system: requests of at least one huge page (2 MB)
+    // are mapped at a multiple of the huge page size and marked for transparent huge pages
+    // ('madvise' with 'MADV_HUGEPAGE', see 'PageMapper' in HugePageAllocator.h).
+    // suitable as upstream of a 'monotonic_buffer_resource' with a large initial buffer
+
+    class HugePageResource : public std::pmr::memory_resource
+    {
+    public:
+        static constexpr size_t HugePageSize{ PageMapper::HugePageSize };
+
+    private:
+        size_t m_mappedBytes;
+        size_t m_hugePageMappings;
+
+    public:
+        // c'tor
+        HugePageResource() : m_mappedBytes{}, m_hugePageMappings{} {}
+
+        // getter
+        size_t mappedBytes() const { return m_mappedBytes; }
+        size_t hugePageMappings() const { return m_hugePageMappings; }
+
+        static size_t pageSize() { return PageMapper::pageSize(); }
+
+    private:
+        static HugePages policyOf(size_t bytes) {
+            return bytes >= HugePageSize ? HugePages::Transparent : HugePages::None;
+        }
+
+        void* do_allocate(size_t bytes, size_t alignment) override {
+
+            const PageMapper::Mapping mapping{ PageMapper::map(bytes, alignment, policyOf(bytes), false) };
+
+            if (mapping.m_hugePages) {
+                ++m_hugePageMappings;
+            }
+
+            m_mappedBytes += mapping.m_size;
+            return mapping.m_address;
+        }
+
+        void do_deallocate(void* ptr, size_t bytes, size_t) override {
+            PageMapper::unmap(ptr, bytes, policyOf(bytes));
+            m_mappedBytes -= PageMapper::mappingSize(bytes, policyOf(bytes));
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    // =================================================================================
+    // requests of up to 1024 bytes are served by 'SmallObjectHeap': every thread has its own
+    // free lists, allocation and deallocation work without locks. A block released by another
+    // thread is put into the free list of the releasing thread, surplus blocks flow back in
+    // batches to the depot of the heap. Larger or over-aligned requests are forwarded to the
+    // upstream resource. The small blocks belong to the process-wide heap, not to the resource:
+    // the resource may be destroyed while other threads still cache blocks released through it
+
+    class PerThreadPoolResource : public std::pmr::memory_resource
+    {
+    public:
+        static constexpr size_t MaxBlockSize{ SmallObjectHeap::MaxSize };
+
+    private:
+        std::pmr::memory_resource* m_upstream;
+
+    public:
+        // c'tor
+        explicit PerThreadPoolResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+            : m_upstream{ upstream }
+        {}
+
+        PerThreadPoolResource(const PerThreadPoolResource&) = delete;
+        PerThreadPoolResource& operator=(const PerThreadPoolResource&) = delete;
+
+        // getter
+        std::pmr::memory_resource* upstream() const { return m_upstream; }
+
+    private:
+        static bool isSmall(size_t bytes, size_t alignment) {
+            return bytes <= MaxBlockSize && alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+        }
+
+        void* do_allocate(size_t bytes, size_t alignment) override {
+
+            if (!isSmall(bytes, alignment)) {
+                return m_upstream->allocate(bytes, alignment);
+            }
+
+            return SmallObjectHeap::allocate(bytes);
+        }
+
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+
+            if (!isSmall(bytes, alignment)) {
+                m_upstream->deallocate(ptr, bytes, alignment);
+                return;
+            }
+
+            SmallObjectHeap::deallocate(ptr, bytes);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
@@ -7,6 +7,7 @@ export module modern_cpp:allocator;
 import std;
 
 export void main_allocator();
+export void main_allocator_benchmark();
 
 // =====================================================================================
 // End-of-File
@@ -0,0 +1,364 @@
+// =====================================================================================
+// ThreadCachingAllocator.ixx // Size-Class Small-Object Allocator with Thread Caches
+// =====================================================================================
+
+export module modern_cpp:thread_caching_allocator;
+
+import std;
+
+// small objects (up to 1024 bytes) are served from free lists of size classes.
+// every thread owns a cache with one free list per size class - no locks, no atomics.
+// the caches exchange blocks with a global depot in batches:
+//  - an empty free list takes a batch from the depot (or from a new span)
+//  - a free list with more than two batches returns one batch to the depot
+// a block released by another thread goes into the cache of the releasing thread,
+// surplus blocks flow back to the depot - memory doesn't pile up in one thread.
+// the caches of a terminating thread are returned to the depot completely.
+// the depot chains its batches through their first blocks: returning a batch
+// never allocates, 'deallocate' can't fail
+
+namespace Allocator {
+
+    class SmallObjectHeap
+    {
+    public:
+        static constexpr size_t MaxSize{ 1024 };
+        static constexpr size_t SpanSize{ 256 * 1024 };
+
+        static constexpr std::array<std::uint16_t, 20> SizeClasses{
+            16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640, 768, 896, 1024
+        };
+
+        static constexpr size_t NumSizeClasses{ SizeClasses.size() };
+
+        // counters of the depot (slow path only)
+        struct Statistics
+        {
+            size_t m_spans;
+            size_t m_batchesFetched;
+            size_t m_batchesReturned;
+        };
+
+    private:
+        // a batch is a null-terminated list of at most 'batchSize' blocks,
+        // in the depot the batches are linked through their first blocks
+        // (the smallest size class has room for both pointers)
+        struct FreeBlock
+        {
+            FreeBlock* m_next;
+            FreeBlock* m_nextBatch;
+        };
+
+        struct CentralList
+        {
+            std::mutex m_mutex;
+            FreeBlock* m_batches{};
+        };
+
+        struct Depot
+        {
+            std::array<CentralList, NumSizeClasses> m_lists;
+            std::atomic<size_t> m_spans;
+            std::atomic<size_t> m_batchesFetched;
+            std::atomic<size_t> m_batchesReturned;
+        };
+
+        struct FreeList
+        {
+            FreeBlock* m_head{};
+            size_t     m_count{};
+        };
+
+        enum class CacheState : unsigned char { Unregistered, Active, Drained };
+
+        // trivially destructible: still usable after the end of the thread,
+        // when objects with static storage duration release their memory
+        struct ThreadCache
+        {
+            std::array<FreeList, NumSizeClasses> m_freeLists{};
+            CacheState m_state{ CacheState::Unregistered };
+        };
+
+        // returns all blocks of the thread cache to the depot at the end of the thread
+        struct CacheDrain
+        {
+            ~CacheDrain() {
+                ThreadCache& cache{ threadCache() };
+
+                for (size_t sizeClass{}; sizeClass != NumSizeClasses; ++sizeClass) {
+                    FreeList& list{ cache.m_freeLists[sizeClass] };
+                    while (list.m_count != 0) {
+                        returnBatch(sizeClass, list);
+                    }
+                }
+
+                cache.m_state = CacheState::Drained;
+            }
+        };
+
+    public:
+        // public interface
+        static void* allocate(size_t bytes) {
+
+            if (bytes > MaxSize) {
+                return ::operator new(bytes);
+            }
+
+            const size_t sizeClass{ sizeClassOf(bytes) };
+            ThreadCache& cache{ threadCache() };
+            FreeList& list{ cache.m_freeLists[sizeClass] };
+
+            if (list.m_head == nullptr) {
+                if (!activate(cache)) {
+                    return allocateUncached(sizeClass);
+                }
+                fetchBatch(sizeClass, list);
+            }
+
+            FreeBlock* block{ list.m_head };
+            list.m_head = block->m_next;
+            --list.m_count;
+            return block;
+        }
+
+        static void deallocate(void* ptr, size_t bytes) noexcept {
+
+            if (bytes > MaxSize) {
+                ::operator delete(ptr);
+                return;
+            }
+
+            const size_t sizeClass{ sizeClassOf(bytes) };
+            ThreadCache& cache{ threadCache() };
+
+            if (cache.m_state != CacheState::Active && !activate(cache)) {
+                deallocateUncached(sizeClass, ptr);
+                return;
+            }
+
+            FreeList& list{ cache.m_freeLists[sizeClass] };
+
+            list.m_head = ::new (ptr) FreeBlock{ list.m_head, nullptr };
+            ++list.m_count;
+
+            if (list.m_count > 2 * batchSize(sizeClass)) {
+                returnBatch(sizeClass, list);
+            }
+        }
+
+        static Statistics statistics() {
+            const Depot& central{ depot() };
+            return {
+                central.m_spans.load(std::memory_order_relaxed),
+                central.m_batchesFetched.load(std::memory_order_relaxed),
+                central.m_batchesReturned.load(std::memory_order_relaxed)
+            };
+        }
+
+        static constexpr size_t sizeClassOf(size_t bytes) {
+            return SizeClassIndex[(std::max<size_t>(bytes, 1) + 15) / 16];
+        }
+
+        // number of blocks moved between a thread cache and the depot at once
+        static constexpr size_t batchSize(size_t sizeClass) {
+            return std::clamp<size_t>(8192 / SizeClasses[sizeClass], 8, 128);
+        }
+
+    private:
+        // maps (bytes + 15) / 16 to the smallest sufficient size class
+        static constexpr std::array<std::uint8_t, MaxSize / 16 + 1> SizeClassIndex{ [] {
+            std::array<std::uint8_t, MaxSize / 16 + 1> index{};
+            std::uint8_t sizeClass{};
+            for (size_t i{}; i != index.size(); ++i) {
+                while (SizeClasses[sizeClass] < i * 16) {
+                    ++sizeClass;
+                }
+                index[i] = sizeClass;
+            }
+            return index;
+        } () };
+
+        // never destroyed: the thread cache of the main thread is drained before the
+        // objects with static storage duration are destroyed, containers with static
+        // storage duration release their memory directly into the depot afterwards
+        static Depot& depot() {
+            static Depot* s_depot{ new Depot{} };
+            return *s_depot;
+        }
+
+        // constant initialized: no guard variable is checked on the fast path
+        static ThreadCache& threadCache() {
+            thread_local constinit ThreadCache cache{};
+            return cache;
+        }
+
+        // the first use of the cache by a thread registers its drain,
+        // a drained cache isn't used any more ('false')
+        static bool activate(ThreadCache& cache) noexcept {
+
+            if (cache.m_state == CacheState::Unregistered) {
+                thread_local CacheDrain drain{};
+                cache.m_state = CacheState::Active;
+            }
+
+            return cache.m_state == CacheState::Active;
+        }
+
+        // called with the mutex of the central list locked
+        static FreeBlock* popBatch(size_t sizeClass, CentralList& centralList) {
+
+            if (centralList.m_batches == nullptr) {
+                carveSpan(sizeClass, centralList);
+            }
+
+            FreeBlock* batch{ centralList.m_batches };
+            centralList.m_batches = batch->m_nextBatch;
+            return batch;
+        }
+
+        static void pushBatch(CentralList& centralList, FreeBlock* batch) noexcept {
+
+            std::lock_guard<std::mutex> guard{ centralList.m_mutex };
+            batch->m_nextBatch = centralList.m_batches;
+            centralList.m_batches = batch;
+        }
+
+        static void fetchBatch(size_t sizeClass, FreeList& list) {
+
+            Depot& central{ depot() };
+            CentralList& centralList{ central.m_lists[sizeClass] };
+
+            FreeBlock* batch{};
+            {
+                std::lock_guard<std::mutex> guard{ centralList.m_mutex };
+                batch = popBatch(sizeClass, centralList);
+            }
+
+            // the depot doesn't store the length of a batch
+            size_t count{};
+            for (FreeBlock* block{ batch }; block != nullptr; block = block->m_next) {
+                ++count;
+            }
+
+            list.m_head = batch;
+            list.m_count = count;
+
+            central.m_batchesFetched.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        static void returnBatch(size_t sizeClass, FreeList& list) noexcept {
+
+            // detaches the first (at most) 'batchSize' blocks
+            FreeBlock* batch{ list.m_head };
+            FreeBlock* last{ list.m_head };
+            size_t count{ 1 };
+            while (count != batchSize(sizeClass) && last->m_next != nullptr) {
+                last = last->m_next;
+                ++count;
+            }
+
+            list.m_head = last->m_next;
+            list.m_count -= count;
+            last->m_next = nullptr;
+
+            Depot& central{ depot() };
+            pushBatch(central.m_lists[sizeClass], batch);
+
+            central.m_batchesReturned.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // the thread cache has been drained: single blocks are taken from the depot
+        static void* allocateUncached(size_t sizeClass) {
+
+            CentralList& centralList{ depot().m_lists[sizeClass] };
+            std::lock_guard<std::mutex> guard{ centralList.m_mutex };
+
+            FreeBlock* block{ popBatch(sizeClass, centralList) };
+
+            // the rest of the batch goes back into the depot
+            if (block->m_next != nullptr) {
+                block->m_next->m_nextBatch = centralList.m_batches;
+                centralList.m_batches = block->m_next;
+            }
+
+            return block;
+        }
+
+        // ... and a single block is returned as a batch of its own
+        static void deallocateUncached(size_t sizeClass, void* ptr) noexcept {
+            pushBatch(depot().m_lists[sizeClass], ::new (ptr) FreeBlock{ nullptr, nullptr });
+        }
+
+        // called with the mutex of the central list locked: a new span is split into batches.
+        // spans are never released, the blocks of a size class are reused by this size class only
+        static void carveSpan(size_t sizeClass, CentralList& centralList) {
+
+            // 'operator new' aligns to __STDCPP_DEFAULT_NEW_ALIGNMENT__, all sizes are multiples of 16
+            std::byte* span{ static_cast<std::byte*>(::operator new(SpanSize)) };
+            depot().m_spans.fetch_add(1, std::memory_order_relaxed);
+
+            const size_t blockSize{ SizeClasses[sizeClass] };
+            const size_t numBlocks{ SpanSize / blockSize };
+            const size_t perBatch{ batchSize(sizeClass) };
+
+            for (size_t first{}; first < numBlocks; first += perBatch) {
+
+                const size_t count{ std::min(perBatch, numBlocks - first) };
+
+                FreeBlock* head{};
+                for (size_t i{ first + count }; i != first; --i) {
+                    head = ::new (span + (i - 1) * blockSize) FreeBlock{ head, nullptr };
+                }
+
+                head->m_nextBatch = centralList.m_batches;
+                centralList.m_batches = head;
+            }
+        }
+    };
+
+    // stateless STL allocator: all instances share the process-wide heap,
+    // memory allocated by one instance can be released by every other instance
+    template <typename T>
+    class ThreadCachingAllocator
+    {
+    public:
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        // c'tors
+        ThreadCachingAllocator() noexcept = default;
+
+        template <typename U>
+        ThreadCachingAllocator(const ThreadCachingAllocator<U>&) noexcept {}
+
+        // allocator interface
+        T* allocate(size_t n) {
+
+            if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ alignof(T) }));
+            }
+            else {
+                return static_cast<T*>(SmallObjectHeap::allocate(n * sizeof(T)));
+            }
+        }
+
+        void deallocate(T* p, size_t n) noexcept {
+
+            if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                ::operator delete(p, std::align_val_t{ alignof(T) });
+            }
+            else {
+                SmallObjectHeap::deallocate(p, n * sizeof(T));
+            }
+        }
+
+        template <typename U>
+        bool operator== (const ThreadCachingAllocator<U>&) const noexcept {
+            return true;
+        }
+    };
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
@@ -0,0 +1,666 @@
+// =====================================================================================
+// Blas.ixx // BLAS Level 1 Kernels with Runtime CPU Feature Dispatch
+// =====================================================================================
+
+module;
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BLAS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang need a target attribute to accept intrinsics beyond the baseline ISA,
+// the Visual C++ compiler accepts them in every function
+#if defined(_MSC_VER) && !defined(__clang__)
+#define BLAS_TARGET(features)
+#else
+#define BLAS_TARGET(features) __attribute__((target(features)))
+#endif
+
+#include "../Allocator/AlignedAllocator.h"
+
+export module modern_cpp_exercises:blas;
+
+import std;
+
+namespace Blas {
+
+    enum class Isa { Scalar, SSE2, AVX2, AVX512 };
+
+    inline std::string_view toString(Isa isa)
+    {
+        switch (isa) {
+        case Isa::SSE2:   return "SSE2";
+        case Isa::AVX2:   return "AVX2+FMA";
+        case Isa::AVX512: return "AVX-512";
+        default:          return "Scalar";
+        }
+    }
+
+    // =================================================================================
+    // CPU features
+
+    struct CpuFeatures
+    {
+        bool m_sse2;
+        bool m_avx2;
+        bool m_fma;
+        bool m_avx512f;
+    };
+
+    inline CpuFeatures detectCpuFeatures()
+    {
+        CpuFeatures features{};
+
+#if defined(BLAS_X86) && defined(_MSC_VER) && !defined(__clang__)
+        int info[4]{};
+
+        ::__cpuid(info, 0);
+        int maxLeaf{ info[0] };
+
+        ::__cpuid(info, 1);
+        features.m_sse2 = (info[3] & (1 << 26)) != 0;
+        features.m_fma = (info[2] & (1 << 12)) != 0;
+        bool osxsave{ (info[2] & (1 << 27)) != 0 };
+
+        // operating system must save the AVX (YMM) and AVX-512 (ZMM, opmask) registers
+        unsigned long long xcr0{ osxsave ? ::_xgetbv(0) : 0 };
+        bool osSavesYmm{ (xcr0 & 0x06) == 0x06 };
+        bool osSavesZmm{ (xcr0 & 0xE6) == 0xE6 };
+
+        if (maxLeaf >= 7) {
+            ::__cpuidex(info, 7, 0);
+            features.m_avx2 = osSavesYmm && (info[1] & (1 << 5)) != 0;
+            features.m_avx512f = osSavesZmm && (info[1] & (1 << 16)) != 0;
+        }
+
+        features.m_fma = features.m_fma && osSavesYmm;
+
+#elif defined(BLAS_X86)
+        __builtin_cpu_init();
+        features.m_sse2 = __builtin_cpu_supports("sse2");
+        features.m_avx2 = __builtin_cpu_supports("avx2");
+        features.m_fma = __builtin_cpu_supports("fma");
+        features.m_avx512f = __builtin_cpu_supports("avx512f");
+#endif
+
+        return features;
+    }
+
+    inline bool isSupported(Isa isa)
+    {
+        static const CpuFeatures features{ detectCpuFeatures() };
+
+        switch (isa) {
+        case Isa::SSE2:   return features.m_sse2;
+        case Isa::AVX2:   return features.m_avx2 && features.m_fma;
+        case Isa::AVX512: return features.m_avx512f && features.m_fma;
+        default:          return true;
+        }
+    }
+
+    // =================================================================================
+    // scalar kernels
+
+    inline double dotScalar(size_t n, const double* x, const double* y)
+    {
+        double result{};
+        for (size_t i{}; i != n; ++i) {
+            result += x[i] * y[i];
+        }
+        return result;
+    }
+
+    inline void axpyScalar(size_t n, double alpha, const double* x, double* y)
+    {
+        for (size_t i{}; i != n; ++i) {
+            y[i] += alpha * x[i];
+        }
+    }
+
+    inline void scalScalar(size_t n, double alpha, double* x)
+    {
+        for (size_t i{}; i != n; ++i) {
+            x[i] *= alpha;
+        }
+    }
+
+    inline double asumScalar(size_t n, const double* x)
+    {
+        double result{};
+        for (size_t i{}; i != n; ++i) {
+            result += std::abs(x[i]);
+        }
+        return result;
+    }
+
+    // NaN propagates: std::max returns its first argument, if one of both is NaN
+    inline double maxWithNaN(double a, double b)
+    {
+        return std::isnan(b) ? b : std::max(a, b);
+    }
+
+    inline double amaxScalar(size_t n, const double* x)
+    {
+        double result{};
+        for (size_t i{}; i != n; ++i) {
+            result = maxWithNaN(result, std::abs(x[i]));
+        }
+        return result;
+    }
+
+#if defined(BLAS_X86)
+
+    // =================================================================================
+    // alignment: kernels with two vectors use aligned loads and stores, if both vectors
+    // have the same offset to a register boundary - after a few scalar steps ("peeling")
+    // both are aligned. Otherwise unaligned loads are used, a load may span two cache lines
+
+    inline size_t peelCount(size_t n, const double* x, const double* y, size_t alignment)
+    {
+        size_t peel{ Allocator::elementsToAlignment(x, alignment) };
+
+        if (peel != Allocator::elementsToAlignment(y, alignment) || peel > n) {
+            return Allocator::Unreachable;
+        }
+
+        return peel;
+    }
+
+    // =================================================================================
+    // SSE2 kernels (2 doubles per register)
+
+    template <bool Aligned>
+    BLAS_TARGET("sse2")
+    inline __m128d loadSSE2(const double* p)
+    {
+        if constexpr (Aligned) {
+            return _mm_load_pd(p);
+        }
+        else {
+            return _mm_loadu_pd(p);
+        }
+    }
+
+    template <bool Aligned>
+    BLAS_TARGET("sse2")
+    inline void storeSSE2(double* p, __m128d value)
+    {
+        if constexpr (Aligned) {
+            _mm_store_pd(p, value);
+        }
+        else {
+            _mm_storeu_pd(p, value);
+        }
+    }
+
+    template <bool Aligned>
+    BLAS_TARGET("sse2")
+    inline double dotKernelSSE2(size_t n, const double* x, const double* y)
+    {
+        __m128d sum0{ _mm_setzero_pd() };
+        __m128d sum1{ _mm_setzero_pd() };
+
+        size_t i{};
+        for (; i + 4 <= n; i += 4) {
+            sum0 = _mm_add_pd(sum0, _mm_mul_pd(loadSSE2<Aligned>(x + i), loadSSE2<Aligned>(y + i)));
+            sum1 = _mm_add_pd(sum1, _mm_mul_pd(loadSSE2<Aligned>(x + i + 2), loadSSE2<Aligned>(y + i + 2)));
+        }
+
+        __m128d sum{ _mm_add_pd(sum0, sum1) };
+        double result{ _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum))) };
+
+        return result + dotScalar(n - i, x + i, y + i);
+    }
+
+    BLAS_TARGET("sse2")
+    inline double dotSSE2(size_t n, const double* x, const double* y)
+    {
+        size_t peel{ peelCount(n, x, y, 16) };
+
+        if (peel == Allocator::Unreachable) {
+            return dotKernelSSE2<false>(n, x, y);
+        }
+
+        return dotScalar(peel, x, y) + dotKernelSSE2<true>(n - peel, x + peel, y + peel);
+    }
+
+    template <bool Aligned>
+    BLAS_TARGET("sse2")
+    inline void axpyKernelSSE2(size_t n, double alpha, const double* x, double* y)
+    {
+        __m128d factor{ _mm_set1_pd(alpha) };
+
+        size_t i{};
+        for (; i + 2 <= n; i += 2) {
+            storeSSE2<Aligned>(y + i, _mm_add_pd(loadSSE2<Aligned>(y + i), _mm_mul_pd(factor, loadSSE2<Aligned>(x + i))));
+        }
+
+        axpyScalar(n - i, alpha, x + i, y + i);
+    }
+
+    BLAS_TARGET("sse2")
+    inline void axpySSE2(size_t n, double alpha, const double* x, double* y)
+    {
+        size_t peel{ peelCount(n, x, y, 16) };
+
+        if (peel == Allocator::Unreachable) {
+            axpyKernelSSE2<false>(n, alpha, x, y);
+            return;
+        }
+
+        axpyScalar(peel, alpha, x, y);
+        axpyKernelSSE2<true>(n - peel, alpha, x + peel, y + peel);
+    }
+
+    BLAS_TARGET("sse2")
+    inline void scalSSE2(size_t n, double alpha, double* x)
+    {
+        __m128d factor{ _mm_set1_pd(alpha) };
+
+        size_t i{};
+        for (; i + 2 <= n; i += 2) {
+            _mm_storeu_pd(x + i, _mm_mul_pd(factor, _mm_loadu_pd(x + i)));
+        }
+
+        scalScalar(n - i, alpha, x + i);
+    }
+
+    BLAS_TARGET("sse2")
+    inline double asumSSE2(size_t n, const double* x)
+    {
+        __m128d signMask{ _mm_set1_pd(-0.0) };
+        __m128d sum{ _mm_setzero_pd() };
+
+        size_t i{};
+        for (; i + 2 <= n; i += 2) {
+            sum = _mm_add_pd(sum, _mm_andnot_pd(signMask, _mm_loadu_pd(x + i)));
+        }
+
+        double result{ _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum))) };
+
+        return result + asumScalar(n - i, x + i);
+    }
+
+    BLAS_TARGET("sse2")
+    inline double amaxSSE2(size_t n, const double* x)
+    {
+        __m128d signMask{ _mm_set1_pd(-0.0) };
+        __m128d max{ _mm_setzero_pd() };
+        __m128d nan{ _mm_setzero_pd() };
+
+        // maxpd drops a NaN in one of the operands, NaNs are collected separately
+        size_t i{};
+        for (; i + 2 <= n; i += 2) {
+            __m128d value{ _mm_andnot_pd(signMask, _mm_loadu_pd(x + i)) };
+            max = _mm_max_pd(max, value);
+            nan = _mm_or_pd(nan, _mm_cmpunord_pd(value, value));
+        }
+
+        if (_mm_movemask_pd(nan) != 0) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+
+        double result{ _mm_cvtsd_f64(_mm_max_sd(max, _mm_unpackhi_pd(max, max))) };
+
+        return maxWithNaN(result, amaxScalar(n - i, x + i));
+    }
+
+    // =================================================================================
+    // AVX2 + FMA kernels (4 doubles per register)
+
+    BLAS_TARGET("avx2,fma")
+    inline double horizontalSumAVX(__m256d value)
+    {
+        __m128d sum{ _mm_add_pd(_mm256_castpd256_pd128(value), _mm256_extractf128_pd(value, 1)) };
+        return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+    }
+
+    BLAS_TARGET("avx2,fma")
+    inline double horizontalMaxAVX(__m256d value)
+    {
+        __m128d max{ _mm_max_pd(_mm256_castpd256_pd128(value), _mm256_extractf128_pd(value, 1)) };
+        return _mm_cvtsd_f64(_mm_max_sd(max, _mm_unpackhi_pd(max, max)));
+    }
+
+    template <bool Aligned>
+    BLAS_TARGET("avx2,fma")
+    inline __m256d loadAVX(const double* p)
+    {
+        if constexpr (Aligned) {
+            return _mm256_load_pd(p);
+        }
+        else {
+            return _mm256_loadu_pd(p);
+        }
+    }
+
+    template <bool Aligned>
+    BLAS_TARGET("avx2,fma")
+    inline void storeAVX(double* p, __m256d value)
+    {
+        if constexpr (Aligned) {
+            _mm256_store_pd(p, value);
+        }
+        else {
+            _mm256_storeu_pd(p, value);
+        }
+    }
+
+    template <bool Aligned>
+    BLAS_TARGET("avx2,fma")
+    inline double dotKernelAVX2(size_t n, const double* x, const double* y)
+    {
+        __m256d sum0{ _mm256_setzero_pd() };
+        __m256d sum1{ _mm256_setzero_pd() };
+
+        size_t i{};
+        for (; i + 8 <= n; i += 8) {
+            sum0 = _mm256_fmadd_pd(loadAVX<Aligned>(x + i), loadAVX<Aligned>(y + i), sum0);
+            sum1 = _mm256_fmadd_pd(loadAVX<Aligned>(x + i + 4), loadAVX<Aligned>(y + i + 4), sum1);
+        }
+
+        double result{ horizontalSumAVX(_mm256_add_pd(sum0, sum1)) };
+
+        return result + dotScalar(n - i, x + i, y + i);
+    }
+
+    BLAS_TARGET("avx2,fma")
+    inline double dotAVX2(size_t n, const double* x, const double* y)
+    {
+        size_t peel{ peelCount(n, x, y, 32) };
+
+        if (peel == Allocator::Unreachable) {
+            return dotKernelAVX2<false>(n, x, y);
+        }
+
+        return dotScalar(peel, x, y) + dotKernelAVX2<true>(n - peel, x + peel, y + peel);
+    }
+
+    template <bool Aligned>
+    BLAS_TARGET("avx2,fma")
+    inline void axpyKernelAVX2(size_t n, double alpha, const double* x, double* y)
+    {
+        __m256d factor{ _mm256_set1_pd(alpha) };
+
+        size_t i{};
+        for (; i + 4 <= n; i += 4) {
+            storeAVX<Aligned>(y + i, _mm256_fmadd_pd(factor, loadAVX<Aligned>(x + i), loadAVX<Aligned>(y + i)));
+        }
+
+        axpyScalar(n - i, alpha, x + i, y + i);
+    }
+
+    BLAS_TARGET("avx2,fma")
+    inline void axpyAVX2(size_t n, double alpha, const double* x, double* y)
+    {
+        size_t peel{ peelCount(n, x, y, 32) };
+
+        if (peel == Allocator::Unreachable) {
+            axpyKernelAVX2<false>(n, alpha, x, y);
+            return;
+        }
+
+        axpyScalar(peel, alpha, x, y);
+        axpyKernelAVX2<true>(n - peel, alpha, x + peel, y + peel);
+    }
+
+    BLAS_TARGET("avx2,fma")
+    inline void scalAVX2(size_t n, double alpha, double* x)
+    {
+        __m256d factor{ _mm256_set1_pd(alpha) };
+
+        size_t i{};
+        for (; i + 4 <= n; i += 4) {
+            _mm256_storeu_pd(x + i, _mm256_mul_pd(factor, _mm256_loadu_pd(x + i)));
+        }
+
+        scalScalar(n - i, alpha, x + i);
+    }
+
+    BLAS_TARGET("avx2,fma")
+    inline double asumAVX2(size_t n, const double* x)
+    {
+        __m256d signMask{ _mm256_set1_pd(-0.0) };
+        __m256d sum{ _mm256_setzero_pd() };
+
+        size_t i{};
+        for (; i + 4 <= n; i += 4) {
+            sum = _mm256_add_pd(sum, _mm256_andnot_pd(signMask, _mm256_loadu_pd(x + i)));
+        }
+
+        return horizontalSumAVX(sum) + asumScalar(n - i, x + i);
+    }
+
+    BLAS_TARGET("avx2,fma")
+    inline double amaxAVX2(size_t n, const double* x)
+    {
+        __m256d signMask{ _mm256_set1_pd(-0.0) };
+        __m256d max{ _mm256_setzero_pd() };
+        __m256d nan{ _mm256_setzero_pd() };
+
+        size_t i{};
+        for (; i + 4 <= n; i += 4) {
+            __m256d value{ _mm256_andnot_pd(signMask, _mm256_loadu_pd(x + i)) };
+            max = _mm256_max_pd(max, value);
+            nan = _mm256_or_pd(nan, _mm256_cmp_pd(value, value, _CMP_UNORD_Q));
+        }
+
+        if (_mm256_movemask_pd(nan) != 0) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+
+        return maxWithNaN(horizontalMaxAVX(max), amaxScalar(n - i, x + i));
+    }
+
+    // =================================================================================
+    // AVX-512 kernels (8 doubles per register), remainders are handled with masks
+
+    template <bool Aligned>
+    BLAS_TARGET("avx512f,avx2,fma")
+    inline __m512d loadAVX512(const double* p)
+    {
+        if constexpr (Aligned) {
+            return _mm512_load_pd(p);
+        }
+        else {
+            return _mm512_loadu_pd(p);
+        }
+    }
+
+    // the remainder uses masked (unaligned) loads: the masked elements are never accessed
+    template <bool Aligned>
+    BLAS_TARGET("avx512f,avx2,fma")
+    inline double dotKernelAVX512(size_t n, const double* x, const double* y)
+    {
+        __m512d sum0{ _mm512_setzero_pd() };
+        __m512d sum1{ _mm512_setzero_pd() };
+
+        size_t i{};
+        for (; i + 16 <= n; i += 16) {
+            sum0 = _mm512_fmadd_pd(loadAVX512<Aligned>(x + i), loadAVX512<Aligned>(y + i), sum0);
+            sum1 = _mm512_fmadd_pd(loadAVX512<Aligned>(x + i + 8), loadAVX512<Aligned>(y + i + 8), sum1);
+        }
+
+        for (; i < n; i += 8) {
+            __mmask8 mask{ static_cast<__mmask8>((n - i >= 8) ? 0xFF : (1u << (n - i)) - 1) };
+            sum0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i), sum0);
+        }
+
+        return _mm512_reduce_add_pd(_mm512_add_pd(sum0, sum1));
+    }
+
+    BLAS_TARGET("avx512f,avx2,fma")
+    inline double dotAVX512(size_t n, const double* x, const double* y)
+    {
+        size_t peel{ peelCount(n, x, y, 64) };
+
+        if (peel == Allocator::Unreachable) {
+            return dotKernelAVX512<false>(n, x, y);
+        }
+
+        return dotScalar(peel, x, y) + dotKernelAVX512<true>(n - peel, x + peel, y + peel);
+    }
+
+    BLAS_TARGET("avx512f,avx2,fma")
+    inline void axpyAVX512(size_t n, double alpha, const double* x, double* y)
+    {
+        __m512d factor{ _mm512_set1_pd(alpha) };
+
+        for (size_t i{}; i < n; i += 8) {
+            __mmask8 mask{ static_cast<__mmask8>((n - i >= 8) ? 0xFF : (1u << (n - i)) - 1) };
+            __m512d result{ _mm512_fmadd_pd(factor, _mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i)) };
+            _mm512_mask_storeu_pd(y + i, mask, result);
+        }
+    }
+
+    BLAS_TARGET("avx512f,avx2,fma")
+    inline void scalAVX512(size_t n, double alpha, double* x)
+    {
+        __m512d factor{ _mm512_set1_pd(alpha) };
+
+        for (size_t i{}; i < n; i += 8) {
+            __mmask8 mask{ static_cast<__mmask8>((n - i >= 8) ? 0xFF : (1u << (n - i)) - 1) };
+            _mm512_mask_storeu_pd(x + i, mask, _mm512_mul_pd(factor, _mm512_maskz_loadu_pd(mask, x + i)));
+        }
+    }
+
+    BLAS_TARGET("avx512f,avx2,fma")
+    inline double asumAVX512(size_t n, const double* x)
+    {
+        __m512d sum{ _mm512_setzero_pd() };
+
+        for (size_t i{}; i < n; i += 8) {
+            __mmask8 mask{ static_cast<__mmask8>((n - i >= 8) ? 0xFF : (1u << (n - i)) - 1) };
+            sum = _mm512_add_pd(sum, _mm512_abs_pd(_mm512_maskz_loadu_pd(mask, x + i)));
+        }
+
+        return _mm512_reduce_add_pd(sum);
+    }
+
+    BLAS_TARGET("avx512f,avx2,fma")
+    inline double amaxAVX512(size_t n, const double* x)
+    {
+        __m512d max{ _mm512_setzero_pd() };
+        __mmask8 nan{};
+
+        for (size_t i{}; i < n; i += 8) {
+            __mmask8 mask{ static_cast<__mmask8>((n - i >= 8) ? 0xFF : (1u << (n - i)) - 1) };
+            __m512d value{ _mm512_abs_pd(_mm512_maskz_loadu_pd(mask, x + i)) };
+            max = _mm512_max_pd(max, value);
+            nan |= _mm512_cmp_pd_mask(value, value, _CMP_UNORD_Q);
+        }
+
+        if (nan != 0) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+
+        return _mm512_reduce_max_pd(max);
+    }
+
+#endif
+
+    // =================================================================================
+    // dispatch table: one set of function pointers per instruction set
+
+    struct Kernels
+    {
+        Isa m_isa;
+        double (*m_dot) (size_t, const double*, const double*);
+        void   (*m_axpy)(size_t, double, const double*, double*);
+        void   (*m_scal)(size_t, double, double*);
+        double (*m_asum)(size_t, const double*);
+        double (*m_amax)(size_t, const double*);
+    };
+
+    inline Kernels kernelsFor(Isa isa)
+    {
+        switch (isa) {
+#if defined(BLAS_X86)
+        case Isa::SSE2:
+            return { Isa::SSE2, dotSSE2, axpySSE2, scalSSE2, asumSSE2, amaxSSE2 };
+        case Isa::AVX2:
+            return { Isa::AVX2, dotAVX2, axpyAVX2, scalAVX2, asumAVX2, amaxAVX2 };
+        case Isa::AVX512:
+            return { Isa::AVX512, dotAVX512, axpyAVX512, scalAVX512, asumAVX512, amaxAVX512 };
+#endif
+        default:
+            return { Isa::Scalar, dotScalar, axpyScalar, scalScalar, asumScalar, amaxScalar };
+        }
+    }
+
+    // best instruction set of the executing CPU - determined once
+    inline const Kernels& activeKernels()
+    {
+        static const Kernels kernels{
+            [] {
+                for (Isa isa : { Isa::AVX512, Isa::AVX2, Isa::SSE2 }) {
+                    if (isSupported(isa)) {
+                        return kernelsFor(isa);
+                    }
+                }
+                return kernelsFor(Isa::Scalar);
+            }()
+        };
+
+        return kernels;
+    }
+
+    // =================================================================================
+    // public interface
+
+    inline double dot(std::span<const double> x, std::span<const double> y)
+    {
+        return activeKernels().m_dot(std::min(x.size(), y.size()), x.data(), y.data());
+    }
+
+    // y = alpha * x + y
+    inline void axpy(double alpha, std::span<const double> x, std::span<double> y)
+    {
+        activeKernels().m_axpy(std::min(x.size(), y.size()), alpha, x.data(), y.data());
+    }
+
+    // x = alpha * x
+    inline void scal(double alpha, std::span<double> x)
+    {
+        activeKernels().m_scal(x.size(), alpha, x.data());
+    }
+
+    // Euclidean norm (without the rescaling of the reference BLAS, may overflow for huge values)
+    inline double nrm2(std::span<const double> x)
+    {
+        return std::sqrt(activeKernels().m_dot(x.size(), x.data(), x.data()));
+    }
+
+    // sum of absolute values
+    inline double asum(std::span<const double> x)
+    {
+        return activeKernels().m_asum(x.size(), x.data());
+    }
+
+    // index of first element with maximum absolute value, x.size() for an empty vector.
+    // As in the reference BLAS, a NaN is greater than any value: the index of the first NaN is returned
+    inline size_t iamax(const Kernels& kernels, std::span<const double> x)
+    {
+        double max{ kernels.m_amax(x.size(), x.data()) };
+
+        auto pos{ std::isnan(max)
+            ? std::find_if(x.begin(), x.end(), [](double value) { return std::isnan(value); })
+            : std::find_if(x.begin(), x.end(), [=](double value) { return std::abs(value) == max; })
+        };
+
+        return static_cast<size_t>(std::distance(x.begin(), pos));
+    }
+
+    inline size_t iamax(std::span<const double> x)
+    {
+        return iamax(activeKernels(), x);
+    }
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
@@ -5,6 +5,7 @@
 module;
 
 #include "../ScopedTimer/ScopedTimer.h"
+#include "../Allocator/HugePageAllocator.h"
 
 module modern_cpp_exercises:move_semantics;
 
@@ -70,6 +71,9 @@ namespace Exercises_MoveSemantics {
 
 // #define SOLUTION 
 
+        // arrays of at least 1 MB are mapped directly, marked for transparent huge pages
+        using HugeArrayAllocator = Allocator::HugePageAllocator<int>;
+
         class HugeArray {
         private:
             size_t m_len;
@@ -95,29 +99,29 @@ namespace Exercises_MoveSemantics {
             std::cout << "default c'tor" << std::endl;
         }
 
-        HugeArray::HugeArray(size_t len) : m_len(len), m_data(new int[len]) {
+        HugeArray::HugeArray(size_t len) : m_len(len), m_data(HugeArrayAllocator{}.allocate(len)) {
             std::cout << "c'tor (size_t):  " << len << " allocated" << std::endl;
         }
 
         HugeArray::~HugeArray() {
             std::cout << "d'tor:           " << m_len << " relased" << std::endl;
-            delete[] m_data;
+            HugeArrayAllocator{}.deallocate(m_data, m_len);
         }
 
         // copy semantics
         HugeArray::HugeArray(const HugeArray& other) {
             std::cout << "COPY c'tor:      " << other.m_len << " allocated" << std::endl;
             m_len = other.m_len;
-            m_data = new int[other.m_len];
+            m_data = HugeArrayAllocator{}.allocate(other.m_len);
             std::copy(other.m_data, other.m_data + m_len, m_data);
         }
 
         HugeArray& HugeArray::operator=(const HugeArray& other) {
             std::cout << "COPY assignment: " << other.m_len << " assigned" << std::endl;
             if (this != &other) {
-                delete[] m_data;
+                HugeArrayAllocator{}.deallocate(m_data, m_len);
                 m_len = other.m_len;
-                m_data = new int[m_len];
+                m_data = HugeArrayAllocator{}.allocate(m_len);
                 std::copy(other.m_data, other.m_data + m_len, m_data);
             }
             return *this;
@@ -136,7 +140,7 @@ namespace Exercises_MoveSemantics {
         HugeArray& HugeArray::operator= (HugeArray&& other) noexcept { // move-assignment
             std::cout << "MOVE assignment: " << other.m_len << " assigned" << std::endl;
             if (this != &other) {
-                delete[] m_data;         // release left side
+                HugeArrayAllocator{}.deallocate(m_data, m_len);  // release left side
                 m_data = other.m_data;   // shallow copy
                 m_len = other.m_len;
                 other.m_data = nullptr;  // reset source object, ownership has been moved
@@ -5,9 +5,12 @@
 module;
 
 #include "../ScopedTimer/ScopedTimer.h"
+#include "../Allocator/AlignedAllocator.h"
 
 module modern_cpp_exercises:expression_templates;
 
+import :blas;
+
 namespace Exercises_ExpressionTemplates {
 
     template <typename T>
@@ -20,6 +23,26 @@ namespace Exercises_ExpressionTemplates {
         return product;
     }
 
+    // aligned fast path: 'double' uses the BLAS kernels (aligned loads without peeling),
+    // other types tell the compiler about the alignment of the elements
+    template <typename T, size_t Alignment>
+    T scalarProduct(const Allocator::AlignedVector<T, Alignment>& a, const Allocator::AlignedVector<T, Alignment>& b)
+    {
+        if constexpr (std::is_same_v<T, double>) {
+            return Blas::dot(a, b);
+        }
+        else {
+            const T* x{ std::assume_aligned<Alignment>(a.data()) };
+            const T* y{ std::assume_aligned<Alignment>(b.data()) };
+
+            T product{};
+            for (size_t i{}; i != a.size(); ++i) {
+                product += x[i] * y[i];
+            }
+            return product;
+        }
+    }
+
     template <typename T>
     T scalarProductEx(typename std::vector<T>::iterator&& a, typename std::vector<T>::iterator&& end, typename std::vector<T>::iterator&& b)
     {
@@ -124,6 +147,243 @@ namespace Exercises_ExpressionTemplates {
             std::cout << "ScalarProduct<10, double>::result(a.cbegin(), a.cbegin()): " << prod << std::endl;
         }
     }
+
+    // =================================================================================
+    // BLAS level 1 kernels with runtime CPU feature dispatch
+
+    static void test_05()
+    {
+        std::vector<double> x{ 1, -2, 3, -4,  5, -6, 7, -8, 9 };
+        std::vector<double> y{ 6,  7, 8,  9, 10, 11, 12, 13, 14 };
+
+        std::cout << "Active instruction set: " << Blas::toString(Blas::activeKernels().m_isa) << std::endl;
+
+        std::cout << "dot(x, y)  = " << Blas::dot(x, y) << std::endl;    // 70
+        std::cout << "nrm2(x)    = " << Blas::nrm2(x) << std::endl;      // 16.8819
+        std::cout << "asum(x)    = " << Blas::asum(x) << std::endl;      // 45
+        std::cout << "iamax(x)   = " << Blas::iamax(x) << std::endl;     // 8
+
+        Blas::axpy(2.0, x, y);   // y = 2 * x + y
+        Blas::scal(0.5, y);      // y = 0.5 * y
+
+        for (double value : y) {
+            std::cout << value << ' ';   // 4 1.5 7 0.5 10 -0.5 13 -1.5 16
+        }
+        std::cout << std::endl;
+
+        // all supported instruction sets must agree
+        for (Blas::Isa isa : { Blas::Isa::Scalar, Blas::Isa::SSE2, Blas::Isa::AVX2, Blas::Isa::AVX512 }) {
+
+            if (!Blas::isSupported(isa)) {
+                std::cout << Blas::toString(isa) << ": not supported" << std::endl;
+                continue;
+            }
+
+            Blas::Kernels kernels{ Blas::kernelsFor(isa) };
+
+            std::cout << Blas::toString(isa) << ": "
+                << kernels.m_dot(x.size(), x.data(), x.data()) << ", "
+                << kernels.m_asum(x.size(), x.data()) << ", "
+                << kernels.m_amax(x.size(), x.data()) << std::endl;
+        }
+    }
+
+    template <typename TFunc>
+    static double nanosecondsPerCall(size_t iterations, TFunc&& func)
+    {
+        auto begin{ std::chrono::steady_clock::now() };
+
+        for (size_t n{}; n != iterations; ++n) {
+            func();
+        }
+
+        auto end{ std::chrono::steady_clock::now() };
+        return std::chrono::duration<double, std::nano>(end - begin).count() / iterations;
+    }
+
+    template <size_t N>
+    static void printBenchmarkRow(size_t totalElements)
+    {
+        std::vector<double> a(N);
+        std::iota(a.begin(), a.end(), 1.0);
+
+        size_t iterations{ std::max<size_t>(totalElements / N, 1) };
+
+        volatile double sink{};
+
+        std::cout << std::setw(10) << N;
+
+        std::cout << std::setw(14) << nanosecondsPerCall(iterations, [&]() {
+            sink = scalarProduct<double>(a, a);
+        });
+
+        std::cout << std::setw(14) << nanosecondsPerCall(iterations, [&]() {
+            sink = scalarProductEx<double>(a.begin(), a.end(), a.begin());
+        });
+
+        if constexpr (N <= 100) {
+            std::cout << std::setw(14) << nanosecondsPerCall(iterations, [&]() {
+                sink = ScalarProduct<N, double>::result(a.cbegin(), a.cbegin());
+            });
+        }
+        else {
+            std::cout << std::setw(14) << '-';
+        }
+
+        for (Blas::Isa isa : { Blas::Isa::Scalar, Blas::Isa::SSE2, Blas::Isa::AVX2, Blas::Isa::AVX512 }) {
+
+            if (!Blas::isSupported(isa)) {
+                std::cout << std::setw(14) << '-';
+                continue;
+            }
+
+            Blas::Kernels kernels{ Blas::kernelsFor(isa) };
+
+            std::cout << std::setw(14) << nanosecondsPerCall(iterations, [&]() {
+                sink = kernels.m_dot(a.size(), a.data(), a.data());
+            });
+        }
+
+        std::cout << std::endl;
+    }
+
+    static void test_06()
+    {
+        constexpr size_t TotalElements{ 200'000'000 };
+
+        std::cout << "Dot product - nanoseconds per call:" << std::endl;
+
+        std::cout << std::setw(10) << "Size"
+            << std::setw(14) << "scalarProduct"
+            << std::setw(14) << "Ex"
+            << std::setw(14) << "<N, T>"
+            << std::setw(14) << "Scalar"
+            << std::setw(14) << "SSE2"
+            << std::setw(14) << "AVX2+FMA"
+            << std::setw(14) << "AVX-512" << std::endl;
+
+        std::cout << std::fixed << std::setprecision(1);
+
+        printBenchmarkRow<10>(TotalElements);
+        printBenchmarkRow<100>(TotalElements);
+        printBenchmarkRow<10'000>(TotalElements);
+        printBenchmarkRow<1'000'000>(TotalElements);
+        printBenchmarkRow<10'000'000>(TotalElements);
+
+        std::cout << std::defaultfloat;
+    }
+
+    // =================================================================================
+    // aligned vs misaligned vectors: 'offset' elements after a 64-byte boundary
+
+    static void printAlignmentRow(std::string_view name, size_t size, size_t offsetX, size_t offsetY, size_t totalElements)
+    {
+        Allocator::AlignedVector<double> bufferX(size + 8, 1.0);
+        Allocator::AlignedVector<double> bufferY(size + 8, 2.0);
+
+        std::span<double> x{ bufferX.data() + offsetX, size };
+        std::span<double> y{ bufferY.data() + offsetY, size };
+
+        size_t iterations{ std::max<size_t>(totalElements / size, 1) };
+
+        volatile double sink{};
+
+        std::cout << std::setw(10) << size << std::setw(24) << name;
+
+        for (Blas::Isa isa : { Blas::Isa::SSE2, Blas::Isa::AVX2, Blas::Isa::AVX512 }) {
+
+            if (!Blas::isSupported(isa)) {
+                std::cout << std::setw(12) << '-' << std::setw(12) << '-';
+                continue;
+            }
+
+            Blas::Kernels kernels{ Blas::kernelsFor(isa) };
+
+            std::cout << std::setw(12) << nanosecondsPerCall(iterations, [&]() {
+                sink = kernels.m_dot(size, x.data(), y.data());
+            });
+
+            std::cout << std::setw(12) << nanosecondsPerCall(iterations, [&]() {
+                kernels.m_axpy(size, 1.0e-9, x.data(), y.data());
+            });
+        }
+
+        std::cout << std::endl;
+    }
+
+    static void test_07()
+    {
+        constexpr size_t TotalElements{ 100'000'000 };
+
+        Allocator::AlignedVector<double> a{ 1, 2, 3, 4, 5 };
+        Allocator::AlignedVector<double> b{ 6, 7, 8, 9, 10 };
+
+        std::cout << "scalarProduct<double>(a, b) = " << scalarProduct<double>(a, b) << std::endl;   // 130
+        std::cout << "a.data() is aligned to 64 bytes: " << std::boolalpha
+            << Allocator::isAligned(a.data(), 64) << std::noboolalpha << std::endl;
+
+        std::cout << "Aligned vs misaligned vectors - nanoseconds per call:" << std::endl;
+
+        std::cout << std::setw(10) << "Size" << std::setw(24) << "Offsets (elements)"
+            << std::setw(12) << "SSE2 dot" << std::setw(12) << "SSE2 axpy"
+            << std::setw(12) << "AVX2 dot" << std::setw(12) << "AVX2 axpy"
+            << std::setw(12) << "AVX512 dot" << std::setw(12) << "AVX512 axpy" << std::endl;
+
+        std::cout << std::fixed << std::setprecision(1);
+
+        for (size_t size : { 1'000, 100'000, 4'000'000 }) {
+            printAlignmentRow("0, 0 (aligned)", size, 0, 0, TotalElements);
+            printAlignmentRow("1, 1 (peeling)", size, 1, 1, TotalElements);
+            printAlignmentRow("1, 2 (unaligned)", size, 1, 2, TotalElements);
+        }
+
+        std::cout << std::defaultfloat;
+    }
+
+    // iamax with NaN: index of the first NaN - in the vectorized part and in the remainder
+    static void test_08()
+    {
+        constexpr double NaN{ std::numeric_limits<double>::quiet_NaN() };
+        constexpr double Inf{ std::numeric_limits<double>::infinity() };
+
+        std::vector<double> x(19);
+        std::iota(x.begin(), x.end(), 1.0);
+
+        std::vector<std::pair<std::vector<double>, size_t>> cases;
+
+        for (size_t pos : { 0, 5, 17 }) {
+            std::vector<double> y{ x };
+            y[pos] = NaN;
+            cases.push_back({ y, pos });
+        }
+
+        std::vector<double> y{ x };
+        y[3] = Inf;
+        y[10] = -NaN;
+        y[12] = NaN;
+        cases.push_back({ y, 10 });
+
+        for (Blas::Isa isa : { Blas::Isa::Scalar, Blas::Isa::SSE2, Blas::Isa::AVX2, Blas::Isa::AVX512 }) {
+
+            if (!Blas::isSupported(isa)) {
+                std::cout << Blas::toString(isa) << ": not supported" << std::endl;
+                continue;
+            }
+
+            Blas::Kernels kernels{ Blas::kernelsFor(isa) };
+
+            std::cout << Blas::toString(isa) << ":";
+
+            bool passed{ true };
+            for (const auto& [values, expected] : cases) {
+                size_t index{ Blas::iamax(kernels, values) };
+                std::cout << ' ' << index;
+                passed = passed && index == expected;
+            }
+
+            std::cout << " (expected 0 5 17 10) - " << (passed ? "passed" : "FAILED") << std::endl;
+        }
+    }
 }
 
 void test_exercices_expression_templates()
@@ -133,6 +393,10 @@ void test_exercices_expression_templates()
     //test_02();
     //test_03();
     test_04();
+    //test_05();
+    //test_06();
+    //test_07();
+    //test_08();
 }
 
 // =====================================================================================
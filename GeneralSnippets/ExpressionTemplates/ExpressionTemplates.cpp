@@ -8,12 +8,12 @@ module;
 
 module modern_cpp:expression_templates;
 
+import :matrix;
+
 namespace ExpressionTemplates {
 
     constexpr bool Verbose{ false };
 
-    using ElemType = double;                 // <== modify values here
-
     // default sizes
     constexpr size_t DefaultSize{ 5 };
 
@@ -24,98 +24,6 @@ namespace ExpressionTemplates {
     // actual sizes
     constexpr size_t Size{ DefaultSize };    // <== modify values here
 
-    template<size_t N, typename T = ElemType>
-    class Matrix 
-    {
-    private:
-        std::array<std::array<T, N>, N> m_values;
-
-    public:
-        // c'tor(s)
-        Matrix() : Matrix{ T{} } {}
-
-        Matrix(T preset) {
-            std::for_each(
-                m_values.begin(),
-                m_values.end(),
-                [=](auto& row) {
-                    row.fill(preset);
-                }
-            );
-        }
-
-        // getter
-        size_t inline getSize() const { return N; };
-
-        // functor - representing index operator
-        const T& operator()(size_t x, size_t y) const {
-            return m_values[x][y];
-        };
-
-        T& operator()(size_t x, size_t y) {
-            return m_values[x][y];
-        }
-
-        // operator+ --> classical implementation
-        Matrix<N> operator+(const Matrix<N>& other) const
-        {
-            Matrix<N> result;
-            for (size_t y{}; y != N; ++y) {
-                for (size_t x{}; x != N; ++x) {
-                    result.m_values[x][y] = m_values[x][y] + other.m_values[x][y];
-                }
-            }
-            return result;
-        }
-
-        // operator= --> expression template approach
-        template <typename TExpr>
-        Matrix<N>& operator=(const TExpr& expr)
-        {
-            for (size_t y{}; y != N; ++y) {
-                for (size_t x{}; x != N; ++x) {
-                    m_values[x][y] = expr(x, y);
-                }
-            }
-            return *this;
-        }
-
-        // just for demonstration purposes
-        static Matrix<N> add3(const Matrix<N>& a, const Matrix<N>& b, const Matrix<N>& c)
-        {
-            Matrix<N> result;
-
-            for (size_t y{}; y != a.getSize(); ++y) {
-                for (size_t x{}; x != a.getSize(); ++x) {
-                    result.m_values[x][y] = a.m_values[x][y] + b.m_values[x][y] + c.m_values[x][y];
-                }
-            }
-            return result;
-        }
-    };
-
-    // ========================================================================
-
-    template <typename TLhs, typename TRhs, typename T = ElemType>
-    class MatrixExpr
-    {
-    private:
-        const TLhs& m_lhs;
-        const TRhs& m_rhs;
-
-    public:
-        MatrixExpr(const TLhs& lhs, const TRhs& rhs) : m_rhs{ rhs }, m_lhs{ lhs } {}
-
-        T operator() (size_t x, size_t y) const {
-            return m_lhs(x, y) + m_rhs(x, y);
-        }
-    };
-
-    template <typename TLhs, typename TRhs>
-    MatrixExpr<TLhs, TRhs> operator+(const TLhs& lhs, const TRhs& rhs) {
-        return MatrixExpr<TLhs, TRhs>(lhs, rhs);
-    }
-
     // ========================================================================
 
     static void test_00()
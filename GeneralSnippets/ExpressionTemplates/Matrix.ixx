@@ -0,0 +1,364 @@
+// =====================================================================================
+// Matrix.ixx // Matrix and Expression Template Classes
+// =====================================================================================
+
+module;
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+export module modern_cpp:matrix;
+
+import std;
+
+namespace ExpressionTemplates {
+
+    using ElemType = double;                 // <== modify values here
+
+    // storage order of a matrix: element (x, y) is stored
+    // at m_values[x][y] (row-major) or at m_values[y][x] (column-major)
+    enum class MatrixLayout { RowMajor, ColumnMajor };
+
+    // ========================================================================
+    // transpose kernels: 'src' is a (row-major) 'rows' x 'cols' matrix,
+    // 'dst' receives the (row-major) 'cols' x 'rows' transposed matrix
+
+    template <typename T>
+    void transposeNaive(const T* src, T* dst, size_t rows, size_t cols)
+    {
+        for (size_t row{}; row != rows; ++row) {
+            for (size_t col{}; col != cols; ++col) {
+                dst[col * rows + row] = src[row * cols + col];
+            }
+        }
+    }
+
+    template <typename T>
+    void transposeBlocked(const T* src, T* dst, size_t rows, size_t cols, size_t blockSize = 32)
+    {
+        for (size_t rowBlock{}; rowBlock < rows; rowBlock += blockSize) {
+
+            size_t rowEnd{ std::min(rowBlock + blockSize, rows) };
+
+            for (size_t colBlock{}; colBlock < cols; colBlock += blockSize) {
+
+                size_t colEnd{ std::min(colBlock + blockSize, cols) };
+
+                for (size_t row{ rowBlock }; row != rowEnd; ++row) {
+                    for (size_t col{ colBlock }; col != colEnd; ++col) {
+                        dst[col * rows + row] = src[row * cols + col];
+                    }
+                }
+            }
+        }
+    }
+
+    // cache-oblivious: halve the larger dimension until the sub-matrix fits into a tile
+    template <typename T>
+    void transposeRecursive(
+        const T* src, T* dst, size_t rows, size_t cols,
+        size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd)
+    {
+        constexpr size_t TileSize{ 16 };
+
+        size_t numRows{ rowEnd - rowBegin };
+        size_t numCols{ colEnd - colBegin };
+
+        if (numRows <= TileSize && numCols <= TileSize) {
+            for (size_t row{ rowBegin }; row != rowEnd; ++row) {
+                for (size_t col{ colBegin }; col != colEnd; ++col) {
+                    dst[col * rows + row] = src[row * cols + col];
+                }
+            }
+        }
+        else if (numRows >= numCols) {
+            size_t rowMid{ rowBegin + numRows / 2 };
+            transposeRecursive(src, dst, rows, cols, rowBegin, rowMid, colBegin, colEnd);
+            transposeRecursive(src, dst, rows, cols, rowMid, rowEnd, colBegin, colEnd);
+        }
+        else {
+            size_t colMid{ colBegin + numCols / 2 };
+            transposeRecursive(src, dst, rows, cols, rowBegin, rowEnd, colBegin, colMid);
+            transposeRecursive(src, dst, rows, cols, rowBegin, rowEnd, colMid, colEnd);
+        }
+    }
+
+    template <typename T>
+    void transposeRecursive(const T* src, T* dst, size_t rows, size_t cols)
+    {
+        transposeRecursive(src, dst, rows, cols, 0, rows, 0, cols);
+    }
+
+    // blocked, each block is transposed in 4x4 tiles held in SSE registers (float only)
+    template <typename T>
+    void transposeBlockedSimd(const T* src, T* dst, size_t rows, size_t cols, size_t blockSize = 32)
+    {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+        if constexpr (std::is_same_v<T, float>) {
+
+            for (size_t rowBlock{}; rowBlock < rows; rowBlock += blockSize) {
+
+                size_t rowEnd{ std::min(rowBlock + blockSize, rows) };
+                size_t rowEnd4{ rowBlock + (rowEnd - rowBlock) / 4 * 4 };
+
+                for (size_t colBlock{}; colBlock < cols; colBlock += blockSize) {
+
+                    size_t colEnd{ std::min(colBlock + blockSize, cols) };
+                    size_t colEnd4{ colBlock + (colEnd - colBlock) / 4 * 4 };
+
+                    for (size_t row{ rowBlock }; row != rowEnd4; row += 4) {
+
+                        for (size_t col{ colBlock }; col != colEnd4; col += 4) {
+
+                            __m128 row0{ _mm_loadu_ps(&src[(row + 0) * cols + col]) };
+                            __m128 row1{ _mm_loadu_ps(&src[(row + 1) * cols + col]) };
+                            __m128 row2{ _mm_loadu_ps(&src[(row + 2) * cols + col]) };
+                            __m128 row3{ _mm_loadu_ps(&src[(row + 3) * cols + col]) };
+
+                            _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+                            _mm_storeu_ps(&dst[(col + 0) * rows + row], row0);
+                            _mm_storeu_ps(&dst[(col + 1) * rows + row], row1);
+                            _mm_storeu_ps(&dst[(col + 2) * rows + row], row2);
+                            _mm_storeu_ps(&dst[(col + 3) * rows + row], row3);
+                        }
+
+                        // remaining columns of these four rows
+                        for (size_t r{ row }; r != row + 4; ++r) {
+                            for (size_t col{ colEnd4 }; col != colEnd; ++col) {
+                                dst[col * rows + r] = src[r * cols + col];
+                            }
+                        }
+                    }
+
+                    // remaining rows of this block
+                    for (size_t row{ rowEnd4 }; row != rowEnd; ++row) {
+                        for (size_t col{ colBlock }; col != colEnd; ++col) {
+                            dst[col * rows + row] = src[row * cols + col];
+                        }
+                    }
+                }
+            }
+
+            return;
+        }
+#endif
+        transposeBlocked(src, dst, rows, cols, blockSize);
+    }
+
+    // ========================================================================
+
+    // storage order shared by all matrices of an expression,
+    // empty for mixed storage orders (specializations below)
+    template <typename TExpr>
+    constexpr std::optional<MatrixLayout> CommonLayout{};
+
+    // operands with run-time dimensions (e.g. a memory-mapped matrix) provide 'rows()' and 'cols()',
+    // matrices and expressions check themselves (resp. their operands)
+    template <typename TExpr>
+    bool hasDimensions(const TExpr& expr, size_t rows, size_t cols)
+    {
+        if constexpr (requires { expr.hasDimensions(rows, cols); }) {
+            return expr.hasDimensions(rows, cols);
+        }
+        else if constexpr (requires { expr.rows(); expr.cols(); }) {
+            return expr.rows() == rows && expr.cols() == cols;
+        }
+        else {
+            return true;
+        }
+    }
+
+    // the elements start at a cache line boundary: vectorized loops need no peeling,
+    // no SIMD load spans two cache lines. Since C++17 'new' (and 'std::make_unique')
+    // respect this alignment ('operator new(size_t, std::align_val_t)')
+    constexpr size_t MatrixAlignment{ 64 };
+
+    template<size_t N, typename T = ElemType, MatrixLayout L = MatrixLayout::RowMajor>
+    class Matrix 
+    {
+    private:
+        alignas(MatrixAlignment) std::array<std::array<T, N>, N> m_values;
+
+        static_assert(sizeof(std::array<std::array<T, N>, N>) == N * N * sizeof(T),
+            "Matrix elements are expected to be stored contiguously");
+
+    public:
+        // c'tor(s)
+        Matrix() : Matrix{ T{} } {}
+
+        Matrix(T preset) {
+            std::for_each(
+                m_values.begin(),
+                m_values.end(),
+                [=](auto& row) {
+                    row.fill(preset);
+                }
+            );
+        }
+
+        // getter
+        size_t inline getSize() const { return N; };
+
+        static constexpr MatrixLayout getLayout() { return L; }
+
+        static constexpr bool hasDimensions(size_t rows, size_t cols) { return rows == N && cols == N; }
+
+        // raw elements in storage order
+        const T* data() const { return std::assume_aligned<MatrixAlignment>(m_values[0].data()); }
+        T* data() { return std::assume_aligned<MatrixAlignment>(m_values[0].data()); }
+
+        // element in storage order
+        const T& element(size_t index) const { return data()[index]; }
+
+        // functor - representing index operator
+        const T& operator()(size_t x, size_t y) const {
+            if constexpr (L == MatrixLayout::RowMajor) {
+                return m_values[x][y];
+            }
+            else {
+                return m_values[y][x];
+            }
+        };
+
+        T& operator()(size_t x, size_t y) {
+            if constexpr (L == MatrixLayout::RowMajor) {
+                return m_values[x][y];
+            }
+            else {
+                return m_values[y][x];
+            }
+        }
+
+        // operator+ --> classical implementation
+        Matrix operator+(const Matrix& other) const
+        {
+            Matrix result;
+            for (size_t i{}; i != N; ++i) {
+                for (size_t j{}; j != N; ++j) {
+                    result.m_values[i][j] = m_values[i][j] + other.m_values[i][j];
+                }
+            }
+            return result;
+        }
+
+        // operator= --> expression template approach,
+        // expression is evaluated in the storage order of the destination
+        template <typename TExpr>
+        Matrix& operator=(const TExpr& expr)
+        {
+            if (!ExpressionTemplates::hasDimensions(expr, N, N)) {
+                throw std::length_error{ "Dimensions of matrix expression don't match" };
+            }
+
+            // all operands share the storage order: a single loop over aligned, contiguous elements
+            if constexpr (CommonLayout<TExpr> == L) {
+                T* values{ data() };
+                for (size_t index{}; index != N * N; ++index) {
+                    values[index] = expr.element(index);
+                }
+                return *this;
+            }
+
+            for (size_t i{}; i != N; ++i) {
+                for (size_t j{}; j != N; ++j) {
+                    if constexpr (L == MatrixLayout::RowMajor) {
+                        m_values[i][j] = expr(i, j);
+                    }
+                    else {
+                        m_values[i][j] = expr(j, i);
+                    }
+                }
+            }
+            return *this;
+        }
+
+        // transposed matrix, same storage layout
+        Matrix transposed() const
+        {
+            Matrix result;
+            transposeRecursive(data(), result.data(), N, N);
+            return result;
+        }
+
+        // same matrix in another storage layout
+        template <MatrixLayout Other>
+        Matrix<N, T, Other> convert() const
+        {
+            if constexpr (Other == L) {
+                return *this;
+            }
+            else {
+                Matrix<N, T, Other> result;
+                transposeRecursive(data(), result.data(), N, N);
+                return result;
+            }
+        }
+
+        // just for demonstration purposes
+        static Matrix add3(const Matrix& a, const Matrix& b, const Matrix& c)
+        {
+            Matrix result;
+
+            for (size_t i{}; i != a.getSize(); ++i) {
+                for (size_t j{}; j != a.getSize(); ++j) {
+                    result.m_values[i][j] = a.m_values[i][j] + b.m_values[i][j] + c.m_values[i][j];
+                }
+            }
+            return result;
+        }
+    };
+
+    // ========================================================================
+
+    template <typename TLhs, typename TRhs, typename T = ElemType>
+    class MatrixExpr
+    {
+    private:
+        const TLhs& m_lhs;
+        const TRhs& m_rhs;
+
+    public:
+        MatrixExpr(const TLhs& lhs, const TRhs& rhs) : m_rhs{ rhs }, m_lhs{ lhs } {}
+
+        T operator() (size_t x, size_t y) const {
+            return m_lhs(x, y) + m_rhs(x, y);
+        }
+
+        bool hasDimensions(size_t rows, size_t cols) const {
+            return ExpressionTemplates::hasDimensions(m_lhs, rows, cols)
+                && ExpressionTemplates::hasDimensions(m_rhs, rows, cols);
+        }
+
+        // element in storage order, all operands must have the same storage order
+        T element(size_t index) const {
+            return m_lhs.element(index) + m_rhs.element(index);
+        }
+    };
+
+    template <size_t N, typename T, MatrixLayout L>
+    constexpr std::optional<MatrixLayout> CommonLayout<Matrix<N, T, L>>{ L };
+
+    template <typename TLhs, typename TRhs, typename T>
+    constexpr std::optional<MatrixLayout> CommonLayout<MatrixExpr<TLhs, TRhs, T>>{
+        CommonLayout<TLhs> == CommonLayout<TRhs> ? CommonLayout<TLhs> : std::nullopt
+    };
+
+    // any operand providing element access via functor 'operator()(x, y)'
+    template <typename T>
+    concept MatrixOperand = requires (const T& m, size_t x, size_t y)
+    {
+        m(x, y);
+    };
+
+    template <typename TLhs, typename TRhs>
+        requires MatrixOperand<TLhs> && MatrixOperand<TRhs>
+    MatrixExpr<TLhs, TRhs> operator+(const TLhs& lhs, const TRhs& rhs) {
+        return MatrixExpr<TLhs, TRhs>(lhs, rhs);
+    }
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
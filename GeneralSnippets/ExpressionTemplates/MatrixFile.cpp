@@ -0,0 +1,402 @@
+// =====================================================================================
+// MatrixFile.cpp // Binary Matrix Files and Memory-Mapped Matrices
+// =====================================================================================
+
+module;
+
+#include "../ScopedTimer/ScopedTimer.h"
+
+#include <cassert>
+
+module modern_cpp:expression_templates;
+
+import :matrix;
+import :mapped_file;
+
+namespace ExpressionTemplates {
+
+    // =================================================================================
+    // file format (version 1, native byte order):
+    //
+    //   header (48 bytes) | padding up to 'm_dataOffset' | rows * cols elements
+    //
+    // the elements start at a multiple of 'm_alignment' bytes
+
+    enum class ElementType : std::uint32_t { Float32 = 1, Float64 = 2, Int32 = 3, Int64 = 4 };
+
+    template <typename T>
+    constexpr ElementType elementTypeOf()
+    {
+        if constexpr (std::is_same_v<T, float>) { return ElementType::Float32; }
+        else if constexpr (std::is_same_v<T, double>) { return ElementType::Float64; }
+        else if constexpr (std::is_same_v<T, std::int32_t>) { return ElementType::Int32; }
+        else if constexpr (std::is_same_v<T, std::int64_t>) { return ElementType::Int64; }
+        else { static_assert(sizeof(T) == 0, "Unsupported element type"); }
+    }
+
+    struct MatrixFileHeader
+    {
+        std::array<char, 4> m_magic;
+        std::uint32_t       m_version;
+        ElementType         m_elemType;
+        MatrixLayout        m_layout;
+        std::uint64_t       m_rows;
+        std::uint64_t       m_cols;
+        std::uint64_t       m_dataOffset;
+        std::uint64_t       m_alignment;
+    };
+
+    static_assert(std::is_trivially_copyable_v<MatrixFileHeader>);
+    static_assert(sizeof(MatrixFileHeader) == 48);
+
+    constexpr std::array<char, 4> MatrixFileMagic{ 'M', 'T', 'R', 'X' };
+    constexpr std::uint32_t MatrixFileVersion{ 1 };
+    constexpr std::uint64_t MatrixFileAlignment{ 64 };   // cache line
+
+    // =================================================================================
+
+    template <typename T>
+    class MatrixFileWriter
+    {
+    private:
+        std::ofstream m_file;
+        std::uint64_t m_expected;
+        std::uint64_t m_written;
+
+    public:
+        // c'tor writes the header, elements are appended afterwards in storage order
+        MatrixFileWriter(const std::filesystem::path& path, size_t rows, size_t cols,
+            MatrixLayout layout = MatrixLayout::RowMajor)
+            : m_file{ path, std::ios::binary | std::ios::trunc }, m_expected{ rows * cols }, m_written{}
+        {
+            if (!m_file) {
+                throw std::runtime_error{ "Cannot create matrix file " + path.string() };
+            }
+
+            MatrixFileHeader header{
+                .m_magic{ MatrixFileMagic },
+                .m_version{ MatrixFileVersion },
+                .m_elemType{ elementTypeOf<T>() },
+                .m_layout{ layout },
+                .m_rows{ rows },
+                .m_cols{ cols },
+                .m_dataOffset{ (sizeof(MatrixFileHeader) + MatrixFileAlignment - 1) / MatrixFileAlignment * MatrixFileAlignment },
+                .m_alignment{ MatrixFileAlignment }
+            };
+
+            std::array<char, MatrixFileAlignment> padding{};
+
+            m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            m_file.write(padding.data(), header.m_dataOffset - sizeof(header));
+        }
+
+        ~MatrixFileWriter() = default;
+
+        // no copying
+        MatrixFileWriter(const MatrixFileWriter&) = delete;
+        MatrixFileWriter& operator=(const MatrixFileWriter&) = delete;
+
+        // streaming interface: any number of elements, e.g. row by row
+        void write(std::span<const T> elements)
+        {
+            if (m_written + elements.size() > m_expected) {
+                throw std::length_error{ "Too many elements written to matrix file" };
+            }
+
+            m_file.write(reinterpret_cast<const char*>(elements.data()), elements.size_bytes());
+            m_written += elements.size();
+        }
+
+        void close()
+        {
+            if (m_written != m_expected) {
+                throw std::length_error{ "Matrix file is incomplete" };
+            }
+
+            m_file.close();
+            if (!m_file) {
+                throw std::runtime_error{ "Error writing matrix file" };
+            }
+        }
+    };
+
+    template <size_t N, typename T, MatrixLayout L>
+    void saveMatrix(const std::filesystem::path& path, const Matrix<N, T, L>& matrix)
+    {
+        MatrixFileWriter<T> writer{ path, N, N, L };
+        writer.write(std::span<const T>{ matrix.data(), N * N });
+        writer.close();
+    }
+
+    // =================================================================================
+
+    // zero-copy view onto a matrix file, usable as operand of a 'MatrixExpr':
+    // the dimensions are checked when the expression is assigned to a 'Matrix'
+    template <typename T = ElemType>
+    class MappedMatrix
+    {
+    private:
+        MappedFile   m_file;
+        const T*     m_values;
+        size_t       m_rows;
+        size_t       m_cols;
+        MatrixLayout m_layout;
+
+    public:
+        explicit MappedMatrix(const std::filesystem::path& path)
+            : m_file{ path }, m_values{}, m_rows{}, m_cols{}, m_layout{}
+        {
+            if (m_file.size() < sizeof(MatrixFileHeader)) {
+                throw std::runtime_error{ "Not a matrix file: " + path.string() };
+            }
+
+            MatrixFileHeader header{};
+            std::memcpy(&header, m_file.data(), sizeof(header));
+
+            if (header.m_magic != MatrixFileMagic || header.m_version != MatrixFileVersion) {
+                throw std::runtime_error{ "Not a matrix file (or unsupported version): " + path.string() };
+            }
+
+            if (header.m_elemType != elementTypeOf<T>()) {
+                throw std::runtime_error{ "Element type of matrix file doesn't match" };
+            }
+
+            if (header.m_layout != MatrixLayout::RowMajor && header.m_layout != MatrixLayout::ColumnMajor) {
+                throw std::runtime_error{ "Matrix file is corrupt (unknown layout): " + path.string() };
+            }
+
+            // overflow-safe: rows * cols * sizeof(T) <= size - offset, without computing the product
+            const std::uint64_t size{ m_file.size() };
+
+            auto fits = [&](std::uint64_t offset, std::uint64_t rows, std::uint64_t cols) {
+                if (offset % alignof(T) != 0 || offset < sizeof(MatrixFileHeader) || offset > size) {
+                    return false;
+                }
+                const std::uint64_t maxElements{ (size - offset) / sizeof(T) };
+                return cols == 0 || rows <= maxElements / cols;
+            };
+
+            if (!fits(header.m_dataOffset, header.m_rows, header.m_cols)) {
+                throw std::runtime_error{ "Matrix file is corrupt: " + path.string() };
+            }
+
+            m_values = reinterpret_cast<const T*>(m_file.data() + header.m_dataOffset);
+            m_rows = static_cast<size_t>(header.m_rows);
+            m_cols = static_cast<size_t>(header.m_cols);
+            m_layout = header.m_layout;
+        }
+
+        // getter
+        size_t rows() const { return m_rows; }
+        size_t cols() const { return m_cols; }
+        MatrixLayout layout() const { return m_layout; }
+
+        // raw elements in storage order
+        std::span<const T> data() const { return { m_values, m_rows * m_cols }; }
+
+        // functor - representing index operator
+        T operator()(size_t x, size_t y) const {
+            assert(x < m_rows && y < m_cols);
+            return (m_layout == MatrixLayout::RowMajor) ? m_values[x * m_cols + y] : m_values[y * m_rows + x];
+        }
+    };
+
+    // =================================================================================
+
+    static std::filesystem::path tempMatrixFile(std::string_view name)
+    {
+        return std::filesystem::temp_directory_path() / name;
+    }
+
+    static void test_matrix_file_01()
+    {
+        std::cout << "Matrix File 01: Save and Map a Matrix" << std::endl;
+
+        constexpr size_t Dim{ 4 };
+
+        Matrix<Dim, ElemType, MatrixLayout::ColumnMajor> matrix{};
+        for (size_t x{}; x != Dim; ++x) {
+            for (size_t y{}; y != Dim; ++y) {
+                matrix(x, y) = static_cast<ElemType>(x * Dim + y);
+            }
+        }
+
+        auto path{ tempMatrixFile("matrix_01.mtrx") };
+        saveMatrix(path, matrix);
+
+        std::cout << "File size: " << std::filesystem::file_size(path) << " bytes" << std::endl;   // 64 + 128
+
+        {
+            MappedMatrix<> mapped{ path };
+
+            // mapped matrix as operand of an expression
+            Matrix<Dim> ones{ 1.0 };
+            Matrix<Dim> result{};
+            result = ones + mapped;
+
+            for (size_t x{}; x != Dim; ++x) {
+                for (size_t y{}; y != Dim; ++y) {
+                    std::cout << std::setw(4) << result(x, y);
+                }
+                std::cout << std::endl;
+            }
+        }
+
+        std::filesystem::remove(path);
+    }
+
+    static void test_matrix_file_02()
+    {
+        std::cout << "Matrix File 02: Errors" << std::endl;
+
+        auto path{ tempMatrixFile("matrix_02.mtrx") };
+
+        try {
+            MatrixFileWriter<float> writer{ path, 2, 2 };
+            std::array<float, 3> elements{ 1.0f, 2.0f, 3.0f };
+            writer.write(elements);
+            writer.close();
+        }
+        catch (const std::exception& ex) {
+            std::cout << "Exception: " << ex.what() << std::endl;
+        }
+
+        try {
+            MappedMatrix<double> mapped{ path };
+        }
+        catch (const std::exception& ex) {
+            std::cout << "Exception: " << ex.what() << std::endl;
+        }
+
+        // corrupt header: 2^62 * 4 * sizeof(double) wraps around to 0
+        saveMatrix(path, Matrix<2>{ 1.0 });
+
+        {
+            std::fstream file{ path, std::ios::binary | std::ios::in | std::ios::out };
+
+            MatrixFileHeader header{};
+            file.read(reinterpret_cast<char*>(&header), sizeof(header));
+            header.m_rows = std::uint64_t{ 1 } << 62;
+            header.m_cols = 4;
+
+            file.seekp(0);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+        try {
+            MappedMatrix<double> mapped{ path };
+        }
+        catch (const std::exception& ex) {
+            std::cout << "Exception: " << ex.what() << std::endl;
+        }
+
+        // 4 x 4 matrix file as operand of a 2 x 2 expression
+        saveMatrix(path, Matrix<4>{ 1.0 });
+
+        try {
+            MappedMatrix<double> mapped{ path };
+            Matrix<2> ones{ 1.0 };
+            Matrix<2> result{};
+            result = ones + mapped;
+        }
+        catch (const std::exception& ex) {
+            std::cout << "Exception: " << ex.what() << std::endl;
+        }
+
+        std::filesystem::remove(path);
+    }
+
+    // =================================================================================
+
+    constexpr size_t MatrixFileBenchmarkDim{ 2048 };
+
+    static void test_matrix_file_03_benchmark()
+    {
+        std::cout << "Matrix File 03: Benchmark Text Stream versus Memory Mapping" << std::endl;
+
+        constexpr size_t Dim{ MatrixFileBenchmarkDim };
+
+        auto binaryPath{ tempMatrixFile("matrix_03.mtrx") };
+        auto textPath{ tempMatrixFile("matrix_03.txt") };
+
+        {
+            std::cout << "Writing binary file (streaming, row by row): ";
+            ScopedTimer watch{};
+
+            MatrixFileWriter<double> writer{ binaryPath, Dim, Dim };
+            std::vector<double> row(Dim);
+
+            for (size_t x{}; x != Dim; ++x) {
+                std::iota(row.begin(), row.end(), static_cast<double>(x * Dim));
+                writer.write(row);
+            }
+
+            writer.close();
+        }
+
+        {
+            std::cout << "Writing text file:                           ";
+            ScopedTimer watch{};
+
+            std::ofstream file{ textPath };
+            file << std::setprecision(std::numeric_limits<double>::max_digits10);
+            file << Dim << ' ' << Dim << '\n';
+
+            for (size_t i{}; i != Dim * Dim; ++i) {
+                file << static_cast<double>(i) << '\n';
+            }
+        }
+
+        double expected{ (Dim * Dim - 1.0) * (Dim * Dim) / 2.0 };
+
+        {
+            std::cout << "Loading text file:                           ";
+            ScopedTimer watch{};
+
+            std::ifstream file{ textPath };
+            size_t rows{}, cols{};
+            file >> rows >> cols;
+
+            std::vector<double> values(rows * cols);
+            for (auto& value : values) {
+                file >> value;
+            }
+
+            double sum{ std::accumulate(values.begin(), values.end(), 0.0) };
+            std::cout << (sum == expected ? "" : "[wrong sum] ");
+        }
+
+        {
+            std::cout << "Mapping binary file (no page touched):       ";
+            ScopedTimer watch{};
+
+            MappedMatrix<double> mapped{ binaryPath };
+        }
+
+        {
+            std::cout << "Mapping binary file and touching all pages:  ";
+            ScopedTimer watch{};
+
+            MappedMatrix<double> mapped{ binaryPath };
+            auto values{ mapped.data() };
+
+            double sum{ std::accumulate(values.begin(), values.end(), 0.0) };
+            std::cout << (sum == expected ? "" : "[wrong sum] ");
+        }
+
+        std::filesystem::remove(binaryPath);
+        std::filesystem::remove(textPath);
+    }
+}
+
+void main_expression_templates_matrix_file()
+{
+    using namespace ExpressionTemplates;
+    test_matrix_file_01();
+    test_matrix_file_02();
+    test_matrix_file_03_benchmark();
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
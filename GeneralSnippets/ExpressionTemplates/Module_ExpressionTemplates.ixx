@@ -7,6 +7,9 @@ export module modern_cpp:expression_templates;
 import std;
 
 export void main_expression_templates();
+export void main_expression_templates_sparse();
+export void main_expression_templates_transpose();
+export void main_expression_templates_matrix_file();
 
 // =====================================================================================
 // End-of-File
@@ -0,0 +1,523 @@
+// =====================================================================================
+// SparseMatrix.cpp // Sparse Matrices (CSR / CSC) and Expression Templates
+// =====================================================================================
+
+module;
+
+#include "../ScopedTimer/ScopedTimer.h"
+
+module modern_cpp:expression_templates;
+
+import :matrix;
+
+namespace ExpressionTemplates {
+
+    // single entry in coordinate (COO) format
+    template <typename T = ElemType>
+    struct Triplet
+    {
+        size_t m_row;
+        size_t m_col;
+        T      m_value;
+    };
+
+    // compressed sparse row (CSR) or compressed sparse column (CSC) storage
+    template <MatrixLayout Layout, typename T = ElemType>
+    class SparseMatrix
+    {
+    private:
+        size_t              m_rows;
+        size_t              m_cols;
+        std::vector<size_t> m_offsets;   // major dimension + 1 entries
+        std::vector<size_t> m_indices;   // minor index of each non-zero element
+        std::vector<T>      m_values;    // non-zero elements
+
+    public:
+        // c'tor(s)
+        SparseMatrix() : SparseMatrix{ 0, 0 } {}
+
+        SparseMatrix(size_t rows, size_t cols)
+            : m_rows{ rows }, m_cols{ cols }, m_offsets(majorSize() + 1)
+        {}
+
+        // building from COO triplets - duplicate entries are summed up
+        static SparseMatrix fromTriplets(size_t rows, size_t cols, std::vector<Triplet<T>> triplets)
+        {
+            SparseMatrix result{ rows, cols };
+
+            for (const auto& triplet : triplets) {
+                if (triplet.m_row >= rows || triplet.m_col >= cols) {
+                    throw std::out_of_range{ "Triplet outside of matrix dimensions" };
+                }
+            }
+
+            std::sort(
+                triplets.begin(),
+                triplets.end(),
+                [&](const Triplet<T>& lhs, const Triplet<T>& rhs) {
+                    return std::pair{ result.majorOf(lhs), result.minorOf(lhs) } <
+                        std::pair{ result.majorOf(rhs), result.minorOf(rhs) };
+                }
+            );
+
+            result.m_indices.reserve(triplets.size());
+            result.m_values.reserve(triplets.size());
+
+            size_t lastMajor{ std::numeric_limits<size_t>::max() };
+
+            for (const auto& triplet : triplets) {
+
+                size_t major{ result.majorOf(triplet) };
+                size_t minor{ result.minorOf(triplet) };
+
+                if (major == lastMajor && result.m_indices.back() == minor) {
+                    result.m_values.back() += triplet.m_value;
+                }
+                else {
+                    result.m_indices.push_back(minor);
+                    result.m_values.push_back(triplet.m_value);
+                    ++result.m_offsets[major + 1];
+                    lastMajor = major;
+                }
+            }
+
+            std::partial_sum(result.m_offsets.begin(), result.m_offsets.end(), result.m_offsets.begin());
+            return result;
+        }
+
+        // getter
+        size_t rows() const { return m_rows; }
+        size_t cols() const { return m_cols; }
+        size_t nonZeros() const { return m_values.size(); }
+
+        double density() const {
+            return (m_rows == 0 || m_cols == 0) ? 0.0 :
+                static_cast<double>(nonZeros()) / (static_cast<double>(m_rows) * m_cols);
+        }
+
+        // functor - random access, makes a sparse operand usable in 'MatrixExpr'
+        T operator()(size_t x, size_t y) const
+        {
+            size_t major{ (Layout == MatrixLayout::RowMajor) ? x : y };
+            size_t minor{ (Layout == MatrixLayout::RowMajor) ? y : x };
+
+            auto first{ m_indices.begin() + m_offsets[major] };
+            auto last{ m_indices.begin() + m_offsets[major + 1] };
+            auto pos{ std::lower_bound(first, last, minor) };
+
+            return (pos != last && *pos == minor) ? m_values[pos - m_indices.begin()] : T{};
+        }
+
+        std::vector<Triplet<T>> toTriplets() const
+        {
+            std::vector<Triplet<T>> triplets;
+            triplets.reserve(nonZeros());
+
+            forEachNonZero([&](size_t row, size_t col, T value) {
+                triplets.push_back({ row, col, value });
+            });
+
+            return triplets;
+        }
+
+        // conversion CSR <=> CSC
+        template <MatrixLayout Other>
+        SparseMatrix<Other, T> convert() const
+        {
+            return SparseMatrix<Other, T>::fromTriplets(m_rows, m_cols, toTriplets());
+        }
+
+        // sparse * dense vector: y = A * x
+        void multiply(std::span<const T> x, std::span<T> y) const
+        {
+            checkVectorSizes(x, y);
+
+            if constexpr (Layout == MatrixLayout::RowMajor) {
+                multiplyRows(x, y, 0, m_rows);
+            }
+            else {
+                // CSC: scatter each column into the result
+                std::fill(y.begin(), y.end(), T{});
+
+                for (size_t col{}; col != m_cols; ++col) {
+                    T factor{ x[col] };
+                    for (size_t k{ m_offsets[col] }; k != m_offsets[col + 1]; ++k) {
+                        y[m_indices[k]] += m_values[k] * factor;
+                    }
+                }
+            }
+        }
+
+        // multithreaded sparse * dense vector over precomputed row partitions (see 'partitionRows'):
+        // the partitions run on the thread pool of the parallel algorithms, no threads are created per call
+        void multiplyParallel(std::span<const T> x, std::span<T> y, std::span<const size_t> bounds) const
+            requires (Layout == MatrixLayout::RowMajor)
+        {
+            checkVectorSizes(x, y);
+
+            if (bounds.size() < 2 || bounds.front() != 0 || bounds.back() != m_rows || !std::is_sorted(bounds.begin(), bounds.end())) {
+                throw std::invalid_argument{ "Row partitions don't cover the matrix" };
+            }
+
+            // partition n consists of the rows [bounds[n], bounds[n + 1])
+            std::for_each(
+                std::execution::par,
+                bounds.begin(),
+                bounds.end() - 1,
+                [&](const size_t& firstRow) {
+                    multiplyRows(x, y, firstRow, *(&firstRow + 1));
+                }
+            );
+        }
+
+        // rows are partitioned by non-zero count on each call
+        void multiplyParallel(std::span<const T> x, std::span<T> y, size_t numThreads) const
+            requires (Layout == MatrixLayout::RowMajor)
+        {
+            multiplyParallel(x, y, partitionRows(std::max<size_t>(numThreads, 1)));
+        }
+
+        // row boundaries of 'parts' partitions with (roughly) equal number of non-zeros
+        std::vector<size_t> partitionRows(size_t parts) const
+            requires (Layout == MatrixLayout::RowMajor)
+        {
+            std::vector<size_t> bounds(parts + 1);
+            bounds[parts] = m_rows;
+
+            for (size_t k{ 1 }; k != parts; ++k) {
+
+                size_t target{ nonZeros() * k / parts };
+                auto pos{ std::lower_bound(m_offsets.begin(), m_offsets.end(), target) };
+                size_t row{ static_cast<size_t>(std::distance(m_offsets.begin(), pos)) };
+
+                bounds[k] = std::clamp(row, bounds[k - 1], m_rows);
+            }
+
+            return bounds;
+        }
+
+        // sparse + sparse: merging the compressed vectors of both operands
+        friend SparseMatrix operator+(const SparseMatrix& lhs, const SparseMatrix& rhs)
+        {
+            if (lhs.m_rows != rhs.m_rows || lhs.m_cols != rhs.m_cols) {
+                throw std::invalid_argument{ "Sparse matrices of different dimensions" };
+            }
+
+            SparseMatrix result{ lhs.m_rows, lhs.m_cols };
+            result.m_indices.reserve(lhs.nonZeros() + rhs.nonZeros());
+            result.m_values.reserve(lhs.nonZeros() + rhs.nonZeros());
+
+            for (size_t major{}; major != lhs.majorSize(); ++major) {
+
+                size_t i{ lhs.m_offsets[major] };
+                size_t j{ rhs.m_offsets[major] };
+                size_t iEnd{ lhs.m_offsets[major + 1] };
+                size_t jEnd{ rhs.m_offsets[major + 1] };
+
+                while (i != iEnd || j != jEnd) {
+
+                    if (j == jEnd || (i != iEnd && lhs.m_indices[i] < rhs.m_indices[j])) {
+                        result.append(lhs.m_indices[i], lhs.m_values[i]);
+                        ++i;
+                    }
+                    else if (i == iEnd || rhs.m_indices[j] < lhs.m_indices[i]) {
+                        result.append(rhs.m_indices[j], rhs.m_values[j]);
+                        ++j;
+                    }
+                    else {
+                        T sum{ lhs.m_values[i] + rhs.m_values[j] };
+                        if (sum != T{}) {
+                            result.append(lhs.m_indices[i], sum);
+                        }
+                        ++i;
+                        ++j;
+                    }
+                }
+
+                result.m_offsets[major + 1] = result.m_values.size();
+            }
+
+            return result;
+        }
+
+        friend std::vector<T> operator*(const SparseMatrix& matrix, const std::vector<T>& x)
+        {
+            std::vector<T> y(matrix.m_rows);
+            matrix.multiply(x, y);
+            return y;
+        }
+
+    private:
+        size_t majorSize() const {
+            return (Layout == MatrixLayout::RowMajor) ? m_rows : m_cols;
+        }
+
+        size_t majorOf(const Triplet<T>& triplet) const {
+            return (Layout == MatrixLayout::RowMajor) ? triplet.m_row : triplet.m_col;
+        }
+
+        size_t minorOf(const Triplet<T>& triplet) const {
+            return (Layout == MatrixLayout::RowMajor) ? triplet.m_col : triplet.m_row;
+        }
+
+        void append(size_t minor, T value) {
+            m_indices.push_back(minor);
+            m_values.push_back(value);
+        }
+
+        template <typename TFunc>
+        void forEachNonZero(TFunc&& func) const
+        {
+            for (size_t major{}; major != majorSize(); ++major) {
+                for (size_t k{ m_offsets[major] }; k != m_offsets[major + 1]; ++k) {
+                    if constexpr (Layout == MatrixLayout::RowMajor) {
+                        func(major, m_indices[k], m_values[k]);
+                    }
+                    else {
+                        func(m_indices[k], major, m_values[k]);
+                    }
+                }
+            }
+        }
+
+        void checkVectorSizes(std::span<const T> x, std::span<T> y) const
+        {
+            if (x.size() != m_cols || y.size() != m_rows) {
+                throw std::invalid_argument{ "Vector size doesn't match matrix dimensions" };
+            }
+        }
+
+        void multiplyRows(std::span<const T> x, std::span<T> y, size_t firstRow, size_t lastRow) const
+        {
+            for (size_t row{ firstRow }; row != lastRow; ++row) {
+
+                T sum{};
+                for (size_t k{ m_offsets[row] }; k != m_offsets[row + 1]; ++k) {
+                    sum += m_values[k] * x[m_indices[k]];
+                }
+                y[row] = sum;
+            }
+        }
+    };
+
+    template <typename T = ElemType>
+    using CsrMatrix = SparseMatrix<MatrixLayout::RowMajor, T>;
+
+    template <typename T = ElemType>
+    using CscMatrix = SparseMatrix<MatrixLayout::ColumnMajor, T>;
+
+    // =================================================================================
+
+    // random sparse matrix with given density, values in range [1.0, 2.0)
+    static std::vector<Triplet<>> randomTriplets(size_t rows, size_t cols, double density)
+    {
+        std::mt19937 generator{ 42 };
+        std::uniform_real_distribution<double> distribution{ 0.0, 1.0 };
+
+        std::vector<Triplet<>> triplets;
+        triplets.reserve(static_cast<size_t>(rows * cols * density * 1.1));
+
+        for (size_t row{}; row != rows; ++row) {
+            for (size_t col{}; col != cols; ++col) {
+                if (distribution(generator) < density) {
+                    triplets.push_back({ row, col, 1.0 + distribution(generator) });
+                }
+            }
+        }
+
+        return triplets;
+    }
+
+    static void test_sparse_01()
+    {
+        std::cout << "Sparse Matrices 01: Building from COO Triplets" << std::endl;
+
+        // 1 0 0 2
+        // 0 3 0 0
+        // 0 0 0 0
+        // 4 0 5 6
+        std::vector<Triplet<>> triplets{
+            { 3, 3, 6.0 }, { 0, 0, 1.0 }, { 1, 1, 3.0 }, { 0, 3, 2.0 },
+            { 3, 0, 4.0 }, { 3, 2, 2.5 }, { 3, 2, 2.5 }   // duplicates are summed up
+        };
+
+        CsrMatrix<> csr{ CsrMatrix<>::fromTriplets(4, 4, triplets) };
+        CscMatrix<> csc{ CscMatrix<>::fromTriplets(4, 4, triplets) };
+
+        for (size_t x{}; x != csr.rows(); ++x) {
+            for (size_t y{}; y != csr.cols(); ++y) {
+                std::cout << csr(x, y) << ' ';
+            }
+            std::cout << std::endl;
+        }
+
+        std::cout << "Non-Zeros: " << csr.nonZeros() << ", Density: " << csr.density() << std::endl;
+
+        std::vector<double> v{ 1.0, 2.0, 3.0, 4.0 };
+        std::vector<double> y1{ csr * v };
+        std::vector<double> y2{ csc * v };
+
+        std::vector<double> y3(csr.rows());
+        csr.multiplyParallel(v, y3, 2);
+
+        for (size_t i{}; i != y1.size(); ++i) {
+            std::cout << y1[i] << " - " << y2[i] << " - " << y3[i] << std::endl;   // 9, 6, 0, 43
+        }
+    }
+
+    static void test_sparse_02()
+    {
+        std::cout << "Sparse Matrices 02: Sparse + Sparse, CSR <=> CSC" << std::endl;
+
+        CsrMatrix<> a{ CsrMatrix<>::fromTriplets(3, 3, { { 0, 0, 1.0 }, { 1, 2, 2.0 }, { 2, 1, 3.0 } }) };
+        CsrMatrix<> b{ CsrMatrix<>::fromTriplets(3, 3, { { 0, 0, -1.0 }, { 1, 1, 4.0 }, { 2, 1, 5.0 } }) };
+
+        CsrMatrix<> sum{ a + b };   // entry (0, 0) cancels out
+        std::cout << "Non-Zeros of a + b: " << sum.nonZeros() << std::endl;   // 3
+
+        CscMatrix<> csc{ sum.convert<MatrixLayout::ColumnMajor>() };
+
+        for (size_t x{}; x != csc.rows(); ++x) {
+            for (size_t y{}; y != csc.cols(); ++y) {
+                std::cout << csc(x, y) << ' ';
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    static void test_sparse_03()
+    {
+        std::cout << "Sparse Matrices 03: Sparse Operands in Expression Templates" << std::endl;
+
+        constexpr size_t Dim{ 4 };
+
+        Matrix<Dim> a{ 1.0 }, b{ 2.0 };
+        Matrix<Dim> result{};
+
+        CsrMatrix<> identity{
+            CsrMatrix<>::fromTriplets(Dim, Dim, { { 0, 0, 1.0 }, { 1, 1, 1.0 }, { 2, 2, 1.0 }, { 3, 3, 1.0 } })
+        };
+
+        // dense + dense + sparse - evaluated element-wise without temporaries
+        MatrixExpr sumAB{ a, b };
+        MatrixExpr sumABI{ sumAB, identity };
+        result = sumABI;
+
+        for (size_t x{}; x != Dim; ++x) {
+            for (size_t y{}; y != Dim; ++y) {
+                std::cout << result(x, y) << ' ';   // 4 on the diagonal, 3 otherwise
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    // =================================================================================
+
+    constexpr size_t SparseBenchmarkDim{ 1000 };
+    constexpr int SparseBenchmarkIterations{ 100 };
+
+    static void test_sparse_04_benchmark()
+    {
+        std::cout << "Sparse Matrices 04: Benchmark Sparse versus Dense" << std::endl;
+
+        constexpr size_t Dim{ SparseBenchmarkDim };
+
+        // dense matrices are too large for the stack
+        auto denseResult{ std::make_unique<Matrix<Dim>>() };
+
+        std::vector<double> x(Dim, 1.0);
+        std::vector<double> y(Dim);
+
+        size_t numThreads{ std::max(std::thread::hardware_concurrency(), 1u) };
+
+        for (double density : { 0.001, 0.01, 0.1, 0.5 }) {
+
+            std::vector<Triplet<>> triplets{ randomTriplets(Dim, Dim, density) };
+
+            CsrMatrix<> csr{ CsrMatrix<>::fromTriplets(Dim, Dim, triplets) };
+            CscMatrix<> csc{ csr.convert<MatrixLayout::ColumnMajor>() };
+
+            auto dense{ std::make_unique<Matrix<Dim>>() };
+            for (const auto& triplet : triplets) {
+                (*dense)(triplet.m_row, triplet.m_col) = triplet.m_value;
+            }
+
+            std::cout << "Density " << density << " - " << csr.nonZeros() << " non-zeros:" << std::endl;
+
+            {
+                std::cout << "  Dense  Matrix * Vector:       ";
+                ScopedTimer watch{};
+
+                for (int i{}; i != SparseBenchmarkIterations; ++i) {
+                    for (size_t row{}; row != Dim; ++row) {
+                        double sum{};
+                        for (size_t col{}; col != Dim; ++col) {
+                            sum += (*dense)(row, col) * x[col];
+                        }
+                        y[row] = sum;
+                    }
+                }
+            }
+
+            {
+                std::cout << "  CSR    Matrix * Vector:       ";
+                ScopedTimer watch{};
+
+                for (int i{}; i != SparseBenchmarkIterations; ++i) {
+                    csr.multiply(x, y);
+                }
+            }
+
+            {
+                std::cout << "  CSC    Matrix * Vector:       ";
+                ScopedTimer watch{};
+
+                for (int i{}; i != SparseBenchmarkIterations; ++i) {
+                    csc.multiply(x, y);
+                }
+            }
+
+            {
+                std::cout << "  CSR    Matrix * Vector (" << numThreads << "x): ";
+                std::vector<size_t> bounds{ csr.partitionRows(numThreads) };
+                ScopedTimer watch{};
+
+                for (int i{}; i != SparseBenchmarkIterations; ++i) {
+                    csr.multiplyParallel(x, y, bounds);
+                }
+            }
+
+            {
+                std::cout << "  Dense  Matrix + Matrix:       ";
+                MatrixExpr sum{ *dense, *dense };
+                ScopedTimer watch{};
+
+                for (int i{}; i != SparseBenchmarkIterations; ++i) {
+                    *denseResult = sum;
+                }
+            }
+
+            {
+                std::cout << "  CSR    Matrix + Matrix:       ";
+                ScopedTimer watch{};
+
+                for (int i{}; i != SparseBenchmarkIterations; ++i) {
+                    CsrMatrix<> sum{ csr + csr };
+                }
+            }
+        }
+    }
+}
+
+void main_expression_templates_sparse()
+{
+    using namespace ExpressionTemplates;
+    test_sparse_01();
+    test_sparse_02();
+    test_sparse_03();
+    test_sparse_04_benchmark();
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
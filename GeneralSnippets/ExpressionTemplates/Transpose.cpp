@@ -0,0 +1,183 @@
+// =====================================================================================
+// Transpose.cpp // Matrix Transpose and Storage Layouts
+// =====================================================================================
+
+module;
+
+#include "../ScopedTimer/ScopedTimer.h"
+
+module modern_cpp:expression_templates;
+
+import :matrix;
+
+namespace ExpressionTemplates {
+
+    template <size_t N, typename T, MatrixLayout L>
+    static void printMatrix(const Matrix<N, T, L>& matrix)
+    {
+        for (size_t x{}; x != N; ++x) {
+            for (size_t y{}; y != N; ++y) {
+                std::cout << std::setw(4) << matrix(x, y);
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    static void test_transpose_01()
+    {
+        std::cout << "Transpose 01: Transposed Matrix and Layout Conversion" << std::endl;
+
+        constexpr size_t Dim{ 4 };
+
+        Matrix<Dim> matrix{};
+        for (size_t x{}; x != Dim; ++x) {
+            for (size_t y{}; y != Dim; ++y) {
+                matrix(x, y) = static_cast<ElemType>(x * Dim + y);
+            }
+        }
+
+        printMatrix(matrix);
+        std::cout << std::endl;
+
+        printMatrix(matrix.transposed());
+        std::cout << std::endl;
+
+        // same logical matrix, storage order differs
+        Matrix<Dim, ElemType, MatrixLayout::ColumnMajor> columnMajor{
+            matrix.convert<MatrixLayout::ColumnMajor>()
+        };
+
+        printMatrix(columnMajor);
+
+        std::cout << "First elements in storage order: ";
+        for (size_t i{}; i != Dim; ++i) {
+            std::cout << columnMajor.data()[i] << ' ';   // 0 4 8 12
+        }
+        std::cout << std::endl;
+    }
+
+    static void test_transpose_02()
+    {
+        std::cout << "Transpose 02: Expressions with Mixed Layouts" << std::endl;
+
+        constexpr size_t Dim{ 3 };
+
+        Matrix<Dim, ElemType, MatrixLayout::RowMajor> a{ 1.0 };
+        Matrix<Dim, ElemType, MatrixLayout::ColumnMajor> b{ 2.0 };
+        a(0, 2) = 10.0;
+        b(2, 0) = 20.0;
+
+        // evaluated in the storage order of the destination
+        Matrix<Dim, ElemType, MatrixLayout::ColumnMajor> result{};
+        result = a + b;
+
+        printMatrix(result);
+    }
+
+    // =================================================================================
+
+    constexpr size_t LayoutBenchmarkDim{ 1000 };
+    constexpr int LayoutBenchmarkIterations{ 100 };
+
+    static void test_transpose_03_benchmark()
+    {
+        std::cout << "Transpose 03: Benchmark Destination Layout" << std::endl;
+
+        constexpr size_t Dim{ LayoutBenchmarkDim };
+
+        // matrices are too large for the stack
+        auto a{ std::make_unique<Matrix<Dim>>(1.0) };
+        auto b{ std::make_unique<Matrix<Dim>>(2.0) };
+        auto rowMajor{ std::make_unique<Matrix<Dim, ElemType, MatrixLayout::RowMajor>>() };
+        auto columnMajor{ std::make_unique<Matrix<Dim, ElemType, MatrixLayout::ColumnMajor>>() };
+
+        MatrixExpr sum{ *a, *b };
+
+        {
+            std::cout << "Row-major    operands => row-major    destination: ";
+            ScopedTimer watch{};
+
+            for (int i{}; i != LayoutBenchmarkIterations; ++i) {
+                *rowMajor = sum;
+            }
+        }
+
+        {
+            std::cout << "Row-major    operands => column-major destination: ";
+            ScopedTimer watch{};
+
+            for (int i{}; i != LayoutBenchmarkIterations; ++i) {
+                *columnMajor = sum;
+            }
+        }
+    }
+
+    // =================================================================================
+
+    using TransposeKernel = void(*)(const float*, float*, size_t, size_t);
+
+    static void runTransposeBenchmark(std::string_view name, TransposeKernel kernel,
+        const std::vector<float>& src, std::vector<float>& dst, size_t dim)
+    {
+        // poison the destination: a kernel leaving elements untouched must fail the verification
+        std::fill(dst.begin(), dst.end(), -1.0f);
+
+        std::cout << "  " << name;
+        ScopedTimer watch{};
+        kernel(src.data(), dst.data(), dim, dim);
+    }
+
+    static void test_transpose_04_benchmark()
+    {
+        std::cout << "Transpose 04: Benchmark Naive versus Blocked Transpose" << std::endl;
+
+        for (size_t dim : { 512, 1024, 2048, 4096, 8192 }) {
+
+            std::vector<float> src(dim * dim);
+            // float represents integers exactly only up to 2^24 ('std::iota' would stall there):
+            // with a prime modulus the values stay exact, and a misplaced element almost surely differs
+            for (size_t i{}; i != src.size(); ++i) {
+                src[i] = static_cast<float>(i % 1000003);
+            }
+
+            std::vector<float> expected(dim * dim);
+            std::vector<float> dst(dim * dim);
+
+            std::cout << "N = " << dim << ':' << std::endl;
+
+            runTransposeBenchmark("Naive:            ", transposeNaive<float>, src, expected, dim);
+
+            runTransposeBenchmark("Blocked:          ",
+                [](const float* src, float* dst, size_t rows, size_t cols) {
+                    transposeBlocked(src, dst, rows, cols);
+                },
+                src, dst, dim
+            );
+            std::cout << "  Verified: " << std::boolalpha << (dst == expected) << std::endl;
+
+            runTransposeBenchmark("Blocked (SIMD):   ",
+                [](const float* src, float* dst, size_t rows, size_t cols) {
+                    transposeBlockedSimd(src, dst, rows, cols);
+                },
+                src, dst, dim
+            );
+            std::cout << "  Verified: " << std::boolalpha << (dst == expected) << std::endl;
+
+            runTransposeBenchmark("Cache-Oblivious:  ", transposeRecursive<float>, src, dst, dim);
+            std::cout << "  Verified: " << std::boolalpha << (dst == expected) << std::endl;
+        }
+    }
+}
+
+void main_expression_templates_transpose()
+{
+    using namespace ExpressionTemplates;
+    test_transpose_01();
+    test_transpose_02();
+    test_transpose_03_benchmark();
+    test_transpose_04_benchmark();
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
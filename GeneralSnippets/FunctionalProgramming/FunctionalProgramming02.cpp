@@ -8,6 +8,9 @@ module;
 
 module modern_cpp:functional_programming;
 
+import :memory_resources;
+import :small_vector;
+
 namespace FunctionalProgramming_01 {
 
     // =================================================================================
@@ -82,6 +85,59 @@ namespace FunctionalProgramming_01 {
         return result;
     }
 
+    // =================================================================================
+    // 'filter' and 'map' with a polymorphic allocator:
+    // the result vector obtains its memory from the given memory resource
+
+    template <typename InputIterator, typename TFunctor>
+    auto filter(InputIterator begin, InputIterator end, TFunctor&& lambda, std::pmr::polymorphic_allocator<> allocator)
+        -> std::pmr::vector<ValueType<InputIterator>>
+    {
+        std::pmr::vector<ValueType<InputIterator>> result{ allocator };
+        result.reserve(std::distance(begin, end));
+        std::copy_if(begin, end, std::back_inserter(result), std::forward<TFunctor>(lambda));
+        return result;
+    }
+
+    template <typename InputIterator, typename TFunctor>
+    auto map(InputIterator begin, InputIterator end, TFunctor&& lambda, std::pmr::polymorphic_allocator<> allocator)
+        -> std::pmr::vector<decltype(std::declval<TFunctor>()(std::declval<ValueType<InputIterator>>()))>
+    {
+        using FunctorValueType = decltype(std::declval<TFunctor>()(std::declval<ValueType<InputIterator>>()));
+
+        std::pmr::vector<FunctorValueType> result{ allocator };
+        result.reserve(std::distance(begin, end));
+        std::transform(begin, end, std::back_inserter(result), std::forward<TFunctor>(lambda));
+        return result;
+    }
+
+    // =================================================================================
+    // 'filter' and 'map' with a 'SmallVector' result, e.g. 'filter<16>(...)':
+    // results of up to N elements are stored inline, there is no heap allocation.
+    // 'filter' doesn't reserve the size of the input range - most results of
+    // a small vector would spill to the heap right away
+
+    template <size_t N, typename InputIterator, typename TFunctor>
+    auto filter(InputIterator begin, InputIterator end, TFunctor&& lambda)
+        -> PlacementNew::SmallVector<ValueType<InputIterator>, N>
+    {
+        PlacementNew::SmallVector<ValueType<InputIterator>, N> result;
+        std::copy_if(begin, end, std::back_inserter(result), std::forward<TFunctor>(lambda));
+        return result;
+    }
+
+    template <size_t N, typename InputIterator, typename TFunctor>
+    auto map(InputIterator begin, InputIterator end, TFunctor&& lambda)
+        -> PlacementNew::SmallVector<decltype(std::declval<TFunctor>()(std::declval<ValueType<InputIterator>>())), N>
+    {
+        using FunctorValueType = decltype(std::declval<TFunctor>()(std::declval<ValueType<InputIterator>>()));
+
+        PlacementNew::SmallVector<FunctorValueType, N> result;
+        result.reserve(std::distance(begin, end));
+        std::transform(begin, end, std::back_inserter(result), std::forward<TFunctor>(lambda));
+        return result;
+    }
+
     // =================================================================================
     // testing 'filter'
 
@@ -477,6 +533,179 @@ namespace FunctionalProgramming_01 {
 
         std::cout << result3 << std::endl;
     }
+
+    // =================================================================================
+    // testing 'filter' and 'map' with polymorphic allocators
+
+    static void test_functional_pmr_05a() {
+
+        std::vector<int> vec(20);
+        std::generate(std::begin(vec), std::end(vec), [value = 0]() mutable {
+            return ++value;
+        });
+
+        // both result vectors are placed in a buffer on the stack,
+        // the upstream resource is called only if the buffer is too small
+        std::array<std::byte, 512> buffer;
+        Allocator::TrackingResource upstream{};
+        std::pmr::monotonic_buffer_resource resource{ buffer.data(), buffer.size(), &upstream };
+
+        auto evens = filter(
+            std::begin(vec),
+            std::end(vec),
+            [](int i) { return i % 2 == 0; },
+            &resource
+        );
+
+        auto doubled = map(
+            std::begin(evens),
+            std::end(evens),
+            [](int i) { return i * 2; },
+            &resource
+        );
+
+        std::for_each(std::begin(doubled), std::end(doubled), [](int value) {
+            std::cout << value << ' ';
+            }
+        );
+        std::cout << std::endl;
+
+        std::cout << "Allocations from upstream resource: " << upstream.stats().m_allocations << std::endl;
+    }
+
+    // filter - map - sum with different memory resources
+    static void test_functional_pmr_05b_benchmark() {
+
+        constexpr size_t ElementsPerMeasurement{ 20000000 };
+
+        auto pipeline = [](const std::vector<int>& numbers, std::pmr::memory_resource* resource) {
+
+            auto evens = filter(std::begin(numbers), std::end(numbers), [](int i) { return i % 2 == 0; }, resource);
+            auto doubled = map(std::begin(evens), std::end(evens), [](int i) { return i * 2; }, resource);
+            return std::accumulate(std::begin(doubled), std::end(doubled), size_t{});
+        };
+
+        auto measure = [&](std::string_view name, const std::vector<int>& numbers, std::pmr::memory_resource* resource, auto reset) {
+
+            const size_t repetitions{ ElementsPerMeasurement / numbers.size() };
+
+            size_t checksum{};
+            const auto begin{ std::chrono::steady_clock::now() };
+
+            for (size_t i{}; i != repetitions; ++i) {
+                checksum += pipeline(numbers, resource);
+                reset();
+            }
+
+            const auto end{ std::chrono::steady_clock::now() };
+            const double nanoseconds{ std::chrono::duration<double, std::nano>{ end - begin }.count() };
+
+            std::cout << "  " << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(8) << nanoseconds / static_cast<double>(repetitions) << " ns/call  (Checksum: "
+                      << checksum << ')' << std::endl;
+        };
+
+        std::cout << "Benchmark - filter / map with std::pmr" << std::endl;
+
+        for (size_t size : { 16, 1000, 100000 }) {
+
+            std::vector<int> numbers(size);
+            std::iota(std::begin(numbers), std::end(numbers), 0);
+
+            std::cout << "Elements: " << size << std::endl;
+
+            measure("new_delete_resource", numbers, std::pmr::new_delete_resource(), [] {});
+
+            std::vector<std::byte> buffer(4 * size * sizeof(int) + 1024);
+            std::pmr::monotonic_buffer_resource monotonic{ buffer.data(), buffer.size() };
+            measure("monotonic_buffer_resource", numbers, &monotonic, [&] { monotonic.release(); });
+
+            std::pmr::unsynchronized_pool_resource pool{};
+            measure("unsynchronized_pool_resource", numbers, &pool, [] {});
+
+            Allocator::PerThreadPoolResource perThreadPool{};
+            measure("PerThreadPoolResource", numbers, &perThreadPool, [] {});
+        }
+
+        std::cout << std::defaultfloat << std::setprecision(6);
+    }
+
+    // =================================================================================
+    // testing 'filter' and 'map' with small vectors
+
+    static void test_functional_small_06a() {
+
+        PlacementNew::SmallVector<int, 16> numbers{ 0, 2, -3, 5, -1, 6, 8, -4, 9 };
+
+        auto positives = filter<16>(
+            std::begin(numbers),
+            std::end(numbers),
+            [](int i) { return i > 0; }
+        );
+
+        auto squares = map<16>(
+            std::begin(positives),
+            std::end(positives),
+            [](int i) { return i * i; }
+        );
+
+        std::for_each(std::begin(squares), std::end(squares), [](int value) {
+            std::cout << value << ' ';
+            }
+        );
+        std::cout << std::endl;
+
+        std::cout << "Stored inline: " << std::boolalpha << squares.isInline() << std::noboolalpha << std::endl;
+    }
+
+    // filter - map - sum with 'std::vector' and 'SmallVector' results
+    static void test_functional_small_06b_benchmark() {
+
+        constexpr size_t ElementsPerMeasurement{ 20000000 };
+
+        auto measure = [&](std::string_view name, const std::vector<int>& numbers, auto pipeline) {
+
+            const size_t repetitions{ ElementsPerMeasurement / numbers.size() };
+
+            size_t checksum{};
+            const auto begin{ std::chrono::steady_clock::now() };
+
+            for (size_t i{}; i != repetitions; ++i) {
+                checksum += pipeline(numbers);
+            }
+
+            const auto end{ std::chrono::steady_clock::now() };
+            const double nanoseconds{ std::chrono::duration<double, std::nano>{ end - begin }.count() };
+
+            std::cout << "  " << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(8) << nanoseconds / static_cast<double>(repetitions) << " ns/call  (Checksum: "
+                      << checksum << ')' << std::endl;
+        };
+
+        std::cout << "Benchmark - filter / map with SmallVector" << std::endl;
+
+        for (size_t size : { 8, 16, 32, 33, 64 }) {
+
+            std::vector<int> numbers(size);
+            std::iota(std::begin(numbers), std::end(numbers), 0);
+
+            std::cout << "Elements: " << size << std::endl;
+
+            measure("std::vector", numbers, [](const std::vector<int>& numbers) {
+                auto evens = filter(std::begin(numbers), std::end(numbers), [](int i) { return i % 2 == 0; });
+                auto doubled = map(std::begin(evens), std::end(evens), [](int i) { return i * 2; });
+                return std::accumulate(std::begin(doubled), std::end(doubled), size_t{});
+            });
+
+            measure("SmallVector<int, 16>", numbers, [](const std::vector<int>& numbers) {
+                auto evens = filter<16>(std::begin(numbers), std::end(numbers), [](int i) { return i % 2 == 0; });
+                auto doubled = map<16>(std::begin(evens), std::end(evens), [](int i) { return i * 2; });
+                return std::accumulate(std::begin(doubled), std::end(doubled), size_t{});
+            });
+        }
+
+        std::cout << std::defaultfloat << std::setprecision(6);
+    }
 }
 
 void main_functional_programming()
@@ -503,6 +732,14 @@ void main_functional_programming()
     test_functional_fmr_pattern_04b();
     test_functional_fmr_pattern_04c();
     test_functional_fmr_pattern_04d();
+
+    // testing 'filter' and 'map' with polymorphic allocators
+    test_functional_pmr_05a();
+    test_functional_pmr_05b_benchmark();
+
+    // testing 'filter' and 'map' with small vectors
+    test_functional_small_06a();
+    test_functional_small_06b_benchmark();
 }
 
 // =====================================================================================
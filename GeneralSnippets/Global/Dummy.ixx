@@ -6,7 +6,8 @@ export module modern_cpp:dummy;
 
 import std;
 
-constexpr bool isVerbose = true;
+// output of all special member functions, may be switched off by benchmarks
+inline bool isVerbose = true;
 
 class Dummy
 {
@@ -35,12 +36,16 @@ public:
 
     Dummy(const Dummy& other) {
         m_dummy = other.m_dummy;
-        std::cout << "Copy-c'tor Dummy [" << m_dummy << "]" << std::endl;
+        if (isVerbose) {
+            std::cout << "Copy-c'tor Dummy [" << m_dummy << "]" << std::endl;
+        }
     }
 
     Dummy& operator=(Dummy const& other) {
         m_dummy = other.m_dummy;
-        std::cout << "Dummy::operator=" << std::endl;
+        if (isVerbose) {
+            std::cout << "Dummy::operator=" << std::endl;
+        }
         return *this;
     }
 
@@ -48,7 +53,9 @@ public:
     Dummy(Dummy&& other) noexcept {
         m_dummy = other.m_dummy;  // move ownership to target 
         other.m_dummy = 0;        // reset source (symbolic statement)
-        std::cout << "Move c'tor Dummy" << std::endl;
+        if (isVerbose) {
+            std::cout << "Move c'tor Dummy" << std::endl;
+        }
     }
 
     Dummy& operator=(Dummy&& other) noexcept {
@@ -59,7 +66,9 @@ public:
 
         m_dummy = other.m_dummy;  // move ownership to target 
         other.m_dummy = 0;        // reset source (symbolic statement)
-        std::cout << "Move Dummy::operator=" << std::endl;
+        if (isVerbose) {
+            std::cout << "Move Dummy::operator=" << std::endl;
+        }
         return *this;
     }
 
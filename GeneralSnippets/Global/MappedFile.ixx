@@ -0,0 +1,103 @@
+// ===============================================================================
+// MappedFile.ixx // Read-Only Memory Mapping of a File
+// ===============================================================================
+
+module;
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+export module modern_cpp:mapped_file;
+
+import std;
+
+// read-only mapping of a whole file
+class MappedFile
+{
+private:
+    const std::byte* m_data;
+    size_t           m_size;
+
+public:
+    explicit MappedFile(const std::filesystem::path& path) : m_data{}, m_size{}
+    {
+#if defined(_WIN32)
+        HANDLE file{ ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error{ "Cannot open file " + path.string() };
+        }
+
+        LARGE_INTEGER size{};
+        ::GetFileSizeEx(file, &size);
+        m_size = static_cast<size_t>(size.QuadPart);
+
+        HANDLE mapping{ ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr) };
+        ::CloseHandle(file);
+
+        if (mapping == nullptr) {
+            throw std::runtime_error{ "Cannot map file " + path.string() };
+        }
+
+        // the view keeps the mapping object alive
+        m_data = static_cast<const std::byte*>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        ::CloseHandle(mapping);
+#else
+        int fd{ ::open(path.c_str(), O_RDONLY) };
+
+        if (fd == -1) {
+            throw std::runtime_error{ "Cannot open file " + path.string() };
+        }
+
+        struct stat status {};
+        ::fstat(fd, &status);
+        m_size = static_cast<size_t>(status.st_size);
+
+        void* address{ ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0) };
+        ::close(fd);
+
+        m_data = (address == MAP_FAILED) ? nullptr : static_cast<const std::byte*>(address);
+#endif
+        if (m_data == nullptr) {
+            throw std::runtime_error{ "Cannot map file " + path.string() };
+        }
+    }
+
+    ~MappedFile()
+    {
+        if (m_data != nullptr) {
+#if defined(_WIN32)
+            ::UnmapViewOfFile(m_data);
+#else
+            ::munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+        }
+    }
+
+    // no copying, moving only
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : m_data{ std::exchange(other.m_data, nullptr) }, m_size{ std::exchange(other.m_size, 0) }
+    {}
+
+    MappedFile& operator=(MappedFile&&) = delete;
+
+    // getter
+    const std::byte* data() const { return m_data; }
+    size_t size() const { return m_size; }
+};
+
+// ===============================================================================
+// End-of-File
+// ===============================================================================
@@ -0,0 +1,117 @@
+// ===============================================================================
+// PerfCounter.ixx // Hardware Performance Counters (Cache Misses, TLB Misses)
+// ===============================================================================
+
+module;
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+export module modern_cpp:perf_counter;
+
+import std;
+
+// Hardware counters are read with 'perf_event_open' on Linux.
+// On other platforms (and on Linux without permission, see
+// '/proc/sys/kernel/perf_event_paranoid') the counters are not available,
+// use an external profiler instead (Windows: VTune, AMD uProf, WPR/WPA).
+
+enum class PerfEvent { CacheMisses, LastLevelCacheMisses, DataTlbMisses };
+
+class PerfCounter
+{
+private:
+    int m_fd;
+
+public:
+    // c'tors / d'tor
+    explicit PerfCounter(PerfEvent event) : m_fd{ -1 }
+    {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        switch (event)
+        {
+        case PerfEvent::CacheMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+
+        case PerfEvent::LastLevelCacheMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_LL |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+
+        case PerfEvent::DataTlbMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        }
+
+        m_fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+        (void) event;
+#endif
+    }
+
+    ~PerfCounter()
+    {
+#if defined(__linux__)
+        if (m_fd != -1) {
+            ::close(m_fd);
+        }
+#endif
+    }
+
+    // no copying or moving
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    PerfCounter(PerfCounter&&) = delete;
+    PerfCounter& operator=(PerfCounter&&) = delete;
+
+    // public interface
+    bool isAvailable() const { return m_fd != -1; }
+
+    void start()
+    {
+#if defined(__linux__)
+        if (m_fd != -1) {
+            ::ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    std::optional<std::uint64_t> stop()
+    {
+#if defined(__linux__)
+        if (m_fd != -1) {
+            ::ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+
+            std::uint64_t value{};
+            if (::read(m_fd, &value, sizeof(value)) == sizeof(value)) {
+                return value;
+            }
+        }
+#endif
+        return std::nullopt;
+    }
+};
+
+// ===============================================================================
+// End-of-File
+// ===============================================================================
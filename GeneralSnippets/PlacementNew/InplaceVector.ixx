@@ -0,0 +1,251 @@
+// =====================================================================================
+// InplaceVector.ixx // Vector with fixed Capacity and inline Storage (no Heap)
+// =====================================================================================
+
+export module modern_cpp:inplace_vector;
+
+import std;
+
+// 'InplaceVector<T, Capacity>' (compare C++26 'std::inplace_vector') holds up to Capacity
+// elements within the object itself - there is no heap allocation at all.
+// In contrast to 'std::array<T, Capacity>' or 'T[Capacity]' no element is constructed
+// in advance: a type like 'User' without default c'tor can be stored, too.
+// Elements are created on demand with 'std::construct_at' - placement new,
+// that may be used in constant expressions. For trivial types the whole
+// vector can be used in 'constexpr' functions.
+
+namespace PlacementNew {
+
+    template <typename T, size_t Capacity>
+    class InplaceVector
+    {
+        static_assert(Capacity > 0, "InplaceVector: capacity must not be zero");
+
+    public:
+        using value_type = T;
+        using size_type = size_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+    private:
+        // trivial types: an ordinary array, usable in constant expressions.
+        // All other types: raw memory
+        static constexpr bool IsTrivial{
+            std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>
+        };
+
+        struct RawStorage
+        {
+            alignas(T) std::byte m_bytes[Capacity * sizeof(T)];
+        };
+
+        using Storage = std::conditional_t<IsTrivial, std::array<T, Capacity>, RawStorage>;
+
+        Storage m_storage;
+        size_t  m_size;
+
+    public:
+        // c'tors / d'tor
+        constexpr InplaceVector() noexcept : m_size{} {
+            // the value of a 'constexpr' variable must be initialized completely,
+            // at run time the elements remain uninitialized
+            if constexpr (IsTrivial) {
+                if (std::is_constant_evaluated()) {
+                    m_storage = Storage{};
+                }
+            }
+        }
+
+        constexpr InplaceVector(std::initializer_list<T> values) : InplaceVector{} {
+            checkCapacity(values.size());
+            for (const T& value : values) {
+                unchecked_emplace_back(value);
+            }
+        }
+
+        constexpr InplaceVector(size_t count, const T& value) : InplaceVector{} {
+            checkCapacity(count);
+            for (size_t i{}; i != count; ++i) {
+                unchecked_emplace_back(value);
+            }
+        }
+
+        // only the existing elements are copied (moved)
+        constexpr InplaceVector(const InplaceVector& other) : InplaceVector{} {
+            for (const T& value : other) {
+                unchecked_emplace_back(value);
+            }
+        }
+
+        constexpr InplaceVector(InplaceVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+            : InplaceVector{}
+        {
+            for (T& value : other) {
+                unchecked_emplace_back(std::move(value));
+            }
+        }
+
+        constexpr ~InplaceVector() requires std::is_trivially_destructible_v<T> = default;
+
+        constexpr ~InplaceVector() {
+            clear();
+        }
+
+        constexpr InplaceVector& operator= (const InplaceVector& other) {
+
+            if (this != &other) {
+                clear();
+                for (const T& value : other) {
+                    unchecked_emplace_back(value);
+                }
+            }
+
+            return *this;
+        }
+
+        constexpr InplaceVector& operator= (InplaceVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+
+            if (this != &other) {
+                clear();
+                for (T& value : other) {
+                    unchecked_emplace_back(std::move(value));
+                }
+            }
+
+            return *this;
+        }
+
+        // getter
+        constexpr size_t size() const { return m_size; }
+        static constexpr size_t capacity() { return Capacity; }
+        constexpr bool empty() const { return m_size == 0; }
+        constexpr bool full() const { return m_size == Capacity; }
+
+        constexpr T* data() {
+            if constexpr (IsTrivial) {
+                return m_storage.data();
+            }
+            else {
+                return reinterpret_cast<T*>(m_storage.m_bytes);
+            }
+        }
+
+        constexpr const T* data() const {
+            if constexpr (IsTrivial) {
+                return m_storage.data();
+            }
+            else {
+                return reinterpret_cast<const T*>(m_storage.m_bytes);
+            }
+        }
+
+        // element access
+        constexpr T& operator[] (size_t index) { return data()[index]; }
+        constexpr const T& operator[] (size_t index) const { return data()[index]; }
+
+        constexpr T& at(size_t index) {
+            checkIndex(index);
+            return data()[index];
+        }
+
+        constexpr const T& at(size_t index) const {
+            checkIndex(index);
+            return data()[index];
+        }
+
+        constexpr T& front() { return data()[0]; }
+        constexpr const T& front() const { return data()[0]; }
+
+        constexpr T& back() { return data()[m_size - 1]; }
+        constexpr const T& back() const { return data()[m_size - 1]; }
+
+        // iterators
+        constexpr iterator begin() { return data(); }
+        constexpr iterator end() { return data() + m_size; }
+        constexpr const_iterator begin() const { return data(); }
+        constexpr const_iterator end() const { return data() + m_size; }
+        constexpr const_iterator cbegin() const { return data(); }
+        constexpr const_iterator cend() const { return data() + m_size; }
+
+        // public interface
+        constexpr void push_back(const T& value) { emplace_back(value); }
+
+        constexpr void push_back(T&& value) { emplace_back(std::move(value)); }
+
+        // throws 'std::bad_alloc', if the vector is full (like 'std::inplace_vector')
+        template <typename... TArgs>
+        constexpr T& emplace_back(TArgs&&... args) {
+            checkCapacity(m_size + 1);
+            return unchecked_emplace_back(std::forward<TArgs>(args)...);
+        }
+
+        // returns 'nullptr', if the vector is full
+        template <typename... TArgs>
+        constexpr T* try_emplace_back(TArgs&&... args) {
+
+            if (full()) {
+                return nullptr;
+            }
+
+            return &unchecked_emplace_back(std::forward<TArgs>(args)...);
+        }
+
+        constexpr T* try_push_back(const T& value) { return try_emplace_back(value); }
+
+        constexpr T* try_push_back(T&& value) { return try_emplace_back(std::move(value)); }
+
+        // precondition: the vector isn't full
+        template <typename... TArgs>
+        constexpr T& unchecked_emplace_back(TArgs&&... args) {
+
+            T* element{ std::construct_at(data() + m_size, std::forward<TArgs>(args)...) };
+            ++m_size;
+            return *element;
+        }
+
+        constexpr void pop_back() {
+
+            --m_size;
+            std::destroy_at(data() + m_size);
+        }
+
+        constexpr iterator erase(const_iterator position) { return erase(position, position + 1); }
+
+        constexpr iterator erase(const_iterator first, const_iterator last) {
+
+            T* pos{ data() + (first - cbegin()) };
+
+            if (first != last) {
+                T* newEnd{ std::move(pos + (last - first), end(), pos) };
+                std::destroy(newEnd, end());
+                m_size = static_cast<size_t>(newEnd - data());
+            }
+
+            return pos;
+        }
+
+        constexpr void clear() {
+            std::destroy(begin(), end());
+            m_size = 0;
+        }
+
+    private:
+        static constexpr void checkCapacity(size_t size) {
+            if (size > Capacity) {
+                throw std::bad_alloc{};
+            }
+        }
+
+        constexpr void checkIndex(size_t index) const {
+            if (index >= m_size) {
+                throw std::out_of_range{ "InplaceVector: index out of range" };
+            }
+        }
+    };
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
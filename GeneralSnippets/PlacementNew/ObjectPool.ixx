@@ -0,0 +1,230 @@
+// =====================================================================================
+// ObjectPool.ixx // Typed Object Pools with intrusive Free Lists
+// =====================================================================================
+
+export module modern_cpp:object_pool;
+
+import std;
+
+import :thread_caching_allocator;
+
+// Short-lived objects of the same type are created and destroyed millions of times.
+// An object pool requests memory for many objects at once (a "slab") and keeps the
+// unused slots in a free list: 'acquire' constructs an object in a free slot with
+// placement new, 'release' calls the d'tor and returns the slot to the free list.
+// The free list is intrusive - an unused slot stores the pointer to the next slot.
+//
+//  - ObjectPool<T>:              pool object, single-threaded, no locks
+//  - ThreadCachingObjectPool<T>: one pool per type, shared by all threads,
+//                                built upon the thread caches of 'SmallObjectHeap'
+
+namespace PlacementNew {
+
+    // memory of one object - or the link to the next free slot
+    template <typename T>
+    union PoolSlot
+    {
+        PoolSlot* m_next;
+        alignas(T) std::byte m_storage[sizeof(T)];
+    };
+
+    // a slab: 'count' slots, linked into a free list (in address order)
+    template <typename T>
+    PoolSlot<T>* allocateSlab(size_t count)
+    {
+        using Slot = PoolSlot<T>;
+
+        void* memory{ ::operator new(count * sizeof(Slot), std::align_val_t{ alignof(Slot) }) };
+        Slot* slab{ static_cast<Slot*>(memory) };
+
+        Slot* head{};
+        for (size_t i{ count }; i != 0; --i) {
+            head = ::new (static_cast<void*>(slab + (i - 1))) Slot{ head };
+        }
+
+        return head;
+    }
+
+    template <typename T>
+    void releaseSlab(PoolSlot<T>* slab) noexcept
+    {
+        ::operator delete(slab, std::align_val_t{ alignof(PoolSlot<T>) });
+    }
+
+    // =================================================================================
+
+    template <typename T, size_t ObjectsPerSlab = 256>
+    class ObjectPool
+    {
+        static_assert(ObjectsPerSlab > 0, "ObjectPool: a slab must contain at least one object");
+
+    public:
+        struct Deleter
+        {
+            ObjectPool* m_pool;
+
+            void operator() (T* object) const noexcept {
+                m_pool->release(object);
+            }
+        };
+
+        using UniquePtr = std::unique_ptr<T, Deleter>;
+
+    private:
+        using Slot = PoolSlot<T>;
+
+        Slot*              m_freeList;
+        std::vector<Slot*> m_slabs;
+        size_t             m_inUse;
+
+    public:
+        // c'tor / d'tor
+        ObjectPool() : m_freeList{}, m_slabs{}, m_inUse{} {}
+
+        ObjectPool(const ObjectPool&) = delete;
+        ObjectPool& operator= (const ObjectPool&) = delete;
+
+        // all objects must have been released before
+        ~ObjectPool() {
+            for (Slot* slab : m_slabs) {
+                releaseSlab<T>(slab);
+            }
+        }
+
+        // getter
+        size_t slabs() const { return m_slabs.size(); }
+        size_t inUse() const { return m_inUse; }
+
+        // public interface
+        template <typename... TArgs>
+        T* acquire(TArgs&&... args)
+        {
+            if (m_freeList == nullptr) {
+                addSlab();
+            }
+
+            Slot* slot{ m_freeList };
+            m_freeList = slot->m_next;
+
+            T* object{};
+            try {
+                object = ::new (static_cast<void*>(slot->m_storage)) T(std::forward<TArgs>(args)...);
+            }
+            catch (...) {
+                push(slot);
+                throw;
+            }
+
+            ++m_inUse;
+            return object;
+        }
+
+        void release(T* object) noexcept
+        {
+            std::destroy_at(object);
+            push(reinterpret_cast<Slot*>(object));
+            --m_inUse;
+        }
+
+        // 'std::unique_ptr' that returns its object to this pool
+        template <typename... TArgs>
+        UniquePtr makeUnique(TArgs&&... args) {
+            return UniquePtr{ acquire(std::forward<TArgs>(args)...), Deleter{ this } };
+        }
+
+    private:
+        void push(Slot* slot) noexcept {
+            slot->m_next = m_freeList;
+            m_freeList = slot;
+        }
+
+        void addSlab() {
+            m_slabs.reserve(m_slabs.size() + 1);    // 'push_back' mustn't throw after the allocation
+            m_freeList = allocateSlab<T>(ObjectsPerSlab);
+            m_slabs.push_back(m_freeList);
+        }
+    };
+
+    // =================================================================================
+
+    // the memory comes from 'Allocator::SmallObjectHeap': thread caches, batches and the
+    // depot are shared with all other users of the heap, the pool adds the construction
+    // and destruction of the objects. Objects larger than 'SmallObjectHeap::MaxSize'
+    // and over-aligned types are served by 'operator new'
+
+    template <typename T>
+    class ThreadCachingObjectPool
+    {
+    public:
+        // stateless: 'std::unique_ptr<T, Deleter>' has the size of a pointer
+        struct Deleter
+        {
+            void operator() (T* object) const noexcept {
+                ThreadCachingObjectPool::release(object);
+            }
+        };
+
+        using UniquePtr = std::unique_ptr<T, Deleter>;
+
+    private:
+        using Heap = Allocator::SmallObjectHeap;
+
+        static constexpr bool IsOverAligned{ alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__ };
+
+    public:
+        // public interface
+        template <typename... TArgs>
+        static T* acquire(TArgs&&... args)
+        {
+            void* slot{ allocate() };
+
+            T* object{};
+            try {
+                object = ::new (slot) T(std::forward<TArgs>(args)...);
+            }
+            catch (...) {
+                deallocate(slot);
+                throw;
+            }
+
+            return object;
+        }
+
+        // may be called by any thread: the slot goes into the cache of the calling thread
+        static void release(T* object) noexcept
+        {
+            std::destroy_at(object);
+            deallocate(object);
+        }
+
+        template <typename... TArgs>
+        static UniquePtr makeUnique(TArgs&&... args) {
+            return UniquePtr{ acquire(std::forward<TArgs>(args)...) };
+        }
+
+    private:
+        static void* allocate() {
+
+            if constexpr (IsOverAligned) {
+                return ::operator new(sizeof(T), std::align_val_t{ alignof(T) });
+            }
+            else {
+                return Heap::allocate(sizeof(T));
+            }
+        }
+
+        static void deallocate(void* slot) noexcept {
+
+            if constexpr (IsOverAligned) {
+                ::operator delete(slot, std::align_val_t{ alignof(T) });
+            }
+            else {
+                Heap::deallocate(slot, sizeof(T));
+            }
+        }
+    };
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
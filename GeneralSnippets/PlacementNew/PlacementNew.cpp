@@ -4,8 +4,18 @@
 
 module modern_cpp:placement_new;
 
+import :growth_vector;
+import :inplace_vector;
+import :memory_resources;
+import :object_pool;
+import :small_vector;
+import :vector_ex;
+
 namespace PlacementNew {
 
+    // output of the special member functions of 'User', switched off by the benchmarks
+    bool isVerbose{ true };
+
     class User
     {
     private:
@@ -16,23 +26,31 @@ namespace PlacementNew {
         User(std::string name, int age)
             : m_name{ name }, m_age{ age }
         {
-            std::cout << "c'tor User" << std::endl;
+            if (isVerbose) {
+                std::cout << "c'tor User" << std::endl;
+            }
         }
 
         ~User() {
-            std::cout << "d'tor User" << std::endl;
+            if (isVerbose) {
+                std::cout << "d'tor User" << std::endl;
+            }
         }
 
         User(const User& other) 
             : m_name{ other.m_name }, m_age{ other.m_age }
         {
-            std::cout << "copy c'tor: " << m_name << " - " << m_age << '.' << std::endl;
+            if (isVerbose) {
+                std::cout << "copy c'tor: " << m_name << " - " << m_age << '.' << std::endl;
+            }
         }
 
         User(User&& other) noexcept 
             : m_name{ std::move(other.m_name) }, m_age{ other.m_age }
         {
-            std::cout << "move c'tor: " << m_name << " - " << m_age << '.' << std::endl;
+            if (isVerbose) {
+                std::cout << "move c'tor: " << m_name << " - " << m_age << '.' << std::endl;
+            }
         }
 
         // getter
@@ -119,62 +137,415 @@ namespace PlacementNew {
         User* node2 = ::new (static_cast<void*>(&data[1])) User{ "Jack", 50 };
 
         node2->print();
+
+        // no placement delete: the d'tors are called explicitly (see 'ObjectPool' for reuse)
+        node2->~User();
+        node->~User();
+        std::free(memory);
     }
 
     // ===========================================================
+    // 'VectorEx<T>': see VectorEx.ixx
 
-    template <class T>
-    class VectorEx
+    static void test_07()
+    {
+        VectorEx<User> vec;
+
+        for (int i{}; i < 5; ++i) {
+            vec.push_back(User{ "Sepp", 40 });
+        }
+    }
+
+    static void test_08()
+    {
+        VectorEx<User> vec;
+
+        // no temporary object: the c'tor is called with the arguments in place
+        vec.emplace_back("Hans", 30);
+        vec.emplace_back("Sepp", 40);
+        vec.emplace_back("Franz", 50);
+
+        for (const auto& user : vec) {
+            user.print();
+        }
+
+        // geometric growth: 10, 20, 40, ... - the elements are moved into the new buffer
+        isVerbose = false;
+        for (int i{}; i != 100; ++i) {
+            vec.emplace_back("Anonymous", i);
+        }
+        isVerbose = true;
+
+        std::cout << "Size: " << vec.size() << ", Capacity: " << vec.capacity() << std::endl;
+    }
+
+    // ===========================================================
+    // benchmark: 'push_back' without 'reserve' - growth-heavy workload
+
+    // owns its name on the heap: not trivially copyable, but its bytes may be copied
+    // to another address (trivially relocatable) - see the opt-in below
+    class UserRecord
     {
     private:
-        size_t m_capacity;
-        size_t m_size;
-        T* m_data;
+        std::unique_ptr<std::string> m_name;
+        int m_age;
 
     public:
-        VectorEx() :
-            m_capacity{ 10 },
-            m_size{},
-            m_data{ reinterpret_cast<T*>(std::malloc(sizeof(T) * m_capacity)) }
+        UserRecord(std::string name, int age)
+            : m_name{ std::make_unique<std::string>(std::move(name)) }, m_age{ age }
         {}
 
-        ~VectorEx()
-        {
-            while (m_size) {
-                pop_back();
+        // getter
+        int getAge() const { return m_age; }
+        const std::string& getName() const { return *m_name; }
+    };
+}
+
+// opt-in: 'VectorEx<UserRecord>' relocates its elements with 'memcpy'
+template <>
+struct Allocator::IsTriviallyRelocatable<PlacementNew::UserRecord> : std::true_type {};
+
+namespace PlacementNew {
+
+    constexpr size_t ElementsPerMeasurement{ 2'000'000 };
+
+    // best of several rounds: less sensitive to other processes
+    constexpr size_t Rounds{ 5 };
+
+    template <typename TVector, typename TMake>
+    static void measureGrowth(std::string_view name, size_t size, TMake make)
+    {
+        const size_t repetitions{ std::max(ElementsPerMeasurement / size, size_t{ 1 }) };
+
+        size_t checksum{};
+        double nanoseconds{ std::numeric_limits<double>::max() };
+
+        for (size_t round{}; round != Rounds; ++round) {
+
+            const auto begin{ std::chrono::steady_clock::now() };
+
+            for (size_t n{}; n != repetitions; ++n) {
+
+                TVector vec{};
+                for (size_t i{}; i != size; ++i) {
+                    vec.push_back(make(i));
+                }
+                checksum += vec.size();
             }
 
-            std::free(m_data);
+            const auto end{ std::chrono::steady_clock::now() };
+
+            const double elapsed{
+                static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count())
+                / static_cast<double>(repetitions * size)
+            };
+
+            nanoseconds = std::min(nanoseconds, elapsed);
         }
 
-        void push_back(const T& value)
-        {
-            T* ptr{ m_data + m_size };
-            new (ptr) T{ value };
-            ++m_size;
+        std::println("  {:<32} {:8.2f} ns/element  (Checksum: {})", name, nanoseconds, checksum);
+    }
+
+    static void test_09_benchmark()
+    {
+        isVerbose = false;
+
+        for (size_t size : { 100, 10'000, 1'000'000 }) {
+
+            std::println("Elements: {}", size);
+
+            auto makeUser = [](size_t i) { return User{ "Sepp", static_cast<int>(i) }; };
+            measureGrowth<std::vector<User>>("std::vector<User>", size, makeUser);
+            measureGrowth<VectorEx<User>>("VectorEx<User>", size, makeUser);
+
+            auto makeString = [](size_t) { return std::string{ "Sepp" }; };
+            measureGrowth<std::vector<std::string>>("std::vector<std::string>", size, makeString);
+            measureGrowth<VectorEx<std::string>>("VectorEx<std::string>", size, makeString);
+
+            auto makeRecord = [](size_t i) { return UserRecord{ "Sepp", static_cast<int>(i) }; };
+            measureGrowth<std::vector<UserRecord>>("std::vector<UserRecord>", size, makeRecord);
+            measureGrowth<VectorEx<UserRecord>>("VectorEx<UserRecord> (memcpy)", size, makeRecord);
+        }
+
+        isVerbose = true;
+    }
+
+    // ===========================================================
+    // 'SmallVector<T, N>': see SmallVector.ixx
+
+    static void test_10()
+    {
+        SmallVector<User, 2> users;
+
+        users.emplace_back("Hans", 30);
+        users.emplace_back("Sepp", 40);
+        std::cout << "Size: " << users.size() << ", Inline: " << std::boolalpha << users.isInline() << std::endl;
+
+        // third element: the elements are moved into a buffer on the heap
+        users.emplace_back("Franz", 50);
+        std::cout << "Size: " << users.size() << ", Inline: " << users.isInline() << std::endl;
+
+        users.pop_back();
+        users.shrink_to_fit();
+        std::cout << "Size: " << users.size() << ", Inline: " << users.isInline() << std::noboolalpha << std::endl;
+
+        for (const auto& user : users) {
+            user.print();
         }
+    }
+
+    // allocations and run time of 'push_back' for sizes around the inline capacity
+    static void test_11_benchmark()
+    {
+        constexpr size_t InlineCapacity{ 16 };
+        constexpr size_t Repetitions{ 1'000'000 };
+
+        Allocator::TrackingResource tracking{ std::pmr::new_delete_resource() };
+
+        auto measure = [&]<typename TVector>(std::string_view name, size_t size) {
+
+            tracking.reset();
+
+            size_t checksum{};
+
+            const auto begin{ std::chrono::steady_clock::now() };
+
+            for (size_t n{}; n != Repetitions; ++n) {
+
+                TVector numbers{ &tracking };
+                for (size_t i{}; i != size; ++i) {
+                    numbers.push_back(static_cast<int>(i));
+                }
+                checksum += std::accumulate(numbers.begin(), numbers.end(), size_t{});
+            }
 
-        void push_back(T&& value)
+            const auto end{ std::chrono::steady_clock::now() };
+
+            const double nanoseconds{
+                static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count())
+                / static_cast<double>(Repetitions)
+            };
+
+            std::println("  {:<24} {:8.1f} ns/vector  Allocations/vector: {:5.2f}  (Checksum: {})",
+                name, nanoseconds, static_cast<double>(tracking.stats().m_allocations) / Repetitions, checksum);
+        };
+
+        for (size_t size : { 4, 8, 15, 16, 17, 32, 64 }) {
+
+            std::println("Elements: {}", size);
+
+            measure.template operator()<std::pmr::vector<int>>("std::pmr::vector", size);
+            measure.template operator()<SmallVector<int, InlineCapacity, std::pmr::polymorphic_allocator<int>>>("SmallVector<int, 16>", size);
+        }
+    }
+
+    // ===========================================================
+    // 'InplaceVector<T, Capacity>': see InplaceVector.ixx
+
+    static void test_12()
+    {
+        // 'User' has no default c'tor - the elements are constructed on demand
+        InplaceVector<User, 2> users;
+
+        users.emplace_back("Hans", 30);
+        users.emplace_back("Sepp", 40);
+
+        // no heap: the vector is full
+        if (users.try_emplace_back("Franz", 50) == nullptr) {
+            std::cout << "InplaceVector is full: " << users.size() << " of " << users.capacity() << std::endl;
+        }
+
+        try {
+            users.emplace_back("Franz", 50);
+        }
+        catch (const std::bad_alloc&) {
+            std::cout << "std::bad_alloc: no space left" << std::endl;
+        }
+
+        for (const auto& user : users) {
+            user.print();
+        }
+    }
+
+    // trivial types: usable in constant expressions
+    static constexpr int sumOfSquares(int count)
+    {
+        InplaceVector<int, 16> squares;
+
+        for (int i{ 1 }; i <= count; ++i) {
+            squares.push_back(i * i);
+        }
+
+        return std::accumulate(squares.begin(), squares.end(), 0);
+    }
+
+    static void test_13()
+    {
+        static_assert(sumOfSquares(10) == 385);
+
+        constexpr InplaceVector<int, 4> numbers{ 1, 2, 3 };
+        static_assert(numbers.size() == 3 && numbers.back() == 3);
+
+        std::cout << "sizeof(InplaceVector<int, 16>): " << sizeof(InplaceVector<int, 16>) << std::endl;
+    }
+
+    // ===========================================================
+    // object pools: see ObjectPool.ixx
+
+    static void test_14()
+    {
+        ObjectPool<User, 4> pool;
+
+        User* hans{ pool.acquire("Hans", 30) };
+        User* sepp{ pool.acquire("Sepp", 40) };
+        hans->print();
+        sepp->print();
+
+        // the slot of 'Hans' is reused
+        pool.release(hans);
+        User* franz{ pool.acquire("Franz", 50) };
+        std::cout << "Slot reused: " << std::boolalpha << (static_cast<void*>(franz) == static_cast<void*>(hans))
+                  << std::noboolalpha << ", Slabs: " << pool.slabs() << ", In use: " << pool.inUse() << std::endl;
+
+        pool.release(franz);
+        pool.release(sepp);
+
+        // 'std::unique_ptr' with a pool deleter: the d'tor returns the object to the pool
         {
-            T* ptr{ m_data + m_size };
-            new (ptr) T{ std::move(value) };
-            ++m_size;
+            auto user{ pool.makeUnique("Anton", 60) };
+            user->print();
         }
 
-        void pop_back() {
+        // shared by all threads of the process
+        auto user{ ThreadCachingObjectPool<User>::makeUnique("Berta", 70) };
+        user->print();
+        std::cout << "sizeof(ThreadCachingObjectPool<User>::UniquePtr): " << sizeof(user) << std::endl;
+    }
+
+    // ===========================================================
+    // benchmark: churn - a random object of a set of living objects
+    // is destroyed and replaced by a new object
+
+    constexpr size_t ChurnOperations{ 4'000'000 };
+
+    // best of 'Rounds' rounds, see 'measureGrowth'
+    template <typename TChurn>
+    static void measureChurn(std::string_view name, const std::vector<size_t>& victims, TChurn churn)
+    {
+        double nanoseconds{ std::numeric_limits<double>::max() };
+
+        for (size_t round{}; round != Rounds; ++round) {
+
+            const auto begin{ std::chrono::steady_clock::now() };
+
+            for (size_t victim : victims) {
+                churn(victim);
+            }
+
+            const auto end{ std::chrono::steady_clock::now() };
+
+            const double elapsed{
+                static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count())
+                / static_cast<double>(victims.size())
+            };
 
-            --m_size;
-            m_data[m_size].~T();
+            nanoseconds = std::min(nanoseconds, elapsed);
         }
-    };
 
-    static void test_07()
+        std::println("  {:<32} {:8.2f} ns/operation", name, nanoseconds);
+    }
+
+    static void test_15_benchmark()
     {
-        VectorEx<User> vec;
+        isVerbose = false;
 
-        for (int i{}; i < 5; ++i) {
-            vec.push_back(User{ "Sepp", 40 });
+        std::mt19937 generator{ 42 };
+
+        for (size_t living : { 100, 10'000, 1'000'000 }) {
+
+            std::println("Living objects: {}", living);
+
+            // random order: precomputed, the generator isn't measured
+            std::uniform_int_distribution<size_t> distribution{ 0, living - 1 };
+            std::vector<size_t> victims(ChurnOperations);
+            std::generate(victims.begin(), victims.end(), [&] { return distribution(generator); });
+
+            {
+                std::vector<User*> users(living);
+                for (auto& user : users) {
+                    user = new User{ "Sepp", 40 };
+                }
+
+                measureChurn("new / delete", victims, [&](size_t victim) {
+                    delete users[victim];
+                    users[victim] = new User{ "Hans", static_cast<int>(victim) };
+                });
+
+                for (auto* user : users) {
+                    delete user;
+                }
+            }
+
+            {
+                std::vector<std::unique_ptr<User>> users(living);
+                for (auto& user : users) {
+                    user = std::make_unique<User>("Sepp", 40);
+                }
+
+                measureChurn("std::make_unique", victims, [&](size_t victim) {
+                    users[victim] = std::make_unique<User>("Hans", static_cast<int>(victim));
+                });
+            }
+
+            {
+                ObjectPool<User> pool;
+                std::vector<User*> users(living);
+                for (auto& user : users) {
+                    user = pool.acquire("Sepp", 40);
+                }
+
+                measureChurn("ObjectPool acquire / release", victims, [&](size_t victim) {
+                    pool.release(users[victim]);
+                    users[victim] = pool.acquire("Hans", static_cast<int>(victim));
+                });
+
+                for (auto* user : users) {
+                    pool.release(user);
+                }
+            }
+
+            {
+                ObjectPool<User> pool;
+                std::vector<ObjectPool<User>::UniquePtr> users;
+                users.reserve(living);
+                for (size_t i{}; i != living; ++i) {
+                    users.push_back(pool.makeUnique("Sepp", 40));
+                }
+
+                // the old object is released after the new object has been acquired
+                measureChurn("ObjectPool makeUnique", victims, [&](size_t victim) {
+                    users[victim] = pool.makeUnique("Hans", static_cast<int>(victim));
+                });
+
+                users.clear();
+            }
+
+            {
+                using Pool = ThreadCachingObjectPool<User>;
+
+                std::vector<Pool::UniquePtr> users;
+                users.reserve(living);
+                for (size_t i{}; i != living; ++i) {
+                    users.push_back(Pool::makeUnique("Sepp", 40));
+                }
+
+                measureChurn("ThreadCachingObjectPool", victims, [&](size_t victim) {
+                    users[victim] = Pool::makeUnique("Hans", static_cast<int>(victim));
+                });
+            }
         }
+
+        isVerbose = true;
     }
 }
 
@@ -189,6 +560,14 @@ void main_placement_new()
     test_05();
     test_06();
     test_07();
+    test_08();
+    test_09_benchmark();
+    test_10();
+    test_11_benchmark();
+    test_12();
+    test_13();
+    test_14();
+    test_15_benchmark();
 }
 
 // =====================================================================================
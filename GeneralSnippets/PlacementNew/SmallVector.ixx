@@ -0,0 +1,431 @@
+// =====================================================================================
+// SmallVector.ixx // Vector with inline Storage for a small Number of Elements
+// =====================================================================================
+
+export module modern_cpp:small_vector;
+
+import std;
+
+import :vector_ex;
+
+// Most vectors hold only a few elements, nevertheless 'std::vector' allocates its
+// buffer on the heap. 'SmallVector<T, N>' reserves raw memory for N elements
+// within the object itself - the elements are constructed there with placement new.
+// Only if the vector grows beyond N elements, the elements are relocated into a
+// buffer on the heap ("spill"), from then on the vector behaves like 'std::vector'.
+
+namespace PlacementNew {
+
+    template <typename T, size_t N, typename TAllocator = std::allocator<T>>
+    class SmallVector
+    {
+        static_assert(N > 0, "SmallVector: inline capacity must not be zero");
+
+    public:
+        using value_type = T;
+        using allocator_type = TAllocator;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using iterator = T*;
+        using const_iterator = const T*;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        static constexpr size_t InlineCapacity{ N };
+
+    private:
+        using AllocatorTraits = std::allocator_traits<TAllocator>;
+
+        T*         m_data;
+        size_t     m_size;
+        size_t     m_capacity;
+        TAllocator m_allocator;
+
+        alignas(T) std::byte m_buffer[N * sizeof(T)];
+
+    public:
+        // c'tors / d'tor
+        SmallVector() : SmallVector{ TAllocator{} } {}
+
+        explicit SmallVector(const TAllocator& allocator)
+            : m_data{ inlineData() }, m_size{}, m_capacity{ N }, m_allocator{ allocator }
+        {}
+
+        SmallVector(size_t count, const T& value, const TAllocator& allocator = TAllocator{})
+            : SmallVector{ allocator }
+        {
+            resize(count, value);
+        }
+
+        SmallVector(std::initializer_list<T> values, const TAllocator& allocator = TAllocator{})
+            : SmallVector{ allocator }
+        {
+            append(values.begin(), values.end());
+        }
+
+        template <std::input_iterator TIterator>
+        SmallVector(TIterator first, TIterator last, const TAllocator& allocator = TAllocator{})
+            : SmallVector{ allocator }
+        {
+            append(first, last);
+        }
+
+        SmallVector(const SmallVector& other)
+            : SmallVector{ AllocatorTraits::select_on_container_copy_construction(other.m_allocator) }
+        {
+            append(other.begin(), other.end());
+        }
+
+        // a heap buffer is taken over, inline elements have to be relocated
+        SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+            : SmallVector{ other.m_allocator }
+        {
+            takeElements(other);
+        }
+
+        ~SmallVector()
+        {
+            clear();
+            release();
+        }
+
+        // assignment: strong exception guarantee
+        SmallVector& operator= (const SmallVector& other) {
+
+            if (this != &other) {
+                SmallVector copy{ other.begin(), other.end(), m_allocator };
+                *this = std::move(copy);
+            }
+
+            return *this;
+        }
+
+        SmallVector& operator= (SmallVector&& other) noexcept(
+            std::is_nothrow_move_constructible_v<T> &&
+            (AllocatorTraits::propagate_on_container_move_assignment::value || AllocatorTraits::is_always_equal::value))
+        {
+            if (this == &other) {
+                return *this;
+            }
+
+            clear();
+
+            constexpr bool Propagate{ AllocatorTraits::propagate_on_container_move_assignment::value };
+
+            if (!other.isInline() && (Propagate || m_allocator == other.m_allocator)) {
+                release();
+                if constexpr (Propagate) {
+                    m_allocator = other.m_allocator;
+                }
+                takeElements(other);
+            }
+            else {
+                // the elements of 'other' are relocated, 'other' keeps its buffer
+                reserve(other.m_size);
+                uninitializedRelocate(other.m_data, other.m_size, m_data);
+                m_size = std::exchange(other.m_size, 0);
+            }
+
+            return *this;
+        }
+
+        SmallVector& operator= (std::initializer_list<T> values) {
+            *this = SmallVector{ values, m_allocator };
+            return *this;
+        }
+
+        // getter
+        size_t size() const { return m_size; }
+        size_t capacity() const { return m_capacity; }
+        bool empty() const { return m_size == 0; }
+
+        // elements are stored in the object itself, no heap buffer
+        bool isInline() const { return m_data == inlineData(); }
+
+        T* data() { return m_data; }
+        const T* data() const { return m_data; }
+
+        TAllocator get_allocator() const { return m_allocator; }
+
+        // element access
+        T& operator[] (size_t index) { return m_data[index]; }
+        const T& operator[] (size_t index) const { return m_data[index]; }
+
+        T& at(size_t index) {
+            checkIndex(index);
+            return m_data[index];
+        }
+
+        const T& at(size_t index) const {
+            checkIndex(index);
+            return m_data[index];
+        }
+
+        T& front() { return m_data[0]; }
+        const T& front() const { return m_data[0]; }
+
+        T& back() { return m_data[m_size - 1]; }
+        const T& back() const { return m_data[m_size - 1]; }
+
+        // iterators
+        iterator begin() { return m_data; }
+        iterator end() { return m_data + m_size; }
+        const_iterator begin() const { return m_data; }
+        const_iterator end() const { return m_data + m_size; }
+        const_iterator cbegin() const { return m_data; }
+        const_iterator cend() const { return m_data + m_size; }
+
+        reverse_iterator rbegin() { return reverse_iterator{ end() }; }
+        reverse_iterator rend() { return reverse_iterator{ begin() }; }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator{ end() }; }
+        const_reverse_iterator rend() const { return const_reverse_iterator{ begin() }; }
+
+        // public interface
+        void push_back(const T& value) { emplace_back(value); }
+
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+
+        template <typename... TArgs>
+        T& emplace_back(TArgs&&... args)
+        {
+            if (m_size == m_capacity) {
+                growAndEmplace(std::forward<TArgs>(args)...);
+            }
+            else {
+                ::new (static_cast<void*>(m_data + m_size)) T(std::forward<TArgs>(args)...);
+            }
+
+            ++m_size;
+            return m_data[m_size - 1];
+        }
+
+        template <typename... TArgs>
+        iterator emplace(const_iterator position, TArgs&&... args)
+        {
+            const size_t index{ static_cast<size_t>(position - cbegin()) };
+
+            if (index == m_size) {
+                emplace_back(std::forward<TArgs>(args)...);
+                return m_data + index;
+            }
+
+            // the arguments may refer to an element of this vector
+            T value(std::forward<TArgs>(args)...);
+
+            if (m_size == m_capacity) {
+                reallocate(nextCapacity(m_size + 1));
+            }
+
+            // shift the tail by one position: the last element is moved into raw memory
+            ::new (static_cast<void*>(m_data + m_size)) T(std::move(m_data[m_size - 1]));
+            ++m_size;
+
+            std::move_backward(m_data + index, m_data + m_size - 2, m_data + m_size - 1);
+            m_data[index] = std::move(value);
+
+            return m_data + index;
+        }
+
+        iterator insert(const_iterator position, const T& value) { return emplace(position, value); }
+
+        iterator insert(const_iterator position, T&& value) { return emplace(position, std::move(value)); }
+
+        iterator erase(const_iterator position) { return erase(position, position + 1); }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            T* pos{ m_data + (first - cbegin()) };
+
+            if (first != last) {
+                T* newEnd{ std::move(pos + (last - first), end(), pos) };
+                std::destroy(newEnd, end());
+                m_size = static_cast<size_t>(newEnd - m_data);
+            }
+
+            return pos;
+        }
+
+        void pop_back() {
+
+            --m_size;
+            m_data[m_size].~T();
+        }
+
+        void clear() {
+            std::destroy_n(m_data, m_size);
+            m_size = 0;
+        }
+
+        void reserve(size_t capacity) {
+            if (capacity > m_capacity) {
+                reallocate(capacity);
+            }
+        }
+
+        void resize(size_t size)
+        {
+            if (size <= m_size) {
+                std::destroy(m_data + size, m_data + m_size);
+            }
+            else {
+                reserve(size);
+                std::uninitialized_value_construct(m_data + m_size, m_data + size);
+            }
+
+            m_size = size;
+        }
+
+        void resize(size_t size, const T& value)
+        {
+            if (size <= m_size) {
+                std::destroy(m_data + size, m_data + m_size);
+            }
+            else if (size <= m_capacity) {
+                std::uninitialized_fill(m_data + m_size, m_data + size, value);
+            }
+            else {
+                // 'value' may refer to an element of this vector
+                const T copy{ value };
+                reallocate(size);
+                std::uninitialized_fill(m_data + m_size, m_data + size, copy);
+            }
+
+            m_size = size;
+        }
+
+        // moves the elements back into the inline storage, if possible
+        void shrink_to_fit()
+        {
+            if (isInline() || m_size == m_capacity) {
+                return;
+            }
+
+            if (m_size > N) {
+                reallocate(m_size);
+                return;
+            }
+
+            uninitializedRelocate(m_data, m_size, inlineData());
+            release();
+        }
+
+        void swap(SmallVector& other)
+        {
+            SmallVector tmp{ std::move(other) };
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+
+        friend bool operator== (const SmallVector& lhs, const SmallVector& rhs) {
+            return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+        }
+
+    private:
+        T* inlineData() { return reinterpret_cast<T*>(m_buffer); }
+        const T* inlineData() const { return reinterpret_cast<const T*>(m_buffer); }
+
+        void checkIndex(size_t index) const {
+            if (index >= m_size) {
+                throw std::out_of_range{ "SmallVector: index out of range" };
+            }
+        }
+
+        size_t nextCapacity(size_t required) const {
+            return std::max(2 * m_capacity, required);
+        }
+
+        template <typename TIterator>
+        void append(TIterator first, TIterator last)
+        {
+            if constexpr (std::forward_iterator<TIterator>) {
+                reserve(m_size + static_cast<size_t>(std::distance(first, last)));
+            }
+
+            for (; first != last; ++first) {
+                emplace_back(*first);
+            }
+        }
+
+        // precondition: this vector is empty and uses its inline storage,
+        // 'other' is empty afterwards
+        void takeElements(SmallVector& other)
+        {
+            if (other.isInline()) {
+                uninitializedRelocate(other.m_data, other.m_size, m_data);
+                m_size = std::exchange(other.m_size, 0);
+            }
+            else {
+                m_data = std::exchange(other.m_data, other.inlineData());
+                m_size = std::exchange(other.m_size, 0);
+                m_capacity = std::exchange(other.m_capacity, N);
+            }
+        }
+
+        // releases the heap buffer - the elements have been relocated or destroyed before
+        void release() noexcept
+        {
+            if (!isInline()) {
+                AllocatorTraits::deallocate(m_allocator, m_data, m_capacity);
+                m_data = inlineData();
+                m_capacity = N;
+            }
+        }
+
+        void replaceBuffer(T* data, size_t capacity) noexcept
+        {
+            release();
+            m_data = data;
+            m_capacity = capacity;
+        }
+
+        void reallocate(size_t capacity)
+        {
+            T* data{ AllocatorTraits::allocate(m_allocator, capacity) };
+
+            try {
+                uninitializedRelocate(m_data, m_size, data);
+            }
+            catch (...) {
+                AllocatorTraits::deallocate(m_allocator, data, capacity);
+                throw;
+            }
+
+            replaceBuffer(data, capacity);
+        }
+
+        // slow path of 'emplace_back': the new element is created before
+        // the existing elements are relocated (see 'VectorEx')
+        template <typename... TArgs>
+        void growAndEmplace(TArgs&&... args)
+        {
+            const size_t capacity{ nextCapacity(m_size + 1) };
+            T* data{ AllocatorTraits::allocate(m_allocator, capacity) };
+
+            try {
+                ::new (static_cast<void*>(data + m_size)) T(std::forward<TArgs>(args)...);
+
+                try {
+                    uninitializedRelocate(m_data, m_size, data);
+                }
+                catch (...) {
+                    std::destroy_at(data + m_size);
+                    throw;
+                }
+            }
+            catch (...) {
+                AllocatorTraits::deallocate(m_allocator, data, capacity);
+                throw;
+            }
+
+            replaceBuffer(data, capacity);
+        }
+    };
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
@@ -0,0 +1,149 @@
+// =====================================================================================
+// VectorEx.ixx // Dynamic Array built upon Placement New
+// =====================================================================================
+
+export module modern_cpp:vector_ex;
+
+import std;
+
+import :growth_vector;
+
+namespace PlacementNew {
+
+    // relocation, element access, move and swap are shared with
+    // 'Allocator::GrowthVector' (GrowthVector.ixx)
+    using Allocator::uninitializedRelocate;
+
+    // =================================================================================
+
+    template <typename T>
+    class VectorEx : public Allocator::VectorBase<T>
+    {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "VectorEx: over-aligned types are not supported by 'malloc'");
+
+    public:
+        static constexpr size_t InitialCapacity{ 10 };
+
+    private:
+        using Base = Allocator::VectorBase<T>;
+        using Base::m_data;
+        using Base::m_size;
+        using Base::m_capacity;
+
+    public:
+        // c'tors / d'tor
+        VectorEx() = default;
+
+        VectorEx(std::initializer_list<T> values) : VectorEx{} {
+            reserve(values.size());
+            for (const T& value : values) {
+                emplace_back(value);
+            }
+        }
+
+        VectorEx(const VectorEx& other) : VectorEx{} {
+            reserve(other.m_size);
+            std::uninitialized_copy_n(other.m_data, other.m_size, m_data);
+            m_size = other.m_size;
+        }
+
+        VectorEx(VectorEx&& other) noexcept : Base{ std::move(other) } {}
+
+        ~VectorEx()
+        {
+            Base::clear();
+            std::free(m_data);
+        }
+
+        // copy-and-swap: strong exception guarantee
+        VectorEx& operator= (VectorEx other) noexcept {
+            Base::swap(other);
+            return *this;
+        }
+
+        // public interface
+        void push_back(const T& value) { emplace_back(value); }
+
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+
+        template <typename... TArgs>
+        T& emplace_back(TArgs&&... args)
+        {
+            if (m_size == m_capacity) {
+                growAndEmplace(std::forward<TArgs>(args)...);
+            }
+            else {
+                ::new (static_cast<void*>(m_data + m_size)) T(std::forward<TArgs>(args)...);
+            }
+
+            ++m_size;
+            return m_data[m_size - 1];
+        }
+
+        void reserve(size_t capacity)
+        {
+            if (capacity <= m_capacity) {
+                return;
+            }
+
+            T* data{ allocate(capacity) };
+
+            try {
+                uninitializedRelocate(m_data, m_size, data);
+            }
+            catch (...) {
+                std::free(data);
+                throw;
+            }
+
+            replaceBuffer(data, capacity);
+        }
+
+    private:
+        // geometric growth: every element is relocated only a constant number of times on average
+        size_t nextCapacity() const {
+            return std::max(2 * m_capacity, InitialCapacity);
+        }
+
+        static T* allocate(size_t capacity) {
+
+            if (capacity > std::numeric_limits<size_t>::max() / sizeof(T)) {
+                throw std::length_error{ "VectorEx: capacity too large" };
+            }
+
+            void* memory{ std::malloc(sizeof(T) * capacity) };
+            if (memory == nullptr) {
+                throw std::bad_alloc{};
+            }
+
+            return static_cast<T*>(memory);
+        }
+
+        void replaceBuffer(T* data, size_t capacity) noexcept {
+            std::free(m_data);
+            m_data = data;
+            m_capacity = capacity;
+        }
+
+        template <typename... TArgs>
+        void growAndEmplace(TArgs&&... args)
+        {
+            const size_t capacity{ nextCapacity() };
+            T* data{ allocate(capacity) };
+
+            try {
+                Base::relocateAndEmplace(data, std::forward<TArgs>(args)...);
+            }
+            catch (...) {
+                std::free(data);
+                throw;
+            }
+
+            replaceBuffer(data, capacity);
+        }
+    };
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
@@ -22,6 +22,7 @@ int main()
         //main_accumulate();
         //main_algorithms();
         //main_allocator();
+        //main_allocator_benchmark();
         //main_any();
         //main_argument_dependent_name_lookup();
         //main_array();
@@ -46,6 +47,9 @@ int main()
         //main_default_initialization();
         //main_erase_remove_idiom();
         //main_expression_templates();
+        //main_expression_templates_sparse();
+        //main_expression_templates_transpose();
+        //main_expression_templates_matrix_file();
         //main_exception_safety();
         //main_explicit_keyword();
         //main_folding();
@@ -87,6 +91,7 @@ int main()
         //main_structured_binding();
         //main_templates_class_basics_01();
         //main_templates_class_basics_02();
+        //main_templates_class_basics_03();
         //main_templates_function_basics();
         //main_templates_template_parameter_01();
         //main_templates_template_parameter_02();
@@ -96,6 +101,14 @@ int main()
         //main_tuple(); 
         //main_two_phase_name_lookup();
         //main_type_erasure();
+        //main_type_erasure_sbo();
+        //main_type_erasure_static_vtable();
+        //main_type_erasure_poly_collection();
+        //main_type_erasure_dispatch_benchmark();
+        //main_type_erasure_arena();
+        //main_type_erasure_concurrent();
+        //main_type_erasure_catalog();
+        //main_type_erasure_index();
         //main_type_traits();
         //main_unique_ptr();
         //main_variadic_templates_introduction();
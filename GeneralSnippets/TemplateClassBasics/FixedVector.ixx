@@ -0,0 +1,187 @@
+// =====================================================================================
+// FixedVector.ixx // Aligned Small Vector Math Type with Fold-based Unrolling
+// =====================================================================================
+
+export module modern_cpp:fixed_vector;
+
+import std;
+
+namespace ClassTemplatesBasics {
+
+    // width of a SIMD register in bytes (AVX: 256 bit)
+    constexpr size_t SimdWidth{ 32 };
+
+    // number of elements of type T, that fit into one SIMD register
+    template <typename T>
+    constexpr size_t SimdLanes{ SimdWidth / sizeof(T) > 0 ? SimdWidth / sizeof(T) : 1 };
+
+    // DIM rounded up to a multiple of the SIMD register width
+    template <typename T, size_t DIM>
+    constexpr size_t PaddedDim{ (DIM + SimdLanes<T> - 1) / SimdLanes<T> * SimdLanes<T> };
+
+    template <typename T, size_t DIM>
+        requires std::is_arithmetic_v<T> && (DIM > 0)
+    class alignas(SimdWidth) FixedVector
+    {
+    public:
+        static constexpr size_t Lanes{ SimdLanes<T> };
+        static constexpr size_t Padded{ PaddedDim<T, DIM> };
+
+    private:
+        // elements [DIM, Padded) are padding and always zero
+        std::array<T, Padded> m_data;
+
+        using AllIndices = std::make_index_sequence<Padded>;
+        using DimIndices = std::make_index_sequence<DIM>;
+
+    public:
+        // c'tors
+        constexpr FixedVector() : m_data{} {}
+
+        template <typename... TArgs>
+            requires (sizeof... (TArgs) == DIM) && (std::is_convertible_v<TArgs, T> && ...)
+        constexpr FixedVector(TArgs... args) : m_data{ static_cast<T>(args) ... } {}
+
+        // getter / setter
+        static constexpr size_t size() { return DIM; }
+
+        constexpr void set(size_t idx, const T& elem) { m_data[idx] = elem; }
+
+        constexpr T get(size_t idx) const { return m_data[idx]; }
+
+        constexpr T& operator[] (size_t idx) { return m_data[idx]; }
+        constexpr const T& operator[] (size_t idx) const { return m_data[idx]; }
+
+        constexpr T* data() { return m_data.data(); }
+        constexpr const T* data() const { return m_data.data(); }
+
+        void print(std::ostream& os) const {
+            for (size_t i{}; i != DIM; ++i) {
+                os << m_data[i] << ' ';
+            }
+            os << '\n';
+        }
+
+        // element-wise operations - padding stays zero, since 0 op 0 == 0
+        friend constexpr FixedVector operator+ (const FixedVector& lhs, const FixedVector& rhs) {
+            return zip(lhs, rhs, std::plus<T>{}, AllIndices{});
+        }
+
+        friend constexpr FixedVector operator- (const FixedVector& lhs, const FixedVector& rhs) {
+            return zip(lhs, rhs, std::minus<T>{}, AllIndices{});
+        }
+
+        friend constexpr FixedVector operator* (const FixedVector& lhs, const FixedVector& rhs) {
+            return zip(lhs, rhs, std::multiplies<T>{}, AllIndices{});
+        }
+
+        // 0 / 0 is not defined: division is restricted to the DIM elements
+        friend constexpr FixedVector operator/ (const FixedVector& lhs, const FixedVector& rhs) {
+            return zip(lhs, rhs, std::divides<T>{}, DimIndices{});
+        }
+
+        // inf * 0 and NaN * 0 are NaN: scaling is restricted to the DIM elements
+        friend constexpr FixedVector operator* (const FixedVector& vec, const T& scalar) {
+            return map(vec, [scalar](const T& elem) { return elem * scalar; }, DimIndices{});
+        }
+
+        friend constexpr FixedVector operator* (const T& scalar, const FixedVector& vec) {
+            return vec * scalar;
+        }
+
+        friend constexpr FixedVector operator- (const FixedVector& vec) {
+            return map(vec, std::negate<T>{}, AllIndices{});
+        }
+
+        constexpr FixedVector& operator+= (const FixedVector& other) { return *this = *this + other; }
+        constexpr FixedVector& operator-= (const FixedVector& other) { return *this = *this - other; }
+        constexpr FixedVector& operator*= (const T& scalar) { return *this = *this * scalar; }
+
+        friend constexpr bool operator== (const FixedVector& lhs, const FixedVector& rhs) {
+            return lhs.m_data == rhs.m_data;
+        }
+
+        // reductions
+        constexpr T sum() const {
+            return reduce([this](size_t idx) { return m_data[idx]; });
+        }
+
+        friend constexpr T dot(const FixedVector& lhs, const FixedVector& rhs) {
+            return reduce([&](size_t idx) { return lhs.m_data[idx] * rhs.m_data[idx]; });
+        }
+
+        constexpr T squaredNorm() const { return dot(*this, *this); }
+
+        T norm() const { return static_cast<T>(std::sqrt(squaredNorm())); }
+
+        constexpr T normL1() const {
+            return map(*this, [](const T& elem) { return elem < T{} ? -elem : elem; }, AllIndices{}).sum();
+        }
+
+        constexpr T normMax() const {
+            return [this] <size_t... I> (std::index_sequence<I...>) {
+                T result{};
+                ((result = std::max(result, m_data[I] < T{} ? -m_data[I] : m_data[I])), ...);
+                return result;
+            } (AllIndices{});
+        }
+
+        // cross product - only defined for three-dimensional vectors
+        friend constexpr FixedVector cross(const FixedVector& lhs, const FixedVector& rhs)
+            requires (DIM == 3)
+        {
+            return FixedVector{
+                lhs[1] * rhs[2] - lhs[2] * rhs[1],
+                lhs[2] * rhs[0] - lhs[0] * rhs[2],
+                lhs[0] * rhs[1] - lhs[1] * rhs[0]
+            };
+        }
+
+    private:
+        // fold expressions over an index sequence: fully unrolled, no recursion, no branches
+        template <typename TFunc, size_t... I>
+        static constexpr FixedVector zip(const FixedVector& lhs, const FixedVector& rhs,
+            TFunc func, std::index_sequence<I...>)
+        {
+            FixedVector result{};
+            ((result.m_data[I] = func(lhs.m_data[I], rhs.m_data[I])), ...);
+            return result;
+        }
+
+        template <typename TFunc, size_t... I>
+        static constexpr FixedVector map(const FixedVector& vec, TFunc func, std::index_sequence<I...>)
+        {
+            FixedVector result{};
+            ((result.m_data[I] = func(vec.m_data[I])), ...);
+            return result;
+        }
+
+        // adds the SIMD-width chunks vertically (one register wide accumulator),
+        // followed by a horizontal sum of the lanes
+        template <typename TElem>
+        static constexpr T reduce(TElem elem)
+        {
+            std::array<T, Lanes> acc{};
+
+            [&] <size_t... Chunk> (std::index_sequence<Chunk...>) {
+                ((addChunk<Chunk>(acc, elem)), ...);
+            } (std::make_index_sequence<Padded / Lanes>{});
+
+            return [&] <size_t... Lane> (std::index_sequence<Lane...>) {
+                return (acc[Lane] + ...);
+            } (std::make_index_sequence<Lanes>{});
+        }
+
+        template <size_t Chunk, typename TElem>
+        static constexpr void addChunk(std::array<T, Lanes>& acc, TElem elem)
+        {
+            [&] <size_t... Lane> (std::index_sequence<Lane...>) {
+                ((acc[Lane] += elem(Chunk * Lanes + Lane)), ...);
+            } (std::make_index_sequence<Lanes>{});
+        }
+    };
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
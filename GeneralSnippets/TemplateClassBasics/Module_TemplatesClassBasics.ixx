@@ -8,6 +8,7 @@ import std;
 
 export void main_templates_class_basics_01();
 export void main_templates_class_basics_02();
+export void main_templates_class_basics_03();
 
 // =====================================================================================
 // End-of-File
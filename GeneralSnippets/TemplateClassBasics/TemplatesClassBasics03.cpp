@@ -0,0 +1,179 @@
+// =====================================================================================
+// TemplatesClassBasics03.cpp // Class Templates Basics 03 // FixedVector Math Type
+// =====================================================================================
+
+module;
+
+#include "../ScopedTimer/ScopedTimer.h"
+
+module modern_cpp:templates_class_basics;
+
+import :fixed_vector;
+
+namespace ClassTemplatesBasics_03 {
+
+    using namespace ClassTemplatesBasics;
+
+    static void test_01()
+    {
+        FixedVector<double, 3> a{ 1.0, 2.0, 3.0 };
+        FixedVector<double, 3> b{ 4.0, 5.0, 6.0 };
+
+        (a + b).print(std::cout);               // 5 7 9
+        (a - b).print(std::cout);               // -3 -3 -3
+        (a * b).print(std::cout);               // 4 10 18
+        (b / a).print(std::cout);               // 4 2.5 2
+        (2.0 * a).print(std::cout);             // 2 4 6
+        cross(a, b).print(std::cout);           // -3 6 -3
+
+        std::cout << "dot(a, b):  " << dot(a, b) << std::endl;        // 32
+        std::cout << "a.norm():   " << a.norm() << std::endl;         // 3.74166
+        std::cout << "a.normL1(): " << a.normL1() << std::endl;       // 6
+        std::cout << "(-b).normMax(): " << (-b).normMax() << std::endl;  // 6
+    }
+
+    static void test_02()
+    {
+        // storage is padded to the SIMD register width (32 bytes) and aligned accordingly
+        static_assert(sizeof(FixedVector<double, 2>) == 32);
+        static_assert(sizeof(FixedVector<double, 3>) == 32);
+        static_assert(sizeof(FixedVector<double, 5>) == 64);
+        static_assert(sizeof(FixedVector<float, 16>) == 64);
+        static_assert(alignof(FixedVector<float, 3>) == 32);
+
+        // all operations are constexpr
+        constexpr FixedVector<int, 4> a{ 1, 2, 3, 4 };
+        constexpr FixedVector<int, 4> b{ 5, 6, 7, 8 };
+        static_assert(dot(a, b) == 70);
+        static_assert((a + b).sum() == 36);
+        static_assert((-a).normMax() == 4);
+
+        FixedVector<float, 5> c{ 1.0f, 2.0f, 3.0f, 4.0f, 5.0f };
+        std::cout << "size: " << c.size() << ", padded: " << c.Padded << std::endl;  // 5, 8
+        std::cout << "Aligned: " << std::boolalpha
+            << (reinterpret_cast<std::uintptr_t>(c.data()) % SimdWidth == 0) << std::endl;
+
+        // the padding stays zero, even when scaled by infinity (inf * 0 would be NaN)
+        FixedVector<float, 5> d{ c * std::numeric_limits<float>::infinity() };
+        std::cout << "Padding: " << d[5] << ' ' << d[6] << ' ' << d[7] << std::endl;  // 0 0 0
+    }
+
+    // =================================================================================
+    // versions based on std::vector (see Exercises 'Expression Templates')
+
+    template <typename T>
+    T scalarProduct(const std::vector<T>& a, const std::vector<T>& b)
+    {
+        T product{};
+        for (size_t i{}; i != a.size(); ++i) {
+            product += (a[i]) * (b[i]);
+        }
+        return product;
+    }
+
+    // primary template
+    template <size_t N, typename T>
+    class ScalarProduct {
+    public:
+        static inline T result(
+            const typename std::vector<T>::const_iterator a,
+            const typename std::vector<T>::const_iterator b) {
+            return (*a) * (*b) + ScalarProduct<N - 1, T>::result(a + 1, b + 1);
+        }
+    };
+
+    // partial specialization to terminate recursion
+    template <typename T>
+    class ScalarProduct<1, T> {
+    public:
+        static inline T result(
+            const typename std::vector<T>::const_iterator a,
+            const typename std::vector<T>::const_iterator b) {
+            return (*a) * (*b);
+        }
+    };
+
+    constexpr size_t NumVectors{ 1000 };
+    constexpr size_t Repetitions{ 10000 };
+
+    template <size_t DIM>
+    static void benchmarkDot()
+    {
+        std::cout << "DIM = " << DIM << ':' << std::endl;
+
+        std::vector<std::vector<double>> as(NumVectors, std::vector<double>(DIM));
+        std::vector<std::vector<double>> bs(NumVectors, std::vector<double>(DIM));
+        std::vector<FixedVector<double, DIM>> fas(NumVectors);
+        std::vector<FixedVector<double, DIM>> fbs(NumVectors);
+
+        for (size_t n{}; n != NumVectors; ++n) {
+            for (size_t i{}; i != DIM; ++i) {
+                as[n][i] = static_cast<double>(n % 7 + i);
+                bs[n][i] = static_cast<double>(n % 5) - static_cast<double>(i);
+                fas[n][i] = as[n][i];
+                fbs[n][i] = bs[n][i];
+            }
+        }
+
+        {
+            std::cout << "  std::vector, loop:        ";
+            ScopedTimer watch{};
+
+            double result{};
+            for (size_t k{}; k != Repetitions; ++k) {
+                for (size_t n{}; n != NumVectors; ++n) {
+                    result += scalarProduct(as[n], bs[n]);
+                }
+            }
+            std::cout << result << " - ";
+        }
+
+        {
+            std::cout << "  std::vector, recursion:   ";
+            ScopedTimer watch{};
+
+            double result{};
+            for (size_t k{}; k != Repetitions; ++k) {
+                for (size_t n{}; n != NumVectors; ++n) {
+                    result += ScalarProduct<DIM, double>::result(as[n].cbegin(), bs[n].cbegin());
+                }
+            }
+            std::cout << result << " - ";
+        }
+
+        {
+            std::cout << "  FixedVector, fold:        ";
+            ScopedTimer watch{};
+
+            double result{};
+            for (size_t k{}; k != Repetitions; ++k) {
+                for (size_t n{}; n != NumVectors; ++n) {
+                    result += dot(fas[n], fbs[n]);
+                }
+            }
+            std::cout << result << " - ";
+        }
+    }
+
+    static void test_03_benchmark()
+    {
+        benchmarkDot<2>();
+        benchmarkDot<3>();
+        benchmarkDot<4>();
+        benchmarkDot<8>();
+        benchmarkDot<16>();
+    }
+}
+
+void main_templates_class_basics_03()
+{
+    using namespace ClassTemplatesBasics_03;
+
+    test_01();
+    test_02();
+    test_03_benchmark();
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
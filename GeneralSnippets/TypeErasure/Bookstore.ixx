@@ -0,0 +1,604 @@
+// =====================================================================================
+// Bookstore.ixx // Media Classes and Bookstore Implementations
+// =====================================================================================
+
+module;
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#define BOOKSTORE_PREFETCH
+#include <xmmintrin.h>
+#endif
+
+export module modern_cpp:bookstore;
+
+import std;
+
+import :money;
+
+namespace BookStoreMoney {
+
+    // value of the stock of one media object, the price is rounded to cents
+    inline Money stockValue(double price, size_t count)
+    {
+        return Money::fromDouble(price) * count;
+    }
+}
+
+namespace BookStoreUsingDynamicPolymorphism {
+
+    using BookStoreMoney::Money;
+    using BookStoreMoney::stockValue;
+
+    struct IMedia
+    {
+        virtual ~IMedia() = default;
+
+        virtual double getPrice() const = 0;
+        virtual size_t getCount() const = 0;
+
+        virtual void setPrice(double price) = 0;
+        virtual void setCount(size_t count) = 0;
+    };
+
+    class Book : public IMedia
+    {
+    private:
+        std::string m_author;
+        std::string m_title;
+        double      m_price;
+        size_t      m_count;
+
+    public:
+        // c'tor
+        Book(std::string author, std::string title, double price, size_t count)
+            : m_author{ std::move(author) }, m_title{ std::move(title) }, m_price{ price }, m_count{ count }
+        {}
+
+        // getter / setter
+        const std::string& getAuthor() const { return m_author; }
+        const std::string& getTitle() const { return m_title; }
+
+        // interface 'IMedia'
+        double getPrice() const override { return m_price; }
+        size_t getCount() const override { return m_count; }
+
+        void setPrice(double price) override { m_price = price; }
+        void setCount(size_t count) override { m_count = count; }
+    };
+
+    class Movie : public IMedia
+    {
+    private:
+        std::string m_title;
+        std::string m_director;
+        double      m_price;
+        size_t      m_count;
+
+    public:
+        // c'tor
+        Movie(std::string title, std::string director, double price, size_t count)
+            : m_title{ std::move(title) }, m_director{ std::move(director) }, m_price{ price }, m_count{ count }
+        { }
+
+        // getter / setter
+        const std::string& getTitle() const { return m_title; }
+        const std::string& getDirector() const { return m_director; }
+
+        // interface 'IMedia'
+        double getPrice() const override { return m_price; }
+        size_t getCount() const override { return m_count; }
+
+        void setPrice(double price) override { m_price = price; }
+        void setCount(size_t count) override { m_count = count; }
+    };
+
+    class Bookstore
+    {
+    private:
+        using Stock = std::vector<std::shared_ptr<IMedia>>;
+        using StockList = std::initializer_list<std::shared_ptr<IMedia>>;
+
+        Stock  m_stock;
+
+        // aggregates, maintained by all modifying methods
+        Money  m_totalBalance;
+        size_t m_count;
+
+    public:
+        // c'tor
+        explicit Bookstore(StockList stock) : m_stock{ stock }, m_totalBalance{}, m_count{}
+        {
+            m_totalBalance = recomputeTotalBalance();
+            m_count = recomputeCount();
+        }
+
+        // public interface - O(1), independent of the size of the stock
+        Money totalBalance() const { return m_totalBalance; }
+        size_t count() const { return m_count; }
+        size_t size() const { return m_stock.size(); }
+
+        // strong exception guarantee: the new total is computed before the stock is modified
+        void addMedia(const std::shared_ptr<IMedia>& media) {
+            const Money total{ m_totalBalance + stockValue(media->getPrice(), media->getCount()) };
+            m_stock.push_back(media);
+            m_totalBalance = total;
+            m_count += media->getCount();
+        }
+
+        void removeMedia(size_t index) {
+            const auto& media{ m_stock.at(index) };
+            m_totalBalance -= stockValue(media->getPrice(), media->getCount());
+            m_count -= media->getCount();
+            m_stock.erase(m_stock.begin() + index);
+        }
+
+        // note: prices and counts must be modified through the bookstore,
+        // a media object, that is contained more than once, breaks the aggregates
+        void setPrice(size_t index, double price) {
+            const auto& media{ m_stock.at(index) };
+            m_totalBalance += stockValue(price, media->getCount()) - stockValue(media->getPrice(), media->getCount());
+            media->setPrice(price);
+        }
+
+        void setCount(size_t index, size_t count) {
+            const auto& media{ m_stock.at(index) };
+            m_totalBalance += stockValue(media->getPrice(), count) - stockValue(media->getPrice(), media->getCount());
+            m_count = m_count - media->getCount() + count;
+            media->setCount(count);
+        }
+
+        // full scans - O(n)
+        Money recomputeTotalBalance() const {
+
+            Money total{};
+
+            for (const auto& media : m_stock) {
+                total += stockValue(media->getPrice(), media->getCount());
+            }
+
+            return total;
+        }
+
+        size_t recomputeCount() const {
+
+            size_t total{};
+
+            for (const auto& media : m_stock) {
+                total += media->getCount();
+            }
+
+            return total;
+        }
+
+        // full scan, requesting the media objects 'distance' positions ahead
+        // from memory while the current object is being processed
+        Money recomputeTotalBalancePrefetched(size_t distance) const {
+
+            Money total{};
+
+            for (size_t i{}; i != m_stock.size(); ++i) {
+
+                if (i + distance < m_stock.size()) {
+                    prefetch(m_stock[i + distance].get());
+                }
+
+                total += stockValue(m_stock[i]->getPrice(), m_stock[i]->getCount());
+            }
+
+            return total;
+        }
+
+        // exact: a sum of 'Money' values doesn't depend on the order of the operations
+        bool checkAggregates() const {
+            return m_totalBalance == recomputeTotalBalance() && m_count == recomputeCount();
+        }
+
+        // replaces every media object by the object returned from 'relocate',
+        // in iteration order - the aggregates remain valid, if 'relocate' returns copies.
+        // strong exception guarantee: the stock is modified only if all calls succeed
+        template <typename TFunc>
+        void relocateMedia(TFunc relocate) {
+
+            Stock stock;
+            stock.reserve(m_stock.size());
+
+            for (const auto& media : m_stock) {
+                stock.push_back(relocate(media));
+            }
+
+            m_stock.swap(stock);
+        }
+
+    private:
+        // the object and the following cache line: 'Book' and 'Movie' span two cache lines
+        static void prefetch([[maybe_unused]] const IMedia* media) {
+#if defined(BOOKSTORE_PREFETCH)
+            const char* address{ reinterpret_cast<const char*>(media) };
+            _mm_prefetch(address, _MM_HINT_T0);
+            _mm_prefetch(address + 64, _MM_HINT_T0);
+#endif
+        }
+    };
+}
+
+// =====================================================================================
+
+namespace BookStoreUsingTypeErasure {
+
+    using BookStoreMoney::Money;
+    using BookStoreMoney::stockValue;
+
+    // transparent hash function for string keys (catalog, secondary indexes):
+    // enables lookups with a 'std::string_view' without creating a temporary 'std::string' object
+    struct StringHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view key) const {
+            return std::hash<std::string_view>{}(key);
+        }
+    };
+
+    class Book
+    {
+    private:
+        std::string m_author;
+        std::string m_title;
+        double      m_price;
+        size_t      m_count;
+
+    public:
+        // c'tor
+        Book(std::string author, std::string title, double price, size_t count)
+            : m_author{ std::move(author) }, m_title{ std::move(title) }, m_price{ price }, m_count{ count }
+        {}
+
+        // getter / setter
+        const std::string& getAuthor() const { return m_author; }
+        const std::string& getTitle() const { return m_title; }
+
+        double getPrice() const { return m_price; }
+        size_t getCount() const { return m_count; }
+
+        void setPrice(double price) { m_price = price; }
+        void setCount(size_t count) { m_count = count; }
+    };
+
+    class Movie
+    {
+    private:
+        std::string m_title;
+        std::string m_director;
+        double      m_price;
+        size_t      m_count;
+
+    public:
+        // c'tor
+        Movie(std::string title, std::string director, double price, size_t count)
+            : m_title{ std::move(title) }, m_director{ std::move(director) }, m_price{ price }, m_count{ count }
+        { }
+
+        // getter / setter
+        const std::string& getTitle() const { return m_title; }
+        const std::string& getDirector() const { return m_director; }
+
+        double getPrice() const { return m_price; }
+        size_t getCount() const { return m_count; }
+
+        void setPrice(double price) { m_price = price; }
+        void setCount(size_t count) { m_count = count; }
+    };
+
+    template<typename T>
+    concept MediaConcept = requires (const T & m)
+    {
+        { m.getPrice() } -> std::same_as<double>;
+        { m.getCount() } -> std::same_as<size_t>;
+    };
+
+    template <typename ... TMedia>
+        requires (MediaConcept<TMedia> && ...)
+    class Bookstore
+    {
+    private:
+        using StockType = std::variant<TMedia ...>;
+        using Stock     = std::vector<StockType>;
+        using StockList = std::initializer_list<StockType>;
+
+        Stock  m_stock;
+
+        // aggregates, maintained by all modifying methods
+        Money  m_totalBalance;
+        size_t m_count;
+
+    public:
+        explicit Bookstore(StockList stock) : m_stock{ stock }, m_totalBalance{}, m_count{}
+        {
+            m_totalBalance = recomputeTotalBalance();
+            m_count = recomputeCount();
+        }
+
+        // template member method
+        template <typename T>
+            requires MediaConcept<T>
+        void addMedia(const T& media) {
+            // strong exception guarantee: the new total is computed before the stock is modified
+            const Money total{ m_totalBalance + stockValue(media.getPrice(), media.getCount()) };
+            // m_stock.push_back(StockType{ media });  // detailed notation
+            m_stock.push_back(media);                  // implicit type conversion (T => std::variant<T>)
+            m_totalBalance = total;
+            m_count += media.getCount();
+        }
+
+        // or
+        void addMediaEx(const MediaConcept auto& media) {
+            const Money total{ m_totalBalance + stockValue(media.getPrice(), media.getCount()) };
+            m_stock.push_back(media);
+            m_totalBalance = total;
+            m_count += media.getCount();
+        }
+
+        void removeMedia(size_t index) {
+            std::visit(
+                [this](const auto& element) {
+                    m_totalBalance -= stockValue(element.getPrice(), element.getCount());
+                    m_count -= element.getCount();
+                },
+                m_stock.at(index)
+            );
+            m_stock.erase(m_stock.begin() + index);
+        }
+
+        void setPrice(size_t index, double price) {
+            std::visit(
+                [&](auto& element) {
+                    m_totalBalance += stockValue(price, element.getCount()) - stockValue(element.getPrice(), element.getCount());
+                    element.setPrice(price);
+                },
+                m_stock.at(index)
+            );
+        }
+
+        void setCount(size_t index, size_t count) {
+            std::visit(
+                [&](auto& element) {
+                    m_totalBalance += stockValue(element.getPrice(), count) - stockValue(element.getPrice(), element.getCount());
+                    m_count = m_count - element.getCount() + count;
+                    element.setCount(count);
+                },
+                m_stock.at(index)
+            );
+        }
+
+        // public interface - O(1), independent of the size of the stock
+        Money totalBalance() const { return m_totalBalance; }
+        size_t count() const { return m_count; }
+        size_t size() const { return m_stock.size(); }
+
+        const StockType& at(size_t index) const { return m_stock.at(index); }
+
+        // exact: a sum of 'Money' values doesn't depend on the order of the operations
+        bool checkAggregates() const {
+            return m_totalBalance == recomputeTotalBalance() && m_count == recomputeCount();
+        }
+
+        // full scans - O(n)
+        Money recomputeTotalBalance() const {
+
+            Money total{};
+
+            for (const auto& media : m_stock) {
+
+                double price{};
+                size_t count{};
+
+                std::visit(
+                    [&](const auto& element) {
+                        price = element.getPrice();
+                        count = element.getCount();
+                    },
+                    media
+                );
+
+                total += stockValue(price, count);
+            }
+
+            return total;
+        }
+
+        size_t recomputeCount() const {
+
+            size_t total{};
+
+            for (const auto& media : m_stock) {
+
+                size_t count{};
+
+                std::visit(
+                    [&](const auto& element) {
+                        count = element.getCount();
+                    },
+                    media
+                );
+
+                total += count;
+            }
+
+            return total;
+        }
+
+        // -----------------------------------------------
+        // demonstrating std::visit with returning a value
+
+        Money totalBalanceEx() const {
+
+            Money total{};
+
+            for (const auto& media : m_stock) {
+
+                total += std::visit(
+                    [](const auto& element) {
+                        double price = element.getPrice();
+                        size_t count = element.getCount();
+                        return stockValue(price, count);
+                    },
+                    media
+                );
+            }
+
+            return total;
+        }
+
+        size_t countEx() const {
+
+            size_t total{};
+
+            for (const auto& element : m_stock) {
+
+                total += std::visit(
+                    [](const auto& element) {
+                        return element.getCount();
+                    },
+                    element
+                );
+            }
+
+            return total;
+        }
+    };
+
+    // -----------------------------------------------
+    // poly collection: one contiguous std::vector per media type
+
+    template <typename ... TMedia>
+        requires (MediaConcept<TMedia> && ...)
+    class SegregatedBookstore
+    {
+    private:
+        using StockType = std::variant<TMedia ...>;
+        using Stock     = std::tuple<std::vector<TMedia> ...>;
+        using StockList = std::initializer_list<StockType>;
+
+        Stock  m_stock;
+
+        // aggregates, maintained by all modifying methods
+        Money  m_totalBalance;
+        size_t m_count;
+
+    public:
+        explicit SegregatedBookstore(StockList stock) : m_stock{}, m_totalBalance{}, m_count{} {
+            for (const auto& media : stock) {
+                std::visit(
+                    [this](const auto& element) { addMedia(element); },
+                    media
+                );
+            }
+        }
+
+        // the media type selects the vector - there is no dispatch per element
+        template <typename T>
+            requires MediaConcept<T>
+        void addMedia(const T& media) {
+            // strong exception guarantee: the new total is computed before the stock is modified
+            const Money total{ m_totalBalance + stockValue(media.getPrice(), media.getCount()) };
+            std::get<std::vector<T>>(m_stock).push_back(media);
+            m_totalBalance = total;
+            m_count += media.getCount();
+        }
+
+        // elements are addressed by their type and their index within this type
+        template <typename T>
+        void removeMedia(size_t index) {
+            auto& vector{ std::get<std::vector<T>>(m_stock) };
+            const auto& media{ vector.at(index) };
+            m_totalBalance -= stockValue(media.getPrice(), media.getCount());
+            m_count -= media.getCount();
+            vector.erase(vector.begin() + index);
+        }
+
+        template <typename T>
+        void setPrice(size_t index, double price) {
+            auto& media{ std::get<std::vector<T>>(m_stock).at(index) };
+            m_totalBalance += stockValue(price, media.getCount()) - stockValue(media.getPrice(), media.getCount());
+            media.setPrice(price);
+        }
+
+        template <typename T>
+        void setCount(size_t index, size_t count) {
+            auto& media{ std::get<std::vector<T>>(m_stock).at(index) };
+            m_totalBalance += stockValue(media.getPrice(), count) - stockValue(media.getPrice(), media.getCount());
+            m_count = m_count - media.getCount() + count;
+            media.setCount(count);
+        }
+
+        // public interface - O(1), independent of the size of the stock
+        Money totalBalance() const { return m_totalBalance; }
+        size_t count() const { return m_count; }
+
+        size_t size() const {
+
+            return std::apply(
+                [](const auto& ... vectors) {
+                    return (vectors.size() + ...);
+                },
+                m_stock
+            );
+        }
+
+        // exact: a sum of 'Money' values doesn't depend on the order of the operations
+        bool checkAggregates() const {
+            return m_totalBalance == recomputeTotalBalance() && m_count == recomputeCount();
+        }
+
+        // full scans - O(n)
+        Money recomputeTotalBalance() const {
+
+            return std::apply(
+                [](const auto& ... vectors) {
+                    return (balanceOf(vectors) + ...);
+                },
+                m_stock
+            );
+        }
+
+        size_t recomputeCount() const {
+
+            return std::apply(
+                [](const auto& ... vectors) {
+                    return (countOf(vectors) + ...);
+                },
+                m_stock
+            );
+        }
+
+    private:
+        // tight loops over elements of one single type
+        template <typename T>
+        static Money balanceOf(const std::vector<T>& vector) {
+
+            Money total{};
+
+            for (const auto& media : vector) {
+                total += stockValue(media.getPrice(), media.getCount());
+            }
+
+            return total;
+        }
+
+        template <typename T>
+        static size_t countOf(const std::vector<T>& vector) {
+
+            size_t total{};
+
+            for (const auto& media : vector) {
+                total += media.getCount();
+            }
+
+            return total;
+        }
+    };
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
@@ -0,0 +1,262 @@
+// =====================================================================================
+// BookstoreArena.cpp // Arena-Backed Allocation of Bookstore Media Objects
+// =====================================================================================
+
+module modern_cpp:type_erasure;
+
+import :allocators;
+import :bookstore;
+import :money;
+import :perf_counter;
+
+namespace BookStoreUsingArenaAllocation {
+
+    using namespace BookStoreUsingDynamicPolymorphism;
+
+    // the arena of the allocator partition: monotonic, 'deallocate' only updates the statistics
+    using Allocator::MonotonicArena;
+    using Allocator::ArenaAllocator;
+
+    // creates media objects together with their control blocks in an arena.
+    // note: the factory must outlive all objects created by it,
+    // the destruction of a 'std::shared_ptr' accesses the control block in the arena
+    template <typename ... TMedia>
+        requires (std::is_base_of_v<IMedia, TMedia> && ...)
+    class ArenaMediaFactory
+    {
+    private:
+        std::unique_ptr<MonotonicArena> m_arena;
+
+    public:
+        // c'tor
+        explicit ArenaMediaFactory(size_t chunkSize = MonotonicArena::DefaultChunkSize)
+            : m_arena{ std::make_unique<MonotonicArena>(chunkSize) }
+        {}
+
+        // public interface
+        template <typename T, typename ... TArgs>
+        std::shared_ptr<T> create(TArgs&& ... args) {
+            return std::allocate_shared<T>(ArenaAllocator<T>{ m_arena.get() }, std::forward<TArgs>(args) ...);
+        }
+
+        // copies all media objects of the bookstore into a new arena, contiguous in iteration order.
+        // the memory of removed objects (holes in the old arena) is released.
+        // precondition: the bookstore holds the only references to the objects of this factory -
+        // neither the caller nor a removed object may refer to the old arena any more
+        void compact(Bookstore& bookstore) {
+
+            // every object (control block included) is one allocation in the arena
+            if (m_arena->stats().blocksInUse() != bookstore.size()) {
+                throw std::logic_error{ "compact: media objects are referenced outside of the bookstore" };
+            }
+
+            // one chunk for all objects
+            auto arena{ std::make_unique<MonotonicArena>(bytesAllocated() + 64) };
+
+            bookstore.relocateMedia(
+                [&](const std::shared_ptr<IMedia>& media) {
+
+                    // the old arena is released below: no one else may refer to the object
+                    if (media.use_count() != 1) {
+                        throw std::logic_error{ "compact: media object is shared" };
+                    }
+
+                    std::shared_ptr<IMedia> copy{};
+
+                    bool found{ (copyAs<TMedia>(*media, arena.get(), copy) || ...) };
+                    if (!found) {
+                        throw std::invalid_argument{ "compact: unknown media type" };
+                    }
+
+                    return copy;
+                }
+            );
+
+            // all objects of the old arena have been destroyed by 'relocateMedia'
+            m_arena = std::move(arena);
+        }
+
+        size_t bytesAllocated() const { return m_arena->stats().m_bytesAllocated; }
+
+    private:
+        // exact type match, a derived type would be sliced
+        template <typename T>
+        static bool copyAs(const IMedia& media, MonotonicArena* arena, std::shared_ptr<IMedia>& copy) {
+
+            if (typeid(media) != typeid(T)) {
+                return false;
+            }
+
+            copy = std::allocate_shared<T>(ArenaAllocator<T>{ arena }, static_cast<const T&>(media));
+            return true;
+        }
+    };
+
+    static void test_bookstore_arena_01()
+    {
+        ArenaMediaFactory<Book, Movie> factory{};
+
+        // declared after the factory: the bookstore is destroyed first
+        Bookstore bookstore{
+            factory.create<Book>("C", "Dennis Ritchie", 11.99, 12),
+            factory.create<Movie>("Spectre", "Sam Mendes", 8.99, 6),
+            factory.create<Book>("C++", "Bjarne Stroustrup", 16.99, 4)
+        };
+
+        bookstore.addMedia(factory.create<Book>("Java", "James Gosling", 17.99, 21));
+        bookstore.addMedia(factory.create<Movie>("Once upon a time in Hollywood", "Quentin Tarantino", 6.99, 3));
+        bookstore.removeMedia(1);
+
+        std::println("Total value of Bookstore: {}", bookstore.totalBalance());
+        std::println("Bytes in arena: {}", factory.bytesAllocated());
+
+        factory.compact(bookstore);
+
+        std::println("Total value of Bookstore: {}", bookstore.recomputeTotalBalance());
+        std::println("Bytes in arena: {}", factory.bytesAllocated());
+        std::println("Aggregates valid: {}", bookstore.checkAggregates());
+
+        // an object held outside of the bookstore would dangle after the compaction
+        auto kept{ factory.create<Book>("Rust", "Graydon Hoare", 29.99, 2) };
+
+        try {
+            factory.compact(bookstore);
+        }
+        catch (const std::logic_error& ex) {
+            std::println("{} (Price: {})", ex.what(), kept->getPrice());
+        }
+
+        std::println();
+    }
+
+    // =================================================================================
+
+    // number of elements visited per measurement, independent of the store size
+    constexpr size_t ElementsPerMeasurement{ 20000000 };
+
+    constexpr size_t PrefetchDistance{ 8 };
+
+    template <typename TFunc>
+    static void measureScan(std::string_view name, size_t size, TFunc scan)
+    {
+        size_t repetitions{ std::max<size_t>(ElementsPerMeasurement / size, 1) };
+
+        PerfCounter llcMisses{ PerfEvent::LastLevelCacheMisses };
+
+        Money total{ scan() };    // warm up
+
+        llcMisses.start();
+        const auto begin{ std::chrono::steady_clock::now() };
+
+        for (size_t i{}; i != repetitions; ++i) {
+            total += scan();
+        }
+
+        const auto end{ std::chrono::steady_clock::now() };
+        const auto misses{ llcMisses.stop() };
+
+        const double elements{ static_cast<double>(repetitions * size) };
+        const double nanoseconds{ std::chrono::duration<double, std::nano>{ end - begin }.count() };
+
+        std::string missesPerElement{ "-" };
+        if (misses.has_value()) {
+            missesPerElement = std::to_string(static_cast<double>(misses.value()) / elements);
+        }
+
+        std::println("  {:<28}{:>8.3f} ns/element {:>12} LLC misses/element  (Total: {})",
+            name, nanoseconds / elements, missesPerElement, total);
+    }
+
+    // simulates a bookstore after some churn: twice the number of objects is created,
+    // every second one (in random order) is removed, the rest is stocked in random order
+    template <typename TCreate>
+    static Bookstore createChurnedBookstore(size_t size, TCreate create)
+    {
+        std::vector<std::shared_ptr<IMedia>> media;
+        media.reserve(2 * size);
+
+        for (size_t i{}; i != 2 * size; ++i) {
+            media.push_back(create(i));
+        }
+
+        std::shuffle(media.begin(), media.end(), std::mt19937{ 42 });
+        media.resize(size);
+
+        Bookstore bookstore{ };
+        for (const auto& element : media) {
+            bookstore.addMedia(element);
+        }
+
+        return bookstore;
+    }
+
+    static void test_bookstore_arena_02_benchmark()
+    {
+        std::println("Benchmark - recomputeTotalBalance: make_shared vs Arena (Prefetch Distance: {})", PrefetchDistance);
+
+        for (size_t size{ 10000 }; size <= 1000000; size *= 10) {
+
+            std::println("Items: {}", size);
+
+            {
+                Bookstore bookstore{ createChurnedBookstore(size, [](size_t i) -> std::shared_ptr<IMedia> {
+                    if (i % 2 == 0) {
+                        return std::make_shared<Book>("C", "Dennis Ritchie", 11.99, 12);
+                    }
+                    return std::make_shared<Movie>("Spectre", "Sam Mendes", 8.99, 6);
+                }) };
+
+                measureScan("make_shared", size, [&] {
+                    return bookstore.recomputeTotalBalance();
+                });
+
+                measureScan("make_shared, prefetch", size, [&] {
+                    return bookstore.recomputeTotalBalancePrefetched(PrefetchDistance);
+                });
+            }
+
+            {
+                ArenaMediaFactory<Book, Movie> factory{};
+
+                Bookstore bookstore{ createChurnedBookstore(size, [&](size_t i) -> std::shared_ptr<IMedia> {
+                    if (i % 2 == 0) {
+                        return factory.create<Book>("C", "Dennis Ritchie", 11.99, 12);
+                    }
+                    return factory.create<Movie>("Spectre", "Sam Mendes", 8.99, 6);
+                }) };
+
+                measureScan("arena", size, [&] {
+                    return bookstore.recomputeTotalBalance();
+                });
+
+                measureScan("arena, prefetch", size, [&] {
+                    return bookstore.recomputeTotalBalancePrefetched(PrefetchDistance);
+                });
+
+                factory.compact(bookstore);
+
+                measureScan("arena, compacted", size, [&] {
+                    return bookstore.recomputeTotalBalance();
+                });
+
+                measureScan("arena, compacted, prefetch", size, [&] {
+                    return bookstore.recomputeTotalBalancePrefetched(PrefetchDistance);
+                });
+            }
+        }
+    }
+}
+
+// =====================================================================================
+
+void main_type_erasure_arena()
+{
+    using namespace BookStoreUsingArenaAllocation;
+
+    test_bookstore_arena_01();
+    test_bookstore_arena_02_benchmark();
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
@@ -0,0 +1,495 @@
+// =====================================================================================
+// BookstoreCatalog.cpp // Memory-Mapped Binary Catalog for the Bookstore Stock
+// =====================================================================================
+
+module modern_cpp:type_erasure;
+
+import :bookstore;
+import :money;
+import :mapped_file;
+
+namespace BookStoreCatalog {
+
+    using namespace BookStoreUsingTypeErasure;
+
+    // =================================================================================
+    // file format (version 2, native byte order):
+    //
+    //   header (64 bytes) | records | prices | counts | string heap
+    //
+    // records, prices and counts consist of 'm_numRecords' elements each,
+    // every section starts at a multiple of 64 bytes. The price and count columns
+    // are separated from the records: 'totalBalance' streams over two dense arrays.
+    // prices are stored as 'Money', a 64-bit integer in cents (version 1: 'double').
+    // strings are referenced by offset and length into the string heap,
+    // equal strings are stored only once
+
+    enum class MediaKind : std::uint32_t { Book = 1, Movie = 2 };
+
+    struct CatalogString
+    {
+        std::uint32_t m_offset;
+        std::uint32_t m_length;
+    };
+
+    // Book: author, title - Movie: title, director
+    struct CatalogRecord
+    {
+        MediaKind     m_kind;
+        std::uint32_t m_reserved;
+        CatalogString m_first;
+        CatalogString m_second;
+    };
+
+    struct CatalogHeader
+    {
+        std::array<char, 4> m_magic;
+        std::uint32_t       m_version;
+        std::uint64_t       m_numRecords;
+        std::uint64_t       m_recordsOffset;
+        std::uint64_t       m_pricesOffset;
+        std::uint64_t       m_countsOffset;
+        std::uint64_t       m_stringsOffset;
+        std::uint64_t       m_stringsSize;
+        std::uint64_t       m_reserved;
+    };
+
+    static_assert(std::is_trivially_copyable_v<CatalogRecord>);
+    static_assert(sizeof(CatalogRecord) == 24);
+    static_assert(std::is_trivially_copyable_v<CatalogHeader>);
+    static_assert(sizeof(CatalogHeader) == 64);
+    static_assert(std::is_trivially_copyable_v<Money>);
+    static_assert(sizeof(Money) == 8);
+
+    constexpr std::array<char, 4> CatalogMagic{ 'B', 'C', 'A', 'T' };
+    constexpr std::uint32_t CatalogVersion{ 2 };
+    constexpr size_t CatalogAlignment{ 64 };
+
+    constexpr size_t alignUp(size_t offset) {
+        return (offset + CatalogAlignment - 1) / CatalogAlignment * CatalogAlignment;
+    }
+
+    // =================================================================================
+
+    class CatalogWriter
+    {
+    private:
+        std::vector<CatalogRecord>   m_records;
+        std::vector<Money>           m_prices;
+        std::vector<std::uint64_t>   m_counts;
+        std::string                  m_strings;
+        std::unordered_map<std::string, CatalogString, StringHash, std::equal_to<>> m_stringTable;
+
+    public:
+        // c'tor
+        CatalogWriter() = default;
+
+        // public interface
+        void add(const Book& book) {
+            addRecord(MediaKind::Book, book.getAuthor(), book.getTitle(), book.getPrice(), book.getCount());
+        }
+
+        void add(const Movie& movie) {
+            addRecord(MediaKind::Movie, movie.getTitle(), movie.getDirector(), movie.getPrice(), movie.getCount());
+        }
+
+        size_t size() const { return m_records.size(); }
+
+        void write(const std::filesystem::path& path) const {
+
+            std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+            if (!out) {
+                throw std::runtime_error{ "Cannot create file " + path.string() };
+            }
+
+            const size_t numRecords{ m_records.size() };
+
+            CatalogHeader header{};
+            header.m_magic = CatalogMagic;
+            header.m_version = CatalogVersion;
+            header.m_numRecords = numRecords;
+            header.m_recordsOffset = alignUp(sizeof(CatalogHeader));
+            header.m_pricesOffset = alignUp(header.m_recordsOffset + numRecords * sizeof(CatalogRecord));
+            header.m_countsOffset = alignUp(header.m_pricesOffset + numRecords * sizeof(Money));
+            header.m_stringsOffset = alignUp(header.m_countsOffset + numRecords * sizeof(std::uint64_t));
+            header.m_stringsSize = m_strings.size();
+
+            writeSection(out, 0, &header, sizeof(header));
+            writeSection(out, header.m_recordsOffset, m_records.data(), numRecords * sizeof(CatalogRecord));
+            writeSection(out, header.m_pricesOffset, m_prices.data(), numRecords * sizeof(Money));
+            writeSection(out, header.m_countsOffset, m_counts.data(), numRecords * sizeof(std::uint64_t));
+            writeSection(out, header.m_stringsOffset, m_strings.data(), m_strings.size());
+
+            if (!out) {
+                throw std::runtime_error{ "Error writing file " + path.string() };
+            }
+        }
+
+    private:
+        void addRecord(MediaKind kind, std::string_view first, std::string_view second, double price, size_t count) {
+            m_records.push_back({ kind, 0, intern(first), intern(second) });
+            m_prices.push_back(Money::fromDouble(price));
+            m_counts.push_back(count);
+        }
+
+        CatalogString intern(std::string_view string) {
+
+            auto pos{ m_stringTable.find(string) };
+            if (pos != m_stringTable.end()) {
+                return pos->second;
+            }
+
+            if (m_strings.size() + string.size() > std::numeric_limits<std::uint32_t>::max()) {
+                throw std::length_error{ "String heap of catalog exceeds 4 GB" };
+            }
+
+            CatalogString entry{
+                static_cast<std::uint32_t>(m_strings.size()),
+                static_cast<std::uint32_t>(string.size())
+            };
+
+            m_strings.append(string);
+            m_stringTable.emplace(string, entry);
+
+            return entry;
+        }
+
+        // pads the file with zeros up to 'offset'
+        static void writeSection(std::ofstream& out, size_t offset, const void* data, size_t size) {
+
+            const size_t position{ static_cast<size_t>(out.tellp()) };
+            if (position < offset) {
+                const std::array<char, CatalogAlignment> zeros{};
+                out.write(zeros.data(), static_cast<std::streamsize>(offset - position));
+            }
+
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        }
+    };
+
+    // =================================================================================
+
+    // views onto records of a catalog, valid as long as the catalog exists
+    class BookView
+    {
+    private:
+        std::string_view m_author;
+        std::string_view m_title;
+        double           m_price;
+        size_t           m_count;
+
+    public:
+        // c'tor
+        BookView(std::string_view author, std::string_view title, double price, size_t count)
+            : m_author{ author }, m_title{ title }, m_price{ price }, m_count{ count }
+        {}
+
+        // getter
+        std::string_view getAuthor() const { return m_author; }
+        std::string_view getTitle() const { return m_title; }
+
+        double getPrice() const { return m_price; }
+        size_t getCount() const { return m_count; }
+    };
+
+    class MovieView
+    {
+    private:
+        std::string_view m_title;
+        std::string_view m_director;
+        double           m_price;
+        size_t           m_count;
+
+    public:
+        // c'tor
+        MovieView(std::string_view title, std::string_view director, double price, size_t count)
+            : m_title{ title }, m_director{ director }, m_price{ price }, m_count{ count }
+        {}
+
+        // getter
+        std::string_view getTitle() const { return m_title; }
+        std::string_view getDirector() const { return m_director; }
+
+        double getPrice() const { return m_price; }
+        size_t getCount() const { return m_count; }
+    };
+
+    // read-only catalog: opening the file maps it into memory, nothing is copied.
+    // pages are loaded by the operating system on first access
+    class Catalog
+    {
+    private:
+        MappedFile            m_file;
+        const CatalogRecord*  m_records;
+        const Money*          m_prices;
+        const std::uint64_t*  m_counts;
+        const char*           m_strings;
+        size_t                m_stringsSize;
+        size_t                m_size;
+
+    public:
+        // c'tor
+        explicit Catalog(const std::filesystem::path& path)
+            : m_file{ path }, m_records{}, m_prices{}, m_counts{}, m_strings{}, m_stringsSize{}, m_size{}
+        {
+            if (m_file.size() < sizeof(CatalogHeader)) {
+                throw std::runtime_error{ "Not a catalog file: " + path.string() };
+            }
+
+            CatalogHeader header{};
+            std::memcpy(&header, m_file.data(), sizeof(header));
+
+            if (header.m_magic != CatalogMagic || header.m_version != CatalogVersion) {
+                throw std::runtime_error{ "Not a catalog file (or unsupported version): " + path.string() };
+            }
+
+            const size_t numRecords{ static_cast<size_t>(header.m_numRecords) };
+
+            auto isValid = [&](size_t offset, size_t size) {
+                return offset % CatalogAlignment == 0 && offset <= m_file.size() && size <= m_file.size() - offset;
+            };
+
+            if (numRecords > m_file.size() / sizeof(CatalogRecord) ||
+                !isValid(header.m_recordsOffset, numRecords * sizeof(CatalogRecord)) ||
+                !isValid(header.m_pricesOffset, numRecords * sizeof(Money)) ||
+                !isValid(header.m_countsOffset, numRecords * sizeof(std::uint64_t)) ||
+                !isValid(header.m_stringsOffset, header.m_stringsSize)) {
+                throw std::runtime_error{ "Catalog file is corrupt: " + path.string() };
+            }
+
+            m_records = reinterpret_cast<const CatalogRecord*>(m_file.data() + header.m_recordsOffset);
+            m_prices = reinterpret_cast<const Money*>(m_file.data() + header.m_pricesOffset);
+            m_counts = reinterpret_cast<const std::uint64_t*>(m_file.data() + header.m_countsOffset);
+            m_strings = reinterpret_cast<const char*>(m_file.data() + header.m_stringsOffset);
+            m_stringsSize = static_cast<size_t>(header.m_stringsSize);
+            m_size = numRecords;
+        }
+
+        // getter
+        size_t size() const { return m_size; }
+
+        MediaKind kind(size_t index) const { return record(index).m_kind; }
+
+        std::span<const Money> prices() const { return { m_prices, m_size }; }
+        std::span<const std::uint64_t> counts() const { return { m_counts, m_size }; }
+
+        // public interface
+        BookView book(size_t index) const {
+
+            const auto& entry{ record(index) };
+            if (entry.m_kind != MediaKind::Book) {
+                throw std::invalid_argument{ "Catalog entry is not a book" };
+            }
+
+            return { string(entry.m_first), string(entry.m_second), m_prices[index].toDouble(), static_cast<size_t>(m_counts[index]) };
+        }
+
+        MovieView movie(size_t index) const {
+
+            const auto& entry{ record(index) };
+            if (entry.m_kind != MediaKind::Movie) {
+                throw std::invalid_argument{ "Catalog entry is not a movie" };
+            }
+
+            return { string(entry.m_first), string(entry.m_second), m_prices[index].toDouble(), static_cast<size_t>(m_counts[index]) };
+        }
+
+        // calls 'func' with a 'BookView' or a 'MovieView'
+        template <typename TFunc>
+        decltype(auto) visit(size_t index, TFunc&& func) const {
+
+            if (kind(index) == MediaKind::Book) {
+                return std::forward<TFunc>(func)(book(index));
+            }
+            else {
+                return std::forward<TFunc>(func)(movie(index));
+            }
+        }
+
+        // streams over the columns, the records and strings are not touched
+        Money totalBalance() const {
+            return Money::sumOfProducts(prices(), counts());
+        }
+
+        size_t count() const {
+
+            size_t total{};
+
+            for (size_t i{}; i != m_size; ++i) {
+                total += m_counts[i];
+            }
+
+            return total;
+        }
+
+    private:
+        const CatalogRecord& record(size_t index) const {
+
+            if (index >= m_size) {
+                throw std::out_of_range{ "Catalog index out of range" };
+            }
+
+            return m_records[index];
+        }
+
+        std::string_view string(CatalogString entry) const {
+
+            if (entry.m_offset > m_stringsSize || entry.m_length > m_stringsSize - entry.m_offset) {
+                throw std::runtime_error{ "Catalog file is corrupt: invalid string reference" };
+            }
+
+            return { m_strings + entry.m_offset, entry.m_length };
+        }
+    };
+
+    // =================================================================================
+
+    static void test_bookstore_catalog_01()
+    {
+        const auto path{ std::filesystem::temp_directory_path() / "bookstore_catalog_01.bin" };
+
+        {
+            CatalogWriter writer{};
+            writer.add(Book{ "Dennis Ritchie", "C", 11.99, 12 });
+            writer.add(Movie{ "Spectre", "Sam Mendes", 8.99, 6 });
+            writer.add(Book{ "James Gosling", "Java", 17.99, 21 });
+            writer.add(Book{ "Bjarne Stroustrup", "C++", 16.99, 4 });
+            writer.add(Movie{ "Once upon a time in Hollywood", "Quentin Tarantino", 6.99, 3 });
+            writer.write(path);
+        }
+
+        {
+            Catalog catalog{ path };
+
+            for (size_t i{}; i != catalog.size(); ++i) {
+                catalog.visit(i, [](const auto& media) {
+                    if constexpr (std::is_same_v<std::remove_cvref_t<decltype(media)>, BookView>) {
+                        std::println("Book:  {} - {} ({:.{}f}, {})",
+                            media.getAuthor(), media.getTitle(), media.getPrice(), 2, media.getCount());
+                    }
+                    else {
+                        std::println("Movie: {} - {} ({:.{}f}, {})",
+                            media.getTitle(), media.getDirector(), media.getPrice(), 2, media.getCount());
+                    }
+                });
+            }
+
+            std::println("Total value of Bookstore: {}", catalog.totalBalance());
+            std::println("Count of elements in Bookstore: {}", catalog.count());
+        }
+
+        std::filesystem::remove(path);
+        std::println();
+    }
+
+    // =================================================================================
+
+    // names longer than the small string buffer: every object needs heap allocations
+    constexpr std::array<std::string_view, 4> Authors{
+        "Dennis MacAlistair Ritchie", "James Arthur Gosling", "Bjarne Stroustrup (Aarhus)", "Anders Hejlsberg (Copenhagen)"
+    };
+
+    constexpr std::array<std::string_view, 4> Titles{
+        "The C Programming Language", "The Java Language Specification",
+        "The C++ Programming Language", "The C# Programming Language"
+    };
+
+    static double priceOf(size_t i) { return 5.0 + static_cast<double>(i % 100) * 0.25; }
+    static size_t countOf(size_t i) { return i % 20; }
+
+    template <typename TFunc>
+    static auto measure(std::string_view name, TFunc func)
+    {
+        const auto begin{ std::chrono::steady_clock::now() };
+        auto result{ func() };
+        const auto end{ std::chrono::steady_clock::now() };
+
+        std::println("  {:<36}{:>12.3f} ms", name, std::chrono::duration<double, std::milli>{ end - begin }.count());
+
+        return result;
+    }
+
+    static void test_bookstore_catalog_02_benchmark()
+    {
+        std::println("Benchmark - Startup: Constructing Objects vs Memory-Mapped Catalog");
+
+        const auto path{ std::filesystem::temp_directory_path() / "bookstore_catalog_02.bin" };
+
+        for (size_t size{ 1000000 }; size <= 10000000; size *= 10) {
+
+            std::println("Items: {}", size);
+
+            {
+                auto bookstore{ measure("construct Bookstore<Book, Movie>", [&] {
+                    Bookstore<Book, Movie> bookstore{ };
+                    for (size_t i{}; i != size; ++i) {
+                        const size_t k{ i % Authors.size() };
+                        if (i % 2 == 0) {
+                            bookstore.addMedia(Book{ std::string{ Authors[k] }, std::string{ Titles[k] }, priceOf(i), countOf(i) });
+                        }
+                        else {
+                            bookstore.addMedia(Movie{ std::string{ Titles[k] }, std::string{ Authors[k] }, priceOf(i), countOf(i) });
+                        }
+                    }
+                    return bookstore;
+                }) };
+
+                Money total{ measure("  recomputeTotalBalance", [&] { return bookstore.recomputeTotalBalance(); }) };
+                std::println("  (Total: {})", total);
+            }
+
+            // the bookstore has been released before the writer is built:
+            // the two are never held in memory at the same time
+            {
+                measure("write catalog", [&] {
+                    CatalogWriter writer{};
+                    for (size_t i{}; i != size; ++i) {
+                        const size_t k{ i % Authors.size() };
+                        if (i % 2 == 0) {
+                            writer.add(Book{ std::string{ Authors[k] }, std::string{ Titles[k] }, priceOf(i), countOf(i) });
+                        }
+                        else {
+                            writer.add(Movie{ std::string{ Titles[k] }, std::string{ Authors[k] }, priceOf(i), countOf(i) });
+                        }
+                    }
+                    writer.write(path);
+                    return writer.size();
+                });
+            }
+
+            {
+                // the file has just been written: its pages are in the file system cache
+                auto catalog{ measure("open catalog (mapping)", [&] { return std::make_unique<Catalog>(path); }) };
+
+                Money total{ measure("  totalBalance (first access)", [&] { return catalog->totalBalance(); }) };
+                total = measure("  totalBalance", [&] { return catalog->totalBalance(); });
+                std::println("  (Total: {})", total);
+
+                size_t length{ measure("  visit all records", [&] {
+                    size_t length{};
+                    for (size_t i{}; i != catalog->size(); ++i) {
+                        length += catalog->visit(i, [](const auto& media) { return media.getTitle().size(); });
+                    }
+                    return length;
+                }) };
+                std::println("  (Length of all titles: {})", length);
+            }
+
+            std::filesystem::remove(path);
+        }
+    }
+}
+
+// =====================================================================================
+
+void main_type_erasure_catalog()
+{
+    using namespace BookStoreCatalog;
+
+    test_bookstore_catalog_01();
+    test_bookstore_catalog_02_benchmark();
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
@@ -0,0 +1,350 @@
+// =====================================================================================
+// BookstoreConcurrent.cpp // Concurrent Bookstore with Snapshot Reads (RCU-Style)
+// =====================================================================================
+
+module modern_cpp:type_erasure;
+
+import :bookstore;
+import :money;
+
+namespace BookStoreConcurrent {
+
+    using namespace BookStoreUsingTypeErasure;
+
+    // readers load an immutable snapshot, writers publish a modified copy (copy-on-write).
+    // a snapshot stays valid as long as a reader holds it - reclamation by reference counting.
+    // note: 'std::atomic<std::shared_ptr>' guarantees atomicity, but it is not necessarily
+    // lock-free (see 'is_lock_free'), the standard libraries protect the pointer with a tiny
+    // spin lock. Class 'Reader' avoids this: it reloads its snapshot only after a new version
+    // has been published, reading the version number is a plain atomic load
+    template <typename ... TMedia>
+        requires (MediaConcept<TMedia> && ...)
+    class ConcurrentBookstore
+    {
+    public:
+        using StockType = std::variant<TMedia ...>;
+        using Stock     = std::vector<StockType>;
+
+        struct Snapshot
+        {
+            Stock  m_stock;
+            Money  m_totalBalance;
+            size_t m_count;
+        };
+
+        static constexpr size_t DefaultBatchSize{ 64 };
+
+        class Reader
+        {
+        private:
+            const ConcurrentBookstore*      m_bookstore;
+            std::shared_ptr<const Snapshot> m_snapshot;
+            size_t                          m_version;
+
+        public:
+            // c'tor
+            explicit Reader(const ConcurrentBookstore& bookstore)
+                : m_bookstore{ &bookstore }, m_snapshot{}, m_version{}
+            {
+                refresh();
+            }
+
+            // the snapshot held by the reader keeps the old stock alive
+            // until the next call of 'current' - the 'grace period' of RCU
+            const Snapshot& current() {
+                if (m_bookstore->m_version.load(std::memory_order_acquire) != m_version) {
+                    refresh();
+                }
+                return *m_snapshot;
+            }
+
+            Money totalBalance() { return current().m_totalBalance; }
+            size_t count() { return current().m_count; }
+
+        private:
+            // the loaded snapshot may be newer than the version: causes one more reload
+            void refresh() {
+                m_version = m_bookstore->m_version.load(std::memory_order_acquire);
+                m_snapshot = m_bookstore->snapshot();
+            }
+        };
+
+    private:
+        std::atomic<std::shared_ptr<const Snapshot>> m_snapshot;
+        std::atomic<size_t>                          m_version;
+
+        // writers only: pending updates, published as one batch
+        std::mutex m_writerMutex;
+        Stock      m_pending;
+        size_t     m_batchSize;
+
+    public:
+        // c'tor
+        explicit ConcurrentBookstore(size_t batchSize = DefaultBatchSize)
+            : m_snapshot{ std::make_shared<const Snapshot>() }, m_version{}, m_pending{}, m_batchSize{ batchSize }
+        {}
+
+        Reader reader() const { return Reader{ *this }; }
+
+        // readers - no mutex, O(1)
+        std::shared_ptr<const Snapshot> snapshot() const {
+            return m_snapshot.load(std::memory_order_acquire);
+        }
+
+        Money totalBalance() const { return snapshot()->m_totalBalance; }
+        size_t count() const { return snapshot()->m_count; }
+        size_t size() const { return snapshot()->m_stock.size(); }
+
+        // writers - visible to readers after 'batchSize' updates or after 'flush'
+        template <typename T>
+            requires MediaConcept<T>
+        void addMedia(const T& media) {
+
+            std::lock_guard<std::mutex> guard{ m_writerMutex };
+
+            m_pending.push_back(media);
+            if (m_pending.size() >= m_batchSize) {
+                publish();
+            }
+        }
+
+        void flush() {
+
+            std::lock_guard<std::mutex> guard{ m_writerMutex };
+
+            if (!m_pending.empty()) {
+                publish();
+            }
+        }
+
+    private:
+        // called with 'm_writerMutex' locked: there is only one writer at a time,
+        // the current snapshot can't be replaced between 'load' and 'store'
+        void publish() {
+
+            const auto current{ m_snapshot.load(std::memory_order_relaxed) };
+
+            auto next{ std::make_shared<Snapshot>() };
+            next->m_stock.reserve(current->m_stock.size() + m_pending.size());
+            next->m_stock = current->m_stock;
+            next->m_totalBalance = current->m_totalBalance;
+            next->m_count = current->m_count;
+
+            for (const auto& media : m_pending) {
+                std::visit(
+                    [&](const auto& element) {
+                        next->m_totalBalance += stockValue(element.getPrice(), element.getCount());
+                        next->m_count += element.getCount();
+                    },
+                    media
+                );
+                next->m_stock.push_back(media);
+            }
+
+            m_pending.clear();
+
+            // the version is incremented after the new snapshot has been stored
+            m_snapshot.store(std::move(next), std::memory_order_release);
+            m_version.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    // baseline: all methods guarded by one mutex,
+    // with 'std::shared_mutex' readers exclude writers only
+    template <typename TMutex, typename ... TMedia>
+        requires (MediaConcept<TMedia> && ...)
+    class LockedBookstore
+    {
+    private:
+        mutable TMutex         m_mutex;
+        Bookstore<TMedia ...>  m_bookstore;
+
+    public:
+        // c'tor
+        LockedBookstore() : m_mutex{}, m_bookstore{ } {}
+
+        // readers
+        Money totalBalance() const {
+            auto lock{ readLock() };
+            return m_bookstore.totalBalance();
+        }
+
+        size_t count() const {
+            auto lock{ readLock() };
+            return m_bookstore.count();
+        }
+
+        // both values consistent with each other
+        std::pair<Money, size_t> aggregates() const {
+            auto lock{ readLock() };
+            return { m_bookstore.totalBalance(), m_bookstore.count() };
+        }
+
+        // writers
+        template <typename T>
+            requires MediaConcept<T>
+        void addMedia(const T& media) {
+            std::lock_guard<TMutex> guard{ m_mutex };
+            m_bookstore.addMedia(media);
+        }
+
+        void flush() {}
+
+    private:
+        auto readLock() const {
+            if constexpr (std::is_same_v<TMutex, std::shared_mutex>) {
+                return std::shared_lock<TMutex>{ m_mutex };
+            }
+            else {
+                return std::unique_lock<TMutex>{ m_mutex };
+            }
+        }
+    };
+
+    static void test_bookstore_concurrent_01()
+    {
+        ConcurrentBookstore<Book, Movie> bookstore{ 4 };
+
+        bookstore.addMedia(Book{ "C", "Dennis Ritchie", 11.99, 12 });
+        bookstore.addMedia(Movie{ "Spectre", "Sam Mendes", 8.99, 6 });
+        bookstore.addMedia(Book{ "Java", "James Gosling", 17.99, 21 });
+
+        // batch not yet complete
+        std::println("Count of elements in Bookstore: {}", bookstore.count());
+
+        const auto snapshot{ bookstore.snapshot() };
+        auto reader{ bookstore.reader() };
+
+        bookstore.addMedia(Book{ "C++", "Bjarne Stroustrup", 16.99, 4 });
+        bookstore.addMedia(Movie{ "Once upon a time in Hollywood", "Quentin Tarantino", 6.99, 3 });
+        bookstore.flush();
+
+        std::println("Total value of Bookstore: {}", bookstore.totalBalance());
+        std::println("Count of elements in Bookstore: {}", bookstore.count());
+
+        // the reader has noticed the new version
+        std::println("Count of elements (Reader): {}", reader.count());
+
+        // an old snapshot remains unchanged
+        std::println("Elements in old snapshot: {}", snapshot->m_stock.size());
+        std::println("Elements in new snapshot: {}", bookstore.size());
+        std::println();
+    }
+
+    // =================================================================================
+
+    constexpr size_t InitialItems{ 10000 };
+    constexpr auto   MeasurementDuration{ std::chrono::milliseconds{ 200 } };
+
+    // 'numReaders' threads read the total balance and the count as often as possible,
+    // one writer adds 'writesPerSecond' media objects at a constant rate
+    template <typename TBookstore, typename TCreateReader>
+    static void measureReaders(std::string_view name, size_t numReaders, size_t writesPerSecond, TCreateReader createReader)
+    {
+        TBookstore bookstore{};
+
+        for (size_t i{}; i != InitialItems; ++i) {
+            bookstore.addMedia(Book{ "C", "Dennis Ritchie", 11.99, 12 });
+        }
+        bookstore.flush();
+
+        std::atomic<bool> stop{ false };
+        std::atomic<size_t> reads{};
+        size_t writes{};
+
+        {
+            std::vector<std::jthread> threads;
+
+            for (size_t i{}; i != numReaders; ++i) {
+                threads.emplace_back([&] {
+                    auto read{ createReader(bookstore) };
+                    size_t calls{};
+                    double total{};
+                    while (!stop.load(std::memory_order_relaxed)) {
+                        total += read();
+                        ++calls;
+                    }
+                    reads += calls;
+                    if (total < 0.0) {
+                        std::println("{}", total);   // keeps the calls alive
+                    }
+                });
+            }
+
+            if (writesPerSecond != 0) {
+                threads.emplace_back([&] {
+                    const auto interval{ std::chrono::nanoseconds{ 1000000000 / writesPerSecond } };
+                    auto next{ std::chrono::steady_clock::now() };
+                    while (!stop.load(std::memory_order_relaxed)) {
+                        bookstore.addMedia(Movie{ "Spectre", "Sam Mendes", 8.99, 6 });
+                        ++writes;
+                        next += interval;
+                        std::this_thread::sleep_until(next);
+                    }
+                    bookstore.flush();
+                });
+            }
+
+            std::this_thread::sleep_for(MeasurementDuration);
+            stop = true;
+        }   // joins all threads
+
+        const double seconds{ std::chrono::duration<double>{ MeasurementDuration }.count() };
+
+        std::println("  {:<24}{:>4} readers {:>9} writes/s  {:>10.2f} M reads/s  (Writes: {})",
+            name, numReaders, writesPerSecond, static_cast<double>(reads) / seconds / 1e6, writes);
+    }
+
+    static void test_bookstore_concurrent_02_benchmark()
+    {
+        using SnapshotBookstore = ConcurrentBookstore<Book, Movie>;
+
+        // one atomic load of the 'std::shared_ptr' per read
+        auto snapshotReader = [](const SnapshotBookstore& bookstore) {
+            return [&bookstore] {
+                const auto snapshot{ bookstore.snapshot() };
+                return snapshot->m_totalBalance.toDouble() + snapshot->m_count;
+            };
+        };
+
+        // reloads the snapshot only if a new version has been published
+        auto cachingReader = [](const SnapshotBookstore& bookstore) {
+            return [reader = bookstore.reader()] () mutable {
+                const auto& snapshot{ reader.current() };
+                return snapshot.m_totalBalance.toDouble() + snapshot.m_count;
+            };
+        };
+
+        auto lockingReader = [](const auto& bookstore) {
+            return [&bookstore] {
+                const auto [balance, count] { bookstore.aggregates() };
+                return balance.toDouble() + count;
+            };
+        };
+
+        std::println("Benchmark - Reader Throughput (Hardware Threads: {})", std::thread::hardware_concurrency());
+
+        for (size_t writesPerSecond : { 0, 1000, 100000 }) {
+            for (size_t numReaders : { 1, 2, 4, 8 }) {
+                measureReaders<SnapshotBookstore>("snapshot", numReaders, writesPerSecond, snapshotReader);
+                measureReaders<SnapshotBookstore>("snapshot, Reader", numReaders, writesPerSecond, cachingReader);
+                measureReaders<LockedBookstore<std::mutex, Book, Movie>>("std::mutex", numReaders, writesPerSecond, lockingReader);
+                measureReaders<LockedBookstore<std::shared_mutex, Book, Movie>>("std::shared_mutex", numReaders, writesPerSecond, lockingReader);
+            }
+        }
+    }
+}
+
+// =====================================================================================
+
+void main_type_erasure_concurrent()
+{
+    using namespace BookStoreConcurrent;
+
+    test_bookstore_concurrent_01();
+    test_bookstore_concurrent_02_benchmark();
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
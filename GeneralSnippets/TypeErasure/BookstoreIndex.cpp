@@ -0,0 +1,463 @@
+// =====================================================================================
+// BookstoreIndex.cpp // Secondary Indexes for Lookups by Author, Title and Director
+// =====================================================================================
+
+module modern_cpp:type_erasure;
+
+import :bookstore;
+import :money;
+
+namespace BookStoreUsingSecondaryIndexes {
+
+    using namespace BookStoreUsingTypeErasure;
+
+    enum class MediaField { Author, Title, Director };
+
+    // maps a key to the positions of all media objects with this key.
+    // hash index: exact match, O(1) - sorted index: prefix queries, O(log n + k).
+    // the sorted index refers to the keys and positions of the hash index,
+    // the nodes of a 'std::unordered_map' keep their address on rehashing
+    class StringIndex
+    {
+    private:
+        using Positions = std::vector<size_t>;
+
+        std::unordered_map<std::string, Positions, StringHash, std::equal_to<>> m_hashIndex;
+        std::map<std::string_view, const Positions*> m_sortedIndex;
+        bool m_withSortedIndex;
+
+    public:
+        // c'tor
+        explicit StringIndex(bool withSortedIndex) : m_hashIndex{}, m_sortedIndex{}, m_withSortedIndex{ withSortedIndex } {}
+
+        // no copying: the sorted index refers to the hash index
+        StringIndex(const StringIndex&) = delete;
+        StringIndex& operator=(const StringIndex&) = delete;
+
+        // public interface
+        // strong exception guarantee: a new key is removed again, if the position can't be added
+        void add(std::string_view key, size_t position) {
+
+            auto pos{ m_hashIndex.find(key) };
+            bool newKey{ false };
+
+            if (pos == m_hashIndex.end()) {
+                pos = m_hashIndex.emplace(key, Positions{}).first;
+                newKey = true;
+            }
+
+            try {
+                if (newKey && m_withSortedIndex) {
+                    m_sortedIndex.emplace(pos->first, &pos->second);
+                }
+
+                pos->second.push_back(position);
+            }
+            catch (...) {
+                if (newKey) {
+                    m_sortedIndex.erase(pos->first);
+                    m_hashIndex.erase(pos);
+                }
+                throw;
+            }
+        }
+
+        // undoes the last 'add' of 'key' - rollback of a failed 'IndexedBookstore::addMedia'
+        void removeLast(std::string_view key) {
+
+            auto pos{ m_hashIndex.find(key) };
+
+            pos->second.pop_back();
+
+            if (pos->second.empty()) {
+                m_sortedIndex.erase(pos->first);
+                m_hashIndex.erase(pos);
+            }
+        }
+
+        std::span<const size_t> find(std::string_view key) const {
+
+            auto pos{ m_hashIndex.find(key) };
+            if (pos == m_hashIndex.end()) {
+                return {};
+            }
+
+            return pos->second;
+        }
+
+        // calls 'func' with the position of every media object whose key starts with 'prefix',
+        // ordered by key
+        template <typename TFunc>
+        void forEachWithPrefix(std::string_view prefix, TFunc func) const {
+
+            if (!m_withSortedIndex) {
+                throw std::logic_error{ "Prefix query without sorted index" };
+            }
+
+            for (auto pos{ m_sortedIndex.lower_bound(prefix) };
+                pos != m_sortedIndex.end() && pos->first.starts_with(prefix); ++pos)
+            {
+                for (size_t position : *pos->second) {
+                    func(position);
+                }
+            }
+        }
+
+        size_t keys() const { return m_hashIndex.size(); }
+    };
+
+    // bookstore with optional secondary indexes, maintained incrementally by 'addMedia'.
+    // note: there is no 'removeMedia' - removing an element shifts the positions
+    // of all following elements, every index would have to be renumbered in O(n)
+    template <typename ... TMedia>
+        requires (MediaConcept<TMedia> && ...)
+    class IndexedBookstore
+    {
+    private:
+        Bookstore<TMedia ...> m_bookstore;
+
+        StringIndex m_authors;
+        StringIndex m_titles;
+        StringIndex m_directors;
+
+    public:
+        // c'tor
+        explicit IndexedBookstore(bool withPrefixIndexes = true)
+            : m_bookstore{ }, m_authors{ withPrefixIndexes }, m_titles{ withPrefixIndexes }, m_directors{ withPrefixIndexes }
+        {}
+
+        // each media type contributes the fields it has.
+        // strong exception guarantee: the indexes are updated first and rolled back,
+        // if a later index or the bookstore itself (e.g. overflow of the total value) throws
+        template <typename T>
+            requires MediaConcept<T>
+        void addMedia(const T& media) {
+
+            const size_t position{ m_bookstore.size() };
+
+            std::array<std::pair<StringIndex*, std::string_view>, 3> added{};
+            size_t numAdded{};
+
+            auto addTo = [&](StringIndex& index, std::string_view key) {
+                index.add(key, position);
+                added[numAdded++] = { &index, key };
+            };
+
+            try {
+                if constexpr (requires { media.getAuthor(); }) {
+                    addTo(m_authors, media.getAuthor());
+                }
+
+                if constexpr (requires { media.getTitle(); }) {
+                    addTo(m_titles, media.getTitle());
+                }
+
+                if constexpr (requires { media.getDirector(); }) {
+                    addTo(m_directors, media.getDirector());
+                }
+
+                m_bookstore.addMedia(media);
+            }
+            catch (...) {
+                while (numAdded != 0) {
+                    --numAdded;
+                    added[numAdded].first->removeLast(added[numAdded].second);
+                }
+                throw;
+            }
+        }
+
+        // prices and counts are not indexed
+        void setPrice(size_t index, double price) { m_bookstore.setPrice(index, price); }
+        void setCount(size_t index, size_t count) { m_bookstore.setCount(index, count); }
+
+        // getter
+        Money totalBalance() const { return m_bookstore.totalBalance(); }
+        size_t count() const { return m_bookstore.count(); }
+        size_t size() const { return m_bookstore.size(); }
+
+        decltype(auto) at(size_t index) const { return m_bookstore.at(index); }
+
+        const Bookstore<TMedia ...>& bookstore() const { return m_bookstore; }
+
+        // lookups
+        std::span<const size_t> find(MediaField field, std::string_view key) const {
+            return index(field).find(key);
+        }
+
+        template <typename TFunc>
+        void forEachWithPrefix(MediaField field, std::string_view prefix, TFunc func) const {
+            index(field).forEachWithPrefix(prefix, func);
+        }
+
+        std::vector<size_t> findPrefix(MediaField field, std::string_view prefix) const {
+
+            std::vector<size_t> positions;
+            forEachWithPrefix(field, prefix, [&](size_t position) { positions.push_back(position); });
+            return positions;
+        }
+
+    private:
+        const StringIndex& index(MediaField field) const {
+
+            switch (field)
+            {
+            case MediaField::Author:
+                return m_authors;
+            case MediaField::Title:
+                return m_titles;
+            default:
+                return m_directors;
+            }
+        }
+    };
+
+    // =================================================================================
+
+    // linear search - the baseline for the indexes
+    template <typename TBookstore, typename TPredicate>
+    static std::vector<size_t> findLinear(const TBookstore& bookstore, MediaField field, TPredicate predicate)
+    {
+        std::vector<size_t> positions;
+
+        for (size_t i{}; i != bookstore.size(); ++i) {
+
+            bool found{ std::visit(
+                [&](const auto& media) {
+                    if constexpr (requires { media.getAuthor(); }) {
+                        if (field == MediaField::Author) { return predicate(media.getAuthor()); }
+                    }
+                    if constexpr (requires { media.getTitle(); }) {
+                        if (field == MediaField::Title) { return predicate(media.getTitle()); }
+                    }
+                    if constexpr (requires { media.getDirector(); }) {
+                        if (field == MediaField::Director) { return predicate(media.getDirector()); }
+                    }
+                    return false;
+                },
+                bookstore.at(i)
+            ) };
+
+            if (found) {
+                positions.push_back(i);
+            }
+        }
+
+        return positions;
+    }
+
+    static void printMedia(const auto& bookstore, size_t position)
+    {
+        std::visit(
+            [](const auto& media) {
+                if constexpr (requires { media.getAuthor(); }) {
+                    std::println("  Book:  {} - {}", media.getTitle(), media.getAuthor());
+                }
+                else {
+                    std::println("  Movie: {} - {}", media.getTitle(), media.getDirector());
+                }
+            },
+            bookstore.at(position)
+        );
+    }
+
+    static void test_bookstore_index_01()
+    {
+        IndexedBookstore<Book, Movie> bookstore{};
+
+        bookstore.addMedia(Book{ "Dennis Ritchie", "The C Programming Language", 11.99, 12 });
+        bookstore.addMedia(Book{ "Bjarne Stroustrup", "The C++ Programming Language", 16.99, 4 });
+        bookstore.addMedia(Book{ "Bjarne Stroustrup", "A Tour of C++", 24.99, 7 });
+        bookstore.addMedia(Book{ "James Gosling", "The Java Programming Language", 17.99, 21 });
+        bookstore.addMedia(Movie{ "Spectre", "Sam Mendes", 8.99, 6 });
+        bookstore.addMedia(Movie{ "Skyfall", "Sam Mendes", 9.99, 5 });
+
+        std::println("Author 'Bjarne Stroustrup':");
+        for (size_t position : bookstore.find(MediaField::Author, "Bjarne Stroustrup")) {
+            printMedia(bookstore, position);
+        }
+
+        std::println("Director 'Sam Mendes':");
+        for (size_t position : bookstore.find(MediaField::Director, "Sam Mendes")) {
+            printMedia(bookstore, position);
+        }
+
+        std::println("Title starting with 'The C':");
+        for (size_t position : bookstore.findPrefix(MediaField::Title, "The C")) {
+            printMedia(bookstore, position);
+        }
+
+        std::println("Title 'Goldfinger': {} element(s)", bookstore.find(MediaField::Title, "Goldfinger").size());
+        std::println();
+    }
+
+    static void test_bookstore_index_02()
+    {
+        std::println("Overflow of the Total Value - Indexes are rolled back");
+
+        IndexedBookstore<Book, Movie> bookstore{};
+
+        // each value fits into 'Money', the sum of both doesn't
+        bookstore.addMedia(Book{ "Dennis Ritchie", "The C Programming Language", 5e13, 1000 });
+
+        try {
+            bookstore.addMedia(Book{ "Dennis Ritchie", "The C Reference Manual", 5e13, 1000 });
+        }
+        catch (const std::overflow_error& ex) {
+            std::println("Exception: {}", ex.what());
+        }
+
+        // the bookstore and its indexes remain unchanged
+        std::println("Size: {}", bookstore.size());    // 1
+        std::println("Author 'Dennis Ritchie': {} element(s)",
+            bookstore.find(MediaField::Author, "Dennis Ritchie").size());    // 1
+        std::println("Title 'The C Reference Manual': {} element(s)",
+            bookstore.find(MediaField::Title, "The C Reference Manual").size());    // 0
+        std::println("Title starting with 'The C': {} element(s)",
+            bookstore.findPrefix(MediaField::Title, "The C").size());    // 1
+        std::println();
+    }
+
+    // =================================================================================
+
+    constexpr size_t NumItems{ 1000000 };
+    constexpr size_t NumPeople{ 10000 };
+
+    // "Title 0000042" - fixed width, the numbers sort like the strings
+    static std::string makeName(std::string_view prefix, size_t number)
+    {
+        std::string digits{ std::to_string(number) };
+        return std::string{ prefix } + std::string(7 - digits.size(), '0') + digits;
+    }
+
+    template <typename TFunc>
+    static void measureQueries(std::string_view name, size_t numQueries, TFunc query)
+    {
+        size_t found{};
+
+        const auto begin{ std::chrono::steady_clock::now() };
+
+        for (size_t i{}; i != numQueries; ++i) {
+            found += query(i);
+        }
+
+        const auto end{ std::chrono::steady_clock::now() };
+
+        const double microseconds{ std::chrono::duration<double, std::micro>{ end - begin }.count() };
+
+        std::println("  {:<36}{:>14.3f} us/query  (Found: {})",
+            name, microseconds / static_cast<double>(numQueries), found);
+    }
+
+    static void test_bookstore_index_03_benchmark()
+    {
+        std::println("Benchmark - Lookups with {} Items: Linear Search vs Secondary Indexes", NumItems);
+
+        // costs of maintaining the indexes
+        {
+            const auto begin{ std::chrono::steady_clock::now() };
+
+            Bookstore<Book, Movie> bookstore{ };
+            for (size_t i{}; i != NumItems; ++i) {
+                if (i % 2 == 0) {
+                    bookstore.addMedia(Book{ makeName("Author ", i % NumPeople), makeName("Title ", i), 11.99, 12 });
+                }
+                else {
+                    bookstore.addMedia(Movie{ makeName("Title ", i), makeName("Director ", i % NumPeople), 8.99, 6 });
+                }
+            }
+
+            const auto end{ std::chrono::steady_clock::now() };
+
+            std::println("  {:<36}{:>14.3f} ms", "addMedia without indexes",
+                std::chrono::duration<double, std::milli>{ end - begin }.count());
+        }
+
+        IndexedBookstore<Book, Movie> bookstore{};
+
+        {
+            const auto begin{ std::chrono::steady_clock::now() };
+
+            for (size_t i{}; i != NumItems; ++i) {
+                if (i % 2 == 0) {
+                    bookstore.addMedia(Book{ makeName("Author ", i % NumPeople), makeName("Title ", i), 11.99, 12 });
+                }
+                else {
+                    bookstore.addMedia(Movie{ makeName("Title ", i), makeName("Director ", i % NumPeople), 8.99, 6 });
+                }
+            }
+
+            const auto end{ std::chrono::steady_clock::now() };
+
+            std::println("  {:<36}{:>14.3f} ms", "addMedia incl. indexes",
+                std::chrono::duration<double, std::milli>{ end - begin }.count());
+        }
+
+        // the queries are created in advance
+        std::mt19937 generator{ 42 };
+        std::uniform_int_distribution<size_t> distribution{ 0, NumItems - 1 };
+
+        std::vector<std::string> titles(1000);
+        std::vector<std::string> authors(1000);
+        std::vector<std::string> prefixes(1000);
+
+        for (size_t i{}; i != titles.size(); ++i) {
+            const size_t number{ distribution(generator) };
+            titles[i] = makeName("Title ", number);
+            authors[i] = makeName("Author ", (number % NumPeople) & ~size_t{ 1 });
+            prefixes[i] = titles[i].substr(0, titles[i].size() - 2);   // 100 matches
+        }
+
+        constexpr size_t LinearQueries{ 20 };
+
+        std::println("Exact match - Title:");
+
+        measureQueries("linear search", LinearQueries, [&](size_t i) {
+            return findLinear(bookstore.bookstore(), MediaField::Title,
+                [&](std::string_view title) { return title == titles[i]; }).size();
+        });
+
+        measureQueries("hash index", titles.size(), [&](size_t i) {
+            return bookstore.find(MediaField::Title, titles[i]).size();
+        });
+
+        std::println("Exact match - Author:");
+
+        measureQueries("linear search", LinearQueries, [&](size_t i) {
+            return findLinear(bookstore.bookstore(), MediaField::Author,
+                [&](std::string_view author) { return author == authors[i]; }).size();
+        });
+
+        measureQueries("hash index", authors.size(), [&](size_t i) {
+            return bookstore.find(MediaField::Author, authors[i]).size();
+        });
+
+        std::println("Prefix - Title:");
+
+        measureQueries("linear search", LinearQueries, [&](size_t i) {
+            return findLinear(bookstore.bookstore(), MediaField::Title,
+                [&](std::string_view title) { return title.starts_with(prefixes[i]); }).size();
+        });
+
+        measureQueries("sorted index", prefixes.size(), [&](size_t i) {
+            size_t found{};
+            bookstore.forEachWithPrefix(MediaField::Title, prefixes[i], [&](size_t) { ++found; });
+            return found;
+        });
+    }
+}
+
+// =====================================================================================
+
+void main_type_erasure_index()
+{
+    using namespace BookStoreUsingSecondaryIndexes;
+
+    test_bookstore_index_01();
+    test_bookstore_index_02();
+    test_bookstore_index_03_benchmark();
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
@@ -0,0 +1,136 @@
+// =====================================================================================
+// BookstorePolyCollection.cpp // Bookstore with Per-Type Segregated Storage
+// =====================================================================================
+
+module modern_cpp:type_erasure;
+
+import :bookstore;
+import :money;
+
+namespace BookStoreUsingPolyCollection {
+
+    using namespace BookStoreUsingTypeErasure;
+
+    static void test_bookstore_poly_collection_01() {
+
+        Book cBook{ "C", "Dennis Ritchie", 11.99, 12 };
+        Book javaBook{ "Java", "James Gosling", 17.99, 21 };
+        Book cppBook{ "C++", "Bjarne Stroustrup", 16.99, 4 };
+        Book csharpBook{ "C#", "Anders Hejlsberg", 21.99, 8 };
+
+        Movie movieTarantino{ "Once upon a time in Hollywood", "Quentin Tarantino", 6.99, 3 };
+        Movie movieBond{ "Spectre", "Sam Mendes", 8.99, 6 };
+
+        using MyBookstore = SegregatedBookstore<Book, Movie>;
+
+        MyBookstore bookstore{
+            cBook, movieBond, javaBook, cppBook
+        };
+
+        bookstore.addMedia(csharpBook);
+        bookstore.addMedia(movieTarantino);
+
+        Money balance{ bookstore.totalBalance() };
+        std::println("Total value of Bookstore: {}", balance);
+        size_t count{ bookstore.count() };
+        std::println("Count of elements in Bookstore: {}", count);
+    }
+
+    // =================================================================================
+
+    // number of elements visited per measurement, independent of the store size
+    constexpr size_t ElementsPerMeasurement{ 20000000 };
+
+    template <typename TBookstore>
+    static void measureTotalBalance(std::string_view name, const TBookstore& bookstore, size_t size)
+    {
+        size_t repetitions{ std::max<size_t>(ElementsPerMeasurement / size, 1) };
+
+        const auto begin{ std::chrono::steady_clock::now() };
+
+        // totalBalance is maintained incrementally: measure the full scan
+        Money total{};
+        for (size_t i{}; i != repetitions; ++i) {
+            total += bookstore.recomputeTotalBalance();
+        }
+
+        const auto end{ std::chrono::steady_clock::now() };
+
+        const auto nanoseconds{ std::chrono::duration<double, std::nano>{ end - begin }.count() };
+
+        std::println("  {:<32}{:>8.3f} ns/element  (Total: {})",
+            name, nanoseconds / static_cast<double>(repetitions * size), total);
+    }
+
+    static void test_bookstore_poly_collection_02_benchmark() {
+
+        std::println("Benchmark - recomputeTotalBalance: shared_ptr<IMedia> vs std::variant vs Poly Collection");
+
+        for (size_t size{ 1000 }; size <= 10000000; size *= 10) {
+
+            std::println("Items: {}", size);
+
+            // each store is created in its own scope to limit the memory consumption
+            {
+                BookStoreUsingDynamicPolymorphism::Bookstore bookstore{ };
+
+                for (size_t i{}; i != size; ++i) {
+                    if (i % 2 == 0) {
+                        bookstore.addMedia(std::make_shared<BookStoreUsingDynamicPolymorphism::Book>(
+                            "C", "Dennis Ritchie", 11.99, 12));
+                    }
+                    else {
+                        bookstore.addMedia(std::make_shared<BookStoreUsingDynamicPolymorphism::Movie>(
+                            "Spectre", "Sam Mendes", 8.99, 6));
+                    }
+                }
+
+                measureTotalBalance("std::vector<shared_ptr<IMedia>>", bookstore, size);
+            }
+
+            {
+                Bookstore<Book, Movie> bookstore{ };
+
+                for (size_t i{}; i != size; ++i) {
+                    if (i % 2 == 0) {
+                        bookstore.addMedia(Book{ "C", "Dennis Ritchie", 11.99, 12 });
+                    }
+                    else {
+                        bookstore.addMedia(Movie{ "Spectre", "Sam Mendes", 8.99, 6 });
+                    }
+                }
+
+                measureTotalBalance("std::vector<std::variant>", bookstore, size);
+            }
+
+            {
+                SegregatedBookstore<Book, Movie> bookstore{ };
+
+                for (size_t i{}; i != size; ++i) {
+                    if (i % 2 == 0) {
+                        bookstore.addMedia(Book{ "C", "Dennis Ritchie", 11.99, 12 });
+                    }
+                    else {
+                        bookstore.addMedia(Movie{ "Spectre", "Sam Mendes", 8.99, 6 });
+                    }
+                }
+
+                measureTotalBalance("Poly Collection", bookstore, size);
+            }
+        }
+    }
+}
+
+// =====================================================================================
+
+void main_type_erasure_poly_collection()
+{
+    using namespace BookStoreUsingPolyCollection;
+
+    test_bookstore_poly_collection_01();
+    test_bookstore_poly_collection_02_benchmark();
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
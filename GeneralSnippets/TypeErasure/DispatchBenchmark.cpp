@@ -0,0 +1,345 @@
+// =====================================================================================
+// DispatchBenchmark.cpp // Virtual vs Variant vs CRTP vs Type Erasure vs Function Pointer
+// =====================================================================================
+
+module modern_cpp:type_erasure;
+
+import :sbo_value;
+import :static_vtable;
+import :perf_counter;
+
+namespace DispatchStrategies {
+
+    // every index yields a distinct type with distinct code
+    template <size_t I>
+    class Shape
+    {
+    private:
+        double m_value;
+
+    public:
+        explicit Shape(double value) : m_value{ value } {}
+
+        double compute() const { return m_value * (I + 1) + I; }
+    };
+
+    // ---------------------------------------------------------------------------------
+    // virtual methods
+
+    struct IShape
+    {
+        virtual ~IShape() = default;
+        virtual double compute() const = 0;
+    };
+
+    template <size_t I>
+    class VirtualShape : public IShape
+    {
+    private:
+        Shape<I> m_shape;
+
+    public:
+        explicit VirtualShape(double value) : m_shape{ value } {}
+
+        double compute() const override { return m_shape.compute(); }
+    };
+
+    // ---------------------------------------------------------------------------------
+    // CRTP - static polymorphism, requires one container per type
+
+    template <typename TDerived>
+    class ShapeBase
+    {
+    public:
+        double compute() const { return static_cast<const TDerived*>(this)->computeImpl(); }
+    };
+
+    template <size_t I>
+    class CrtpShape : public ShapeBase<CrtpShape<I>>
+    {
+        friend class ShapeBase<CrtpShape<I>>;
+
+    private:
+        Shape<I> m_shape;
+
+        double computeImpl() const { return m_shape.compute(); }
+
+    public:
+        explicit CrtpShape(double value) : m_shape{ value } {}
+    };
+
+    // ---------------------------------------------------------------------------------
+    // type erasure with small buffer optimization (virtual concept, inline storage)
+
+    using namespace TypeErasureUsingSmallBufferOptimization;
+
+    struct ShapeConcept : public SboConcept<ShapeConcept>
+    {
+        virtual double compute() const = 0;
+    };
+
+    template <typename T>
+    struct ShapeModel : public ShapeConcept
+    {
+        ShapeModel(const T& object) : m_object{ object } {}
+
+        double compute() const override { return m_object.compute(); }
+
+        T m_object;
+    };
+
+    class ErasedShape : public SboValue<ShapeConcept, ShapeModel, 32>
+    {
+    public:
+        using SboValue::SboValue;
+
+        double compute() const { return (*this)->compute(); }
+    };
+
+    // ---------------------------------------------------------------------------------
+    // function pointer stored in the object (inline static vtable)
+
+    using namespace TypeErasureUsingStaticVtables;
+
+    struct ComputeInterface
+    {
+        double (*m_compute)(const void*);
+
+        template <typename T>
+        static constexpr ComputeInterface forType()
+        {
+            return { [](const void* object) { return static_cast<const T*>(object)->compute(); } };
+        }
+    };
+
+    class FunctionPointerShape : public StaticVtableValue<ComputeInterface, 16, VtablePlacement::Inline>
+    {
+    public:
+        using StaticVtableValue::StaticVtableValue;
+
+        double compute() const { return vtable().m_compute(object()); }
+    };
+
+    // =================================================================================
+
+    enum class TypeOrder { Homogeneous, Shuffled };
+    enum class Placement { Contiguous, Scattered };
+
+    // number of calls per measurement, independent of the size of the collection
+    constexpr size_t CallsPerMeasurement{ 10000000 };
+
+    // dispatches a runtime type index to a compile-time index
+    template <size_t NumTypes, typename TFunc>
+    static void withTypeIndex(size_t index, TFunc func)
+    {
+        [&] <size_t... I> (std::index_sequence<I...>) {
+            ((index == I ? (func(std::integral_constant<size_t, I>{}), true) : false) || ...);
+        } (std::make_index_sequence<NumTypes>{});
+    }
+
+    // homogeneous: blocks of objects of the same type, shuffled: random sequence of types
+    static std::vector<size_t> createTypeIndices(size_t size, size_t numTypes, TypeOrder order)
+    {
+        std::vector<size_t> indices(size);
+
+        if (order == TypeOrder::Homogeneous) {
+            for (size_t i{}; i != size; ++i) {
+                indices[i] = i * numTypes / size;
+            }
+        }
+        else {
+            std::mt19937 generator{ 42 };
+            std::uniform_int_distribution<size_t> distribution{ 0, numTypes - 1 };
+            for (auto& index : indices) {
+                index = distribution(generator);
+            }
+        }
+
+        return indices;
+    }
+
+    static std::string toString(TypeOrder order) {
+        return order == TypeOrder::Homogeneous ? "homogeneous" : "shuffled";
+    }
+
+    static std::string toString(Placement placement) {
+        return placement == Placement::Contiguous ? "contiguous" : "scattered";
+    }
+
+    template <typename TFunc>
+    static void measure(std::string_view strategy, std::string_view order,
+        std::string_view placement, size_t size, TFunc visitAll)
+    {
+        size_t repetitions{ std::max<size_t>(CallsPerMeasurement / size, 1) };
+
+        PerfCounter cacheMisses{ PerfEvent::CacheMisses };
+
+        double total{};
+        visitAll(total);    // warm up
+
+        cacheMisses.start();
+        const auto begin{ std::chrono::steady_clock::now() };
+
+        for (size_t i{}; i != repetitions; ++i) {
+            visitAll(total);
+        }
+
+        const auto end{ std::chrono::steady_clock::now() };
+        const auto misses{ cacheMisses.stop() };
+
+        const double calls{ static_cast<double>(repetitions * size) };
+        const double nanoseconds{ std::chrono::duration<double, std::nano>{ end - begin }.count() };
+
+        std::string missesPerCall{ "-" };
+        if (misses.has_value()) {
+            missesPerCall = std::to_string(static_cast<double>(misses.value()) / calls);
+        }
+
+        std::println("{:>10} {:<16} {:<12} {:<11} {:>8.3f} {:>12}   ({:.0f})",
+            size, strategy, order, placement, nanoseconds / calls, missesPerCall, total);
+    }
+
+    template <size_t NumTypes>
+    static void benchmarkVirtual(size_t size, TypeOrder order, Placement placement)
+    {
+        const auto types{ createTypeIndices(size, NumTypes, order) };
+
+        // scattered: the objects are allocated in random order,
+        // iterating the vector jumps back and forth in the heap
+        std::vector<size_t> allocationOrder(size);
+        std::iota(allocationOrder.begin(), allocationOrder.end(), 0);
+        if (placement == Placement::Scattered) {
+            std::shuffle(allocationOrder.begin(), allocationOrder.end(), std::mt19937{ 42 });
+        }
+
+        std::vector<std::unique_ptr<IShape>> shapes(size);
+        for (size_t i : allocationOrder) {
+            withTypeIndex<NumTypes>(types[i], [&](auto index) {
+                shapes[i] = std::make_unique<VirtualShape<index>>(static_cast<double>(i % 100));
+            });
+        }
+
+        measure("virtual", toString(order), toString(placement), size, [&](double& total) {
+            for (const auto& shape : shapes) {
+                total += shape->compute();
+            }
+        });
+    }
+
+    template <size_t NumTypes>
+    static void benchmarkVariant(size_t size, TypeOrder order)
+    {
+        using Variant = decltype([] <size_t... I> (std::index_sequence<I...>) {
+            return std::variant<Shape<I>...>{ Shape<0>{ 0.0 } };
+        } (std::make_index_sequence<NumTypes>{}));
+
+        const auto types{ createTypeIndices(size, NumTypes, order) };
+
+        std::vector<Variant> shapes;
+        shapes.reserve(size);
+        for (size_t i{}; i != size; ++i) {
+            withTypeIndex<NumTypes>(types[i], [&](auto index) {
+                shapes.push_back(Shape<index>{ static_cast<double>(i % 100) });
+            });
+        }
+
+        measure("std::variant", toString(order), toString(Placement::Contiguous), size, [&](double& total) {
+            for (const auto& shape : shapes) {
+                total += std::visit([](const auto& s) { return s.compute(); }, shape);
+            }
+        });
+    }
+
+    template <size_t NumTypes>
+    static void benchmarkCrtp(size_t size)
+    {
+        using Collection = decltype([] <size_t... I> (std::index_sequence<I...>) {
+            return std::tuple<std::vector<CrtpShape<I>>...>{};
+        } (std::make_index_sequence<NumTypes>{}));
+
+        // the order of types is lost: each type lives in its own vector
+        const auto types{ createTypeIndices(size, NumTypes, TypeOrder::Shuffled) };
+
+        Collection shapes;
+        for (size_t i{}; i != size; ++i) {
+            withTypeIndex<NumTypes>(types[i], [&](auto index) {
+                std::get<index>(shapes).push_back(CrtpShape<index>{ static_cast<double>(i % 100) });
+            });
+        }
+
+        measure("CRTP", "per type", toString(Placement::Contiguous), size, [&](double& total) {
+            std::apply([&](const auto& ... vectors) {
+                ([&] {
+                    for (const auto& shape : vectors) {
+                        total += shape.compute();
+                    }
+                } (), ...);
+            }, shapes);
+        });
+    }
+
+    template <typename TShape, size_t NumTypes>
+    static void benchmarkValueSemantic(std::string_view name, size_t size, TypeOrder order)
+    {
+        const auto types{ createTypeIndices(size, NumTypes, order) };
+
+        std::vector<TShape> shapes;
+        shapes.reserve(size);
+        for (size_t i{}; i != size; ++i) {
+            withTypeIndex<NumTypes>(types[i], [&](auto index) {
+                shapes.push_back(Shape<index>{ static_cast<double>(i % 100) });
+            });
+        }
+
+        measure(name, toString(order), toString(Placement::Contiguous), size, [&](double& total) {
+            for (const auto& shape : shapes) {
+                total += shape.compute();
+            }
+        });
+    }
+
+    template <size_t NumTypes>
+    static void benchmarkDispatch(size_t maxSize)
+    {
+        std::println("Number of types: {}", NumTypes);
+        std::println("{:>10} {:<16} {:<12} {:<11} {:>8} {:>12}",
+            "Objects", "Strategy", "Types", "Memory", "ns/call", "misses/call");
+
+        for (size_t size{ 100 }; size <= maxSize; size *= 10) {
+
+            for (auto order : { TypeOrder::Homogeneous, TypeOrder::Shuffled }) {
+                benchmarkVirtual<NumTypes>(size, order, Placement::Contiguous);
+                benchmarkVirtual<NumTypes>(size, order, Placement::Scattered);
+                benchmarkVariant<NumTypes>(size, order);
+                benchmarkValueSemantic<ErasedShape, NumTypes>("type erasure", size, order);
+                benchmarkValueSemantic<FunctionPointerShape, NumTypes>("function pointer", size, order);
+            }
+
+            benchmarkCrtp<NumTypes>(size);
+        }
+
+        std::println();
+    }
+
+    static void test_dispatch_benchmark()
+    {
+        constexpr size_t MaxSize{ 10000000 };
+
+        benchmarkDispatch<2>(MaxSize);
+        benchmarkDispatch<8>(MaxSize);
+        benchmarkDispatch<32>(MaxSize);
+    }
+}
+
+// =====================================================================================
+
+void main_type_erasure_dispatch_benchmark()
+{
+    using namespace DispatchStrategies;
+
+    test_dispatch_benchmark();
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
@@ -7,6 +7,14 @@ export module modern_cpp:type_erasure;
 import std;
 
 export void main_type_erasure();
+export void main_type_erasure_sbo();
+export void main_type_erasure_static_vtable();
+export void main_type_erasure_poly_collection();
+export void main_type_erasure_dispatch_benchmark();
+export void main_type_erasure_arena();
+export void main_type_erasure_concurrent();
+export void main_type_erasure_catalog();
+export void main_type_erasure_index();
 
 // =====================================================================================
 // End-of-File
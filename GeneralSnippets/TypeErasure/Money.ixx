@@ -0,0 +1,269 @@
+// =====================================================================================
+// Money.ixx // Fixed-Point Type for Exact Currency Amounts
+// =====================================================================================
+
+export module modern_cpp:money;
+
+import std;
+
+// an amount is stored as integral multiple of 1 / Scale, with Scale = 100: in cents.
+// contrary to 'double', additions are exact and associative - a sum doesn't depend
+// on the order of the additions, it may be split across threads or SIMD lanes.
+// all arithmetic operations check for overflow and throw 'std::overflow_error'
+
+namespace BookStoreMoney {
+
+    constexpr bool isPowerOf10(std::int64_t value)
+    {
+        while (value % 10 == 0) {
+            value /= 10;
+        }
+        return value == 1;
+    }
+
+    template <std::int64_t Scale = 100>
+        requires (Scale > 0 && isPowerOf10(Scale))
+    class BasicMoney
+    {
+    private:
+        std::int64_t m_units;
+
+        constexpr explicit BasicMoney(std::int64_t units) noexcept : m_units{ units } {}
+
+    public:
+        static constexpr std::int64_t scale{ Scale };
+
+        // c'tors
+        constexpr BasicMoney() noexcept : m_units{} {}
+
+        static constexpr BasicMoney fromUnits(std::int64_t units) noexcept {
+            return BasicMoney{ units };
+        }
+
+        // rounds to the nearest unit: 11.99 is stored as 1199 cents, not as 1198.99...
+        static BasicMoney fromDouble(double amount) {
+
+            constexpr double Limit{ 9223372036854775808.0 };    // 2^63
+
+            const double scaled{ amount * static_cast<double>(Scale) };
+
+            if (!std::isfinite(scaled) || scaled >= Limit || scaled < -Limit) {
+                throw std::overflow_error{ "Money: amount out of range" };
+            }
+
+            return BasicMoney{ static_cast<std::int64_t>(std::llround(scaled)) };
+        }
+
+        // getter
+        constexpr std::int64_t units() const noexcept { return m_units; }
+
+        double toDouble() const noexcept {
+            return static_cast<double>(m_units) / static_cast<double>(Scale);
+        }
+
+        // arithmetic operators
+        constexpr BasicMoney& operator+= (BasicMoney other) {
+            m_units = checkedAdd(m_units, other.m_units);
+            return *this;
+        }
+
+        constexpr BasicMoney& operator-= (BasicMoney other) {
+            m_units = checkedSubtract(m_units, other.m_units);
+            return *this;
+        }
+
+        friend constexpr BasicMoney operator+ (BasicMoney lhs, BasicMoney rhs) {
+            return lhs += rhs;
+        }
+
+        friend constexpr BasicMoney operator- (BasicMoney lhs, BasicMoney rhs) {
+            return lhs -= rhs;
+        }
+
+        constexpr BasicMoney operator- () const {
+            return BasicMoney{ checkedSubtract(0, m_units) };
+        }
+
+        // price * count
+        template <typename T>
+            requires std::integral<T>
+        friend constexpr BasicMoney operator* (BasicMoney money, T factor) {
+            return BasicMoney{ checkedMultiply(money.m_units, toUnits(factor)) };
+        }
+
+        template <typename T>
+            requires std::integral<T>
+        friend constexpr BasicMoney operator* (T factor, BasicMoney money) {
+            return money * factor;
+        }
+
+        // multiply-accumulate: *this += price * count
+        template <typename T>
+            requires std::integral<T>
+        constexpr BasicMoney& multiplyAdd(BasicMoney price, T count) {
+            m_units = checkedAdd(m_units, checkedMultiply(price.m_units, toUnits(count)));
+            return *this;
+        }
+
+        // comparison operators
+        friend constexpr auto operator<=> (BasicMoney, BasicMoney) = default;
+
+        // "-1234.56"
+        std::string toString() const {
+
+            // magnitude as unsigned value: the negation of the minimum doesn't overflow
+            const std::uint64_t magnitude{
+                m_units < 0 ? std::uint64_t{ 0 } - static_cast<std::uint64_t>(m_units) : static_cast<std::uint64_t>(m_units)
+            };
+
+            std::string result{ m_units < 0 ? "-" : "" };
+            result += std::to_string(magnitude / Scale);
+
+            if constexpr (Scale > 1) {
+                std::string fraction{ std::to_string(magnitude % Scale) };
+                result += '.';
+                result += std::string(Digits - fraction.size(), '0');
+                result += fraction;
+            }
+
+            return result;
+        }
+
+        friend std::ostream& operator<< (std::ostream& os, BasicMoney money) {
+            return os << money.toString();
+        }
+
+        // exact sum of prices[i] * counts[i]. blocks, in which no product and no partial sum
+        // can overflow, are summed without checks: this loop can be vectorized by the compiler.
+        // the result is the same for every split of the data, only overflow is detected per block
+        static BasicMoney sumOfProducts(std::span<const BasicMoney> prices, std::span<const std::uint64_t> counts) {
+
+            if (prices.size() != counts.size()) {
+                throw std::invalid_argument{ "Money: columns of different length" };
+            }
+
+            constexpr size_t BlockSize{ 1024 };
+
+            BasicMoney total{};
+
+            for (size_t begin{}; begin < prices.size(); begin += BlockSize) {
+
+                const size_t end{ std::min(begin + BlockSize, prices.size()) };
+
+                std::uint64_t maxPrice{};
+                std::uint64_t maxCount{};
+
+                for (size_t i{ begin }; i != end; ++i) {
+                    const std::int64_t units{ prices[i].m_units };
+                    maxPrice = std::max(maxPrice, static_cast<std::uint64_t>(units < 0 ? -(units + 1) : units) + 1);
+                    maxCount = std::max(maxCount, counts[i]);
+                }
+
+                // |sum of block| <= length * maxPrice * maxCount
+                const std::uint64_t length{ end - begin };
+                const std::uint64_t limit{ static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) };
+
+                if (maxCount == 0 || maxPrice <= limit / length / maxCount) {
+
+                    std::int64_t sum{};
+                    for (size_t i{ begin }; i != end; ++i) {
+                        sum += prices[i].m_units * static_cast<std::int64_t>(counts[i]);
+                    }
+
+                    total += BasicMoney{ sum };
+                }
+                else {
+                    for (size_t i{ begin }; i != end; ++i) {
+                        total.multiplyAdd(prices[i], counts[i]);
+                    }
+                }
+            }
+
+            return total;
+        }
+
+    private:
+        static constexpr size_t Digits{ [] {
+            size_t digits{};
+            for (std::int64_t scale{ Scale }; scale != 1; scale /= 10) {
+                ++digits;
+            }
+            return digits;
+        } () };
+
+        template <typename T>
+        static constexpr std::int64_t toUnits(T value) {
+
+            if (!std::in_range<std::int64_t>(value)) {
+                throw std::overflow_error{ "Money: factor out of range" };
+            }
+
+            return static_cast<std::int64_t>(value);
+        }
+
+        static constexpr std::int64_t checkedAdd(std::int64_t a, std::int64_t b) {
+
+            constexpr std::int64_t Max{ std::numeric_limits<std::int64_t>::max() };
+            constexpr std::int64_t Min{ std::numeric_limits<std::int64_t>::min() };
+
+            if ((b > 0 && a > Max - b) || (b < 0 && a < Min - b)) {
+                throw std::overflow_error{ "Money: overflow in addition" };
+            }
+
+            return a + b;
+        }
+
+        static constexpr std::int64_t checkedSubtract(std::int64_t a, std::int64_t b) {
+
+            constexpr std::int64_t Max{ std::numeric_limits<std::int64_t>::max() };
+            constexpr std::int64_t Min{ std::numeric_limits<std::int64_t>::min() };
+
+            if ((b < 0 && a > Max + b) || (b > 0 && a < Min + b)) {
+                throw std::overflow_error{ "Money: overflow in subtraction" };
+            }
+
+            return a - b;
+        }
+
+        static constexpr std::int64_t checkedMultiply(std::int64_t a, std::int64_t b) {
+
+            // fast path: the product of two 32-bit values always fits
+            if (std::in_range<std::int32_t>(a) && std::in_range<std::int32_t>(b)) {
+                return a * b;
+            }
+
+            constexpr std::int64_t Max{ std::numeric_limits<std::int64_t>::max() };
+            constexpr std::int64_t Min{ std::numeric_limits<std::int64_t>::min() };
+
+            bool overflow{};
+            if (a > 0) {
+                overflow = (b > 0) ? a > Max / b : b < Min / a;
+            }
+            else if (a < 0) {
+                overflow = (b > 0) ? a < Min / b : b < Max / a;
+            }
+
+            if (overflow) {
+                throw std::overflow_error{ "Money: overflow in multiplication" };
+            }
+
+            return a * b;
+        }
+    };
+
+    using Money = BasicMoney<100>;
+}
+
+// formatting support: the width and alignment are applied to the textual representation,
+// for example std::println("{:>12}", money)
+template <std::int64_t Scale>
+struct std::formatter<BookStoreMoney::BasicMoney<Scale>> : std::formatter<std::string_view>
+{
+    auto format(const BookStoreMoney::BasicMoney<Scale>& money, std::format_context& ctx) const {
+        return std::formatter<std::string_view>::format(money.toString(), ctx);
+    }
+};
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
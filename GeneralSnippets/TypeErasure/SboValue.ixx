@@ -0,0 +1,203 @@
+// =====================================================================================
+// SboValue.ixx // Value Semantic Type Erasure with Small Buffer Optimization
+// =====================================================================================
+
+export module modern_cpp:sbo_value;
+
+import std;
+
+namespace TypeErasureUsingSmallBufferOptimization {
+
+    // base of every concept used with 'SboValue':
+    // copying and moving are part of the erased interface
+    template <typename TConcept>
+    struct SboConcept
+    {
+        virtual ~SboConcept() = default;
+
+        // copies the object into 'buffer' or onto the heap, if it doesn't fit
+        virtual TConcept* copyInto(std::byte* buffer) const = 0;
+
+        // moves an object stored inline into 'buffer'
+        virtual TConcept* moveInto(std::byte* buffer) noexcept = 0;
+    };
+
+    template <typename TConcept, template <typename> class TModel, size_t BufferSize = 32>
+        requires std::is_base_of_v<SboConcept<TConcept>, TConcept>
+    class SboValue
+    {
+    private:
+        enum class Storage : unsigned char { Inline, Relocatable, Heap };
+
+        // completes the user defined model with the copy and move operations
+        template <typename T>
+        struct Holder final : public TModel<T>
+        {
+            template <typename TArg>
+            Holder(TArg&& object) : TModel<T>{ std::forward<TArg>(object) } {}
+
+            Holder(const Holder&) = default;
+            Holder(Holder&&) = default;
+
+            TConcept* copyInto(std::byte* buffer) const override
+            {
+                if constexpr (storageOf<T>() == Storage::Heap) {
+                    return new Holder{ *this };
+                }
+                else {
+                    return new (buffer) Holder{ *this };
+                }
+            }
+
+            TConcept* moveInto(std::byte* buffer) noexcept override
+            {
+                if constexpr (storageOf<T>() == Storage::Heap) {
+                    return this;    // never called: heap objects are moved by pointer
+                }
+                else {
+                    return new (buffer) Holder{ std::move(*this) };
+                }
+            }
+        };
+
+        // objects are stored inline, if they fit into the buffer and can be moved without exceptions;
+        // trivially copyable objects are relocated with 'std::memcpy' (including the vtable pointer
+        // of the holder - this is what every major ABI allows, see P1144 'trivially relocatable')
+        template <typename T>
+        static constexpr Storage storageOf()
+        {
+            if constexpr (sizeof(Holder<T>) > BufferSize ||
+                alignof(Holder<T>) > alignof(std::max_align_t) ||
+                !std::is_nothrow_move_constructible_v<T>)
+            {
+                return Storage::Heap;
+            }
+            else if constexpr (std::is_trivially_copyable_v<T>) {
+                return Storage::Relocatable;
+            }
+            else {
+                return Storage::Inline;
+            }
+        }
+
+        alignas(std::max_align_t) std::byte m_buffer[BufferSize];
+        TConcept* m_object;
+        Storage   m_storage;
+
+    public:
+        // c'tors / d'tor
+        // a constrained model rejects types, that don't fulfill the concept
+        template <typename T>
+            requires (!std::is_base_of_v<SboValue, std::remove_cvref_t<T>>) &&
+                requires { typename TModel<std::remove_cvref_t<T>>; }
+        SboValue(T&& object) : m_storage{ storageOf<std::remove_cvref_t<T>>() }
+        {
+            using Model = Holder<std::remove_cvref_t<T>>;
+
+            if constexpr (storageOf<std::remove_cvref_t<T>>() == Storage::Heap) {
+                m_object = new Model{ std::forward<T>(object) };
+            }
+            else {
+                m_object = new (m_buffer) Model{ std::forward<T>(object) };
+            }
+        }
+
+        // a moved-from object is empty - copying or moving it yields an empty object, too
+        SboValue(const SboValue& other)
+            : m_object{ other.m_object != nullptr ? other.m_object->copyInto(m_buffer) : nullptr },
+              m_storage{ other.m_storage }
+        {}
+
+        SboValue(SboValue&& other) noexcept : m_object{}, m_storage{ other.m_storage }
+        {
+            moveFrom(other);
+        }
+
+        ~SboValue()
+        {
+            reset();
+        }
+
+        // assignment
+        SboValue& operator= (const SboValue& other)
+        {
+            if (this != &other) {
+                SboValue tmp{ other };
+                reset();
+                m_storage = tmp.m_storage;
+                moveFrom(tmp);
+            }
+            return *this;
+        }
+
+        SboValue& operator= (SboValue&& other) noexcept
+        {
+            if (this != &other) {
+                reset();
+                m_storage = other.m_storage;
+                moveFrom(other);
+            }
+            return *this;
+        }
+
+        // access to the erased interface
+        TConcept* operator->() { return m_object; }
+        const TConcept* operator->() const { return m_object; }
+
+        bool isInline() const { return m_storage != Storage::Heap; }
+        bool isRelocatable() const { return m_storage == Storage::Relocatable; }
+
+        static constexpr size_t bufferSize() { return BufferSize; }
+
+    private:
+        void moveFrom(SboValue& other) noexcept
+        {
+            if (other.m_object == nullptr) {
+                m_object = nullptr;
+                return;
+            }
+
+            switch (m_storage)
+            {
+            case Storage::Heap:
+                m_object = other.m_object;
+                other.m_object = nullptr;
+                break;
+
+            case Storage::Relocatable: {
+                // copy the bytes - the source must not be destroyed afterwards
+                std::memcpy(m_buffer, other.m_buffer, BufferSize);
+                auto offset{ reinterpret_cast<std::byte*>(other.m_object) - other.m_buffer };
+                m_object = std::launder(reinterpret_cast<TConcept*>(m_buffer + offset));
+                other.m_object = nullptr;
+                break;
+            }
+
+            case Storage::Inline:
+                m_object = other.m_object->moveInto(m_buffer);
+                other.reset();
+                break;
+            }
+        }
+
+        void reset() noexcept
+        {
+            if (m_object == nullptr) {
+                return;
+            }
+
+            if (m_storage == Storage::Heap) {
+                delete m_object;
+            }
+            else {
+                m_object->~TConcept();
+            }
+
+            m_object = nullptr;
+        }
+    };
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
@@ -0,0 +1,137 @@
+// =====================================================================================
+// StaticVtable.ixx // Type Erasure with Manual (Static) Function Pointer Tables
+// =====================================================================================
+
+export module modern_cpp:static_vtable;
+
+import std;
+
+namespace TypeErasureUsingStaticVtables {
+
+    // life cycle of the erased object - shared by all interfaces
+    struct Lifecycle
+    {
+        void (*m_copy)(void* dst, const void* src);
+        void (*m_move)(void* dst, void* src) noexcept;
+        void (*m_destroy)(void* object) noexcept;
+    };
+
+    template <typename T>
+    constexpr Lifecycle LifecycleFor
+    {
+        [](void* dst, const void* src) { new (dst) T{ *static_cast<const T*>(src) }; },
+        [](void* dst, void* src) noexcept { new (dst) T{ std::move(*static_cast<T*>(src)) }; },
+        [](void* object) noexcept { static_cast<T*>(object)->~T(); }
+    };
+
+    // 'TInterface' is a struct of function pointers with a static member function template
+    //
+    //     template <typename T> static constexpr TInterface forType();
+    //
+    // returning the table for the concrete type T
+    template <typename TInterface>
+    concept StaticInterface = std::is_class_v<TInterface> && std::is_trivially_copyable_v<TInterface>;
+
+    // one table per interface and concrete type, evaluated at compile time
+    template <typename TInterface, typename T>
+    constexpr TInterface InterfaceFor{ TInterface::template forType<T>() };
+
+    enum class VtablePlacement { Remote, Inline };
+
+    // Remote: the object stores a pointer to the table (like a vtable pointer)
+    // Inline: the object stores a copy of the table - one indirection less per call,
+    //         worthwhile for interfaces with one or two methods
+    template <typename TInterface, size_t BufferSize = 32, VtablePlacement Placement = VtablePlacement::Remote>
+        requires StaticInterface<TInterface>
+    class StaticVtableValue
+    {
+    private:
+        using VtableType = std::conditional_t<
+            Placement == VtablePlacement::Inline, TInterface, const TInterface*
+        >;
+
+        alignas(std::max_align_t) std::byte m_buffer[BufferSize];
+        const Lifecycle* m_lifecycle;
+        VtableType       m_vtable;
+
+    public:
+        // c'tors / d'tor
+        template <typename T>
+            requires (!std::is_base_of_v<StaticVtableValue, std::remove_cvref_t<T>>)
+        StaticVtableValue(T&& object)
+            : m_lifecycle{ &LifecycleFor<std::remove_cvref_t<T>> }, m_vtable{}
+        {
+            using Type = std::remove_cvref_t<T>;
+
+            static_assert(sizeof(Type) <= BufferSize, "Object doesn't fit into buffer");
+            static_assert(alignof(Type) <= alignof(std::max_align_t), "Over-aligned object");
+            static_assert(std::is_nothrow_move_constructible_v<Type>);
+
+            if constexpr (Placement == VtablePlacement::Inline) {
+                m_vtable = InterfaceFor<TInterface, Type>;
+            }
+            else {
+                m_vtable = &InterfaceFor<TInterface, Type>;
+            }
+
+            new (m_buffer) Type{ std::forward<T>(object) };
+        }
+
+        StaticVtableValue(const StaticVtableValue& other)
+            : m_lifecycle{ other.m_lifecycle }, m_vtable{ other.m_vtable }
+        {
+            m_lifecycle->m_copy(m_buffer, other.m_buffer);
+        }
+
+        StaticVtableValue(StaticVtableValue&& other) noexcept
+            : m_lifecycle{ other.m_lifecycle }, m_vtable{ other.m_vtable }
+        {
+            m_lifecycle->m_move(m_buffer, other.m_buffer);
+        }
+
+        ~StaticVtableValue()
+        {
+            m_lifecycle->m_destroy(m_buffer);
+        }
+
+        // assignment
+        StaticVtableValue& operator= (const StaticVtableValue& other)
+        {
+            if (this != &other) {
+                StaticVtableValue tmp{ other };
+                *this = std::move(tmp);
+            }
+            return *this;
+        }
+
+        StaticVtableValue& operator= (StaticVtableValue&& other) noexcept
+        {
+            if (this != &other) {
+                m_lifecycle->m_destroy(m_buffer);
+                m_lifecycle = other.m_lifecycle;
+                m_vtable = other.m_vtable;
+                m_lifecycle->m_move(m_buffer, other.m_buffer);
+            }
+            return *this;
+        }
+
+    protected:
+        // used by the derived class to dispatch the calls of its interface
+        const TInterface& vtable() const
+        {
+            if constexpr (Placement == VtablePlacement::Inline) {
+                return m_vtable;
+            }
+            else {
+                return *m_vtable;
+            }
+        }
+
+        const void* object() const { return m_buffer; }
+        void* object() { return m_buffer; }
+    };
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
@@ -8,6 +8,9 @@ module;
 
 module modern_cpp:type_erasure;
 
+import :bookstore;
+import :money;
+
 namespace {
     size_t MaxIterations = 1000000;
     //size_t MaxIterations = 100000;
@@ -227,100 +230,6 @@ namespace TypeErasureUsingTemplateTechniquesAndConcepts {
 
 namespace BookStoreUsingDynamicPolymorphism {
 
-    struct IMedia
-    {
-        virtual ~IMedia() = default;
-
-        virtual double getPrice() const = 0;
-        virtual size_t getCount() const = 0;
-    };
-
-    class Book : public IMedia
-    {
-    private:
-        std::string m_author;
-        std::string m_title;
-        double      m_price;
-        size_t      m_count;
-
-    public:
-        // c'tor
-        Book(std::string author, std::string title, double price, size_t count)
-            : m_author{ author }, m_title{ title }, m_price{ price }, m_count{ count }
-        {}
-
-        // getter / setter
-        std::string getAuthor() const { return m_author; }
-        std::string getTitle() const { return m_title; }
-
-        // interface 'IMedia'
-        double getPrice() const override { return m_price; }
-        size_t getCount() const override { return m_count; }
-    };
-
-    class Movie : public IMedia
-    {
-    private:
-        std::string m_title;
-        std::string m_director;
-        double      m_price;
-        size_t      m_count;
-
-    public:
-        // c'tor
-        Movie(std::string title, std::string director, double price, size_t count)
-            : m_title{ title }, m_director{ director }, m_price{ price }, m_count{ count }
-        { }
-
-        // getter / setter
-        std::string getTitle() const { return m_title; }
-        std::string getDirector() const { return m_director; }
-
-        // interface 'IMedia'
-        double getPrice() const override { return m_price; }
-        size_t getCount() const override { return m_count; }
-    };
-
-    class Bookstore
-    {
-    private:
-        using Stock = std::vector<std::shared_ptr<IMedia>>;
-        using StockList = std::initializer_list<std::shared_ptr<IMedia>>;
-
-        Stock m_stock;
-
-    public:
-        // c'tor
-        explicit Bookstore(StockList stock) : m_stock{ stock } {}
-
-        // public interface
-        double totalBalance() const {
-
-            double total{};
-
-            for (const auto& media : m_stock) {
-                total += media->getPrice() * media->getCount();
-            }
-
-            return total;
-        }
-
-        size_t count() const {
-
-            size_t total{};
-
-            for (const auto& media : m_stock) {
-                total += media->getCount();
-            }
-
-            return total;
-        }
-
-        void addMedia(const std::shared_ptr<IMedia>& media) {
-            m_stock.push_back(media);
-        }
-    };
-
     static void test_bookstore_polymorphic_01() {
 
         std::shared_ptr<IMedia> cBook{ std::make_shared<Book>("C", "Dennis Ritchie", 11.99, 12) };
@@ -335,8 +244,8 @@ namespace BookStoreUsingDynamicPolymorphism {
             cBook, movieBond, javaBook, cppBook, csharpBook, movieTarantino
         };
 
-        double balance{ bookstore.totalBalance() };
-        std::println("Total value of Bookstore: {:.{}f}", balance, 2);
+        Money balance{ bookstore.totalBalance() };
+        std::println("Total value of Bookstore: {}", balance);
 
         size_t count{ bookstore.count() };
         std::println("Count of elements in Bookstore: {}", count);
@@ -389,182 +298,58 @@ namespace BookStoreUsingDynamicPolymorphism {
 
         ScopedTimer watch{};
 
-        double total{};
+        Money total{};
         for (size_t i{}; i != MaxIterations; ++i) {
-            double totalBalance{ bookstore.totalBalance() };
+            Money totalBalance{ bookstore.totalBalance() };
             total += totalBalance;
         }
 
         std::print("Done: ");
     }
-}
 
-// =====================================================================================
+    static void test_bookstore_polymorphic_05() {
 
-namespace BookStoreUsingTypeErasure {
+        std::println("Maintained Aggregates - using Polymorphism");
 
-    class Book
-    {
-    private:
-        std::string m_author;
-        std::string m_title;
-        double      m_price;
-        size_t      m_count;
-
-    public:
-        // c'tor
-        Book(std::string author, std::string title, double price, size_t count)
-            : m_author{ author }, m_title{ title }, m_price{ price }, m_count{ count }
-        {}
-
-        // getter / setter
-        std::string getAuthor() const { return m_author; }
-        std::string getTitle() const { return m_title; }
-
-        double getPrice() const { return m_price; }
-        size_t getCount() const { return m_count; }
-    };
-
-    class Movie
-    {
-    private:
-        std::string m_title;
-        std::string m_director;
-        double      m_price;
-        size_t      m_count;
-
-    public:
-        // c'tor
-        Movie(std::string title, std::string director, double price, size_t count)
-            : m_title{ title }, m_director{ director }, m_price{ price }, m_count{ count }
-        { }
-
-        // getter / setter
-        std::string getTitle() const { return m_title; }
-        std::string getDirector() const { return m_director; }
-
-        double getPrice() const { return m_price; }
-        size_t getCount() const { return m_count; }
-    };
-
-    template<typename T>
-    concept MediaConcept = requires (const T & m)
-    {
-        { m.getPrice() } -> std::same_as<double>;
-        { m.getCount() } -> std::same_as<size_t>;
-    };
-
-    template <typename ... TMedia>
-        requires (MediaConcept<TMedia> && ...)
-    class Bookstore
-    {
-    private:
-        using StockType = std::variant<TMedia ...>;
-        using Stock     = std::vector<StockType>;
-        using StockList = std::initializer_list<StockType>;
-
-        Stock m_stock;
-
-    public:
-        explicit Bookstore(StockList stock) : m_stock{ stock } {}
-
-        // template member method
-        template <typename T>
-            requires MediaConcept<T>
-        void addMedia(const T& media) {
-            // m_stock.push_back(StockType{ media });  // detailed notation
-            m_stock.push_back(media);                  // implicit type conversion (T => std::variant<T>)
-        }
-
-        // or
-        void addMediaEx(const MediaConcept auto& media) {
-            m_stock.push_back(media);
-        }
-
-        // public interface
-        double totalBalance() const {
-
-            double total{};
-
-            for (const auto& media : m_stock) {
-
-                double price{};
-                size_t count{};
-
-                std::visit(
-                    [&](const auto& element) {
-                        price = element.getPrice();
-                        count = element.getCount();
-                    },
-                    media
-                );
-
-                total += price * count;
-            }
-
-            return total;
-        }
+        Bookstore bookstore{
+            std::make_shared<Book>("C", "Dennis Ritchie", 11.99, 12),
+            std::make_shared<Movie>("Spectre", "Sam Mendes", 8.99, 6)
+        };
 
-        size_t count() const {
+        bookstore.addMedia(std::make_shared<Book>("C++", "Bjarne Stroustrup", 16.99, 4));
+        std::println("Total value: {}, Count: {}", bookstore.totalBalance(), bookstore.count());
 
-            size_t total{};
+        bookstore.setPrice(0, 12.99);
+        bookstore.setCount(1, 10);
+        bookstore.removeMedia(2);
+        std::println("Total value: {}, Count: {}", bookstore.totalBalance(), bookstore.count());
 
-            for (const auto& media : m_stock) {
+        std::println("Aggregates verified: {}", bookstore.checkAggregates());
+    }
 
-                size_t count{};
+    static void test_bookstore_polymorphic_06() {
 
-                std::visit(
-                    [&](const auto& element) {
-                        count = element.getCount();
-                    },
-                    media
-                );
+        std::println("Overflow of the Total Value - using Polymorphism");
 
-                total += count;
-            }
+        // each value fits into 'Money', the sum of both doesn't
+        Bookstore bookstore{ std::make_shared<Book>("C", "Dennis Ritchie", 5e13, 1000) };
 
-            return total;
+        try {
+            bookstore.addMedia(std::make_shared<Book>("C++", "Bjarne Stroustrup", 5e13, 1000));
         }
-
-        // -----------------------------------------------
-        // demonstrating std::visit with returning a value
-
-        double totalBalanceEx() const {
-
-            double total{};
-
-            for (const auto& media : m_stock) {
-
-                total += std::visit(
-                    [](const auto& element) {
-                        double price = element.getPrice();
-                        size_t count = element.getCount();
-                        return price * count;
-                    },
-                    media
-                );
-            }
-
-            return total;
+        catch (const std::overflow_error& ex) {
+            std::println("Exception: {}", ex.what());
         }
 
-        size_t countEx() const {
-
-            size_t total{};
-
-            for (const auto& element : m_stock) {
+        // the bookstore remains unchanged
+        std::println("Size: {}, Count: {}, Total value: {}", bookstore.size(), bookstore.count(), bookstore.totalBalance());
+        std::println("Aggregates verified: {}", bookstore.checkAggregates());
+    }
+}
 
-                total += std::visit(
-                    [](const auto& element) {
-                        return element.getCount();
-                    },
-                    element
-                );
-            }
+// =====================================================================================
 
-            return total;
-        }
-    };
+namespace BookStoreUsingTypeErasure {
 
     static void test_bookstore_type_erasure_01() {
 
@@ -582,8 +367,8 @@ namespace BookStoreUsingTypeErasure {
             cBook, movieBond, javaBook, cppBook, csharpBook, movieTarantino
         };
 
-        double balance{ bookstore.totalBalance() };
-        std::println("Total value of Bookstore: {:.{}f}", balance, 2);
+        Money balance{ bookstore.totalBalance() };
+        std::println("Total value of Bookstore: {}", balance);
         size_t count{ bookstore.count() };
         std::println("Count of elements in Bookstore: {}", count);
     }
@@ -637,9 +422,9 @@ namespace BookStoreUsingTypeErasure {
 
         ScopedTimer watch{};
 
-        double total{};
+        Money total{};
         for (size_t i{}; i != MaxIterations; ++i) {
-            double totalBalance{ bookstore.totalBalance() };
+            Money totalBalance{ bookstore.totalBalance() };
             total += totalBalance;
         }
 
@@ -661,6 +446,91 @@ namespace BookStoreUsingTypeErasure {
         // verifying concept 'MediaConcept'
         Bookstore<Book, BluRay, Movie> bookstore{};
     }
+
+    static void test_bookstore_type_erasure_06() {
+
+        std::println("Maintained Aggregates - using Type Erasure");
+
+        Bookstore<Book, Movie> bookstore{
+            Book{ "C", "Dennis Ritchie", 11.99, 12 },
+            Movie{ "Spectre", "Sam Mendes", 8.99, 6 }
+        };
+
+        bookstore.addMedia(Book{ "C++", "Bjarne Stroustrup", 16.99, 4 });
+        std::println("Total value: {}, Count: {}", bookstore.totalBalance(), bookstore.count());
+
+        bookstore.setPrice(0, 12.99);
+        bookstore.setCount(1, 10);
+        bookstore.removeMedia(2);
+        std::println("Total value: {}, Count: {}", bookstore.totalBalance(), bookstore.count());
+
+        std::println("Aggregates verified: {}", bookstore.checkAggregates());
+    }
+
+    static void test_bookstore_type_erasure_07() {
+
+        std::println("Exact Amounts - double vs Money");
+
+        std::vector<double> prices{ 0.1, 0.2, 0.3, 1e15, -1e15 };
+
+        // the sum of doubles depends on the order of the additions
+        double forward{ std::accumulate(prices.begin(), prices.end(), 0.0) };
+        double backward{ std::accumulate(prices.rbegin(), prices.rend(), 0.0) };
+        std::println("double: {} != {}", forward, backward);
+
+        Money moneyForward{};
+        for (double price : prices) {
+            moneyForward += Money::fromDouble(price);
+        }
+
+        Money moneyBackward{};
+        for (auto it{ prices.rbegin() }; it != prices.rend(); ++it) {
+            moneyBackward += Money::fromDouble(*it);
+        }
+
+        std::println("Money:  {} == {}", moneyForward, moneyBackward);
+
+        // an overflow is detected instead of silently wrapping around
+        try {
+            Money price{ Money::fromDouble(1e15) };
+            Money total{ price * 100000 };
+            std::println("Total: {}", total);
+        }
+        catch (const std::overflow_error& ex) {
+            std::println("Exception: {}", ex.what());
+        }
+    }
+
+    static void test_bookstore_type_erasure_08() {
+
+        std::println("Overflow of the Total Value - using Type Erasure");
+
+        // each value fits into 'Money', the sum of both doesn't
+        const Book cBook{ "C", "Dennis Ritchie", 5e13, 1000 };
+        const Movie movieBond{ "Spectre", "Sam Mendes", 5e13, 1000 };
+
+        Bookstore<Book, Movie> bookstore{ cBook };
+        SegregatedBookstore<Book, Movie> segregated{ cBook };
+
+        auto tryAdd{ [](auto add) {
+            try {
+                add();
+            }
+            catch (const std::overflow_error& ex) {
+                std::println("Exception: {}", ex.what());
+            }
+        } };
+
+        tryAdd([&] { bookstore.addMedia(movieBond); });
+        tryAdd([&] { bookstore.addMediaEx(movieBond); });
+        tryAdd([&] { segregated.addMedia(movieBond); });
+
+        // both bookstores remain unchanged
+        std::println("Size: {}, Count: {}, Total value: {}, Aggregates verified: {}",
+            bookstore.size(), bookstore.count(), bookstore.totalBalance(), bookstore.checkAggregates());
+        std::println("Size: {}, Count: {}, Total value: {}, Aggregates verified: {}",
+            segregated.size(), segregated.count(), segregated.totalBalance(), segregated.checkAggregates());
+    }
 }
 
 // =====================================================================================
@@ -681,11 +551,16 @@ void main_type_erasure()
     BookStoreUsingDynamicPolymorphism::test_bookstore_polymorphic_02();
     BookStoreUsingDynamicPolymorphism::test_bookstore_polymorphic_03();
     BookStoreUsingDynamicPolymorphism::test_bookstore_polymorphic_04();
+    BookStoreUsingDynamicPolymorphism::test_bookstore_polymorphic_05();
+    BookStoreUsingDynamicPolymorphism::test_bookstore_polymorphic_06();
 
     BookStoreUsingTypeErasure::test_bookstore_type_erasure_01();
     BookStoreUsingTypeErasure::test_bookstore_type_erasure_02();
     BookStoreUsingTypeErasure::test_bookstore_type_erasure_03();
     BookStoreUsingTypeErasure::test_bookstore_type_erasure_04();
+    BookStoreUsingTypeErasure::test_bookstore_type_erasure_06();
+    BookStoreUsingTypeErasure::test_bookstore_type_erasure_07();
+    BookStoreUsingTypeErasure::test_bookstore_type_erasure_08();
 }
 
 // =====================================================================================
@@ -0,0 +1,293 @@
+// =====================================================================================
+// TypeErasureSbo.cpp // Type Erasure with Small Buffer Optimization
+// =====================================================================================
+
+module;
+
+#include "../ScopedTimer/ScopedTimer.h"
+
+module modern_cpp:type_erasure;
+
+import :sbo_value;
+
+// =====================================================================================
+
+namespace TypeErasureUsingSmallBufferOptimization {
+
+    class Dog
+    {
+    public:
+        std::string see() const { return "dog"; }
+        std::string say() const { return "woof"; }
+    };
+
+    class Cat
+    {
+    public:
+        std::string see() const { return "cat"; }
+        std::string say() const { return "meow"; }
+    };
+
+    // not trivially copyable: moved with its move constructor, if stored inline
+    class Parrot
+    {
+    private:
+        std::string m_phrase;
+
+    public:
+        Parrot(std::string phrase) : m_phrase{ phrase } {}
+
+        std::string see() const { return "parrot"; }
+        std::string say() const { return m_phrase; }
+    };
+
+    // trivially copyable, but too large for a 32 bytes buffer
+    class Elephant
+    {
+    private:
+        std::array<double, 6> m_weights{};
+
+    public:
+        std::string see() const { return "elephant"; }
+        std::string say() const { return "toot"; }
+    };
+
+    struct AnimalConcept : public SboConcept<AnimalConcept>
+    {
+        virtual std::string see() const = 0;
+        virtual std::string say() const = 0;
+    };
+
+    template<typename T>
+    concept ClassActingLikeAnAnimal = requires (const T & o)
+    {
+        { o.see() } -> std::same_as<std::string>;
+        { o.say() } -> std::same_as<std::string>;
+    };
+
+    template <typename T>
+        requires ClassActingLikeAnAnimal<T>
+    struct AnimalModel : public AnimalConcept
+    {
+        AnimalModel(const T& object) : m_object{ object } {}
+        AnimalModel(T&& object) : m_object{ std::move(object) } {}
+
+        std::string see() const override { return m_object.see(); }
+        std::string say() const override { return m_object.say(); }
+
+        T m_object;
+    };
+
+    // the buffer contains the model object including its vtable pointer
+    using SmallAnimal = SboValue<AnimalConcept, AnimalModel, 32>;
+    using Animal = SboValue<AnimalConcept, AnimalModel, 64>;
+
+    template <typename TAnimal>
+    static void printAnimals(const std::vector<TAnimal>& animals)
+    {
+        std::println("Buffer size: {}", TAnimal::bufferSize());
+
+        for (const auto& animal : animals) {
+            std::println("{:<8}: {:<22} [inline: {}, relocatable: {}]",
+                animal->see(), animal->say(), animal.isInline(), animal.isRelocatable());
+        }
+        std::println();
+    }
+
+    static void test_sbo_01()
+    {
+        std::vector<SmallAnimal> smallAnimals{ Cat{}, Dog{}, Parrot{ "Polly wants a cracker" }, Elephant{} };
+        printAnimals(smallAnimals);
+
+        std::vector<Animal> animals{ Cat{}, Dog{}, Parrot{ "Polly wants a cracker" }, Elephant{} };
+        printAnimals(animals);
+    }
+
+    static void test_sbo_02()
+    {
+        // value semantics: copies are independent objects
+        Animal parrot{ Parrot{ "Hello" } };
+        Animal copy{ parrot };
+        copy = Parrot{ "Goodbye" };
+
+        std::println("{}: {}", parrot->see(), parrot->say());   // Hello
+        std::println("{}: {}", copy->see(), copy->say());       // Goodbye
+
+        // moving never throws, std::vector uses the move c'tor when reallocating
+        static_assert(std::is_nothrow_move_constructible_v<Animal>);
+
+        Animal moved{ std::move(parrot) };
+        std::println("{}: {}", moved->see(), moved->say());     // Hello
+
+        // a moved-from object is empty, but may still be copied, moved and assigned
+        Animal empty{ parrot };
+        Animal alsoEmpty{ std::move(empty) };
+        parrot = std::move(alsoEmpty);
+        parrot = moved;
+        std::println("{}: {}", parrot->see(), parrot->say());   // Hello
+
+        // a smaller buffer moves the elephant onto the heap
+        SmallAnimal elephant{ Elephant{} };
+        std::println("{}: inline: {}", elephant->see(), elephant.isInline());
+        std::println();
+    }
+
+    // =================================================================================
+
+    struct IAnimal
+    {
+        virtual ~IAnimal() = default;
+        virtual std::string see() const = 0;
+        virtual std::string say() const = 0;
+    };
+
+    class DogEx : public IAnimal
+    {
+    public:
+        std::string see() const override { return "dog"; }
+        std::string say() const override { return "woof"; }
+    };
+
+    class ParrotEx : public IAnimal
+    {
+    private:
+        std::string m_phrase;
+
+    public:
+        ParrotEx(std::string phrase) : m_phrase{ phrase } {}
+
+        std::string see() const override { return "parrot"; }
+        std::string say() const override { return m_phrase; }
+    };
+
+    constexpr size_t NumAnimals{ 1000000 };
+    constexpr size_t NumIterations{ 10 };
+
+    template <typename TAnimal>
+    static std::vector<TAnimal> createAnimals()
+    {
+        std::vector<TAnimal> animals;
+        animals.reserve(NumAnimals);
+
+        for (size_t i{}; i != NumAnimals; ++i) {
+            if (i % 2 == 0) {
+                animals.push_back(Dog{});
+            }
+            else {
+                animals.push_back(Parrot{ "Polly" });
+            }
+        }
+
+        return animals;
+    }
+
+    static void test_sbo_03_benchmark()
+    {
+        std::println("Benchmark - Construction of {} Animals", NumAnimals);
+
+        std::vector<std::shared_ptr<IAnimal>> sharedAnimals;
+        std::vector<SmallAnimal> smallAnimals;
+        std::vector<Animal> animals;
+
+        {
+            std::print("std::vector<std::shared_ptr<IAnimal>>: ");
+            ScopedTimer watch{};
+
+            sharedAnimals.reserve(NumAnimals);
+            for (size_t i{}; i != NumAnimals; ++i) {
+                if (i % 2 == 0) {
+                    sharedAnimals.push_back(std::make_shared<DogEx>());
+                }
+                else {
+                    sharedAnimals.push_back(std::make_shared<ParrotEx>("Polly"));
+                }
+            }
+        }
+
+        {
+            std::print("std::vector<SboValue> (32 Bytes):      ");
+            ScopedTimer watch{};
+
+            smallAnimals = createAnimals<SmallAnimal>();
+        }
+
+        {
+            std::print("std::vector<SboValue> (64 Bytes):      ");
+            ScopedTimer watch{};
+
+            animals = createAnimals<Animal>();
+        }
+
+        std::println("Benchmark - Iterating {} Animals", NumAnimals);
+
+        {
+            std::print("std::vector<std::shared_ptr<IAnimal>>: ");
+            ScopedTimer watch{};
+
+            size_t total{};
+            for (size_t n{}; n != NumIterations; ++n) {
+                for (const auto& animal : sharedAnimals) {
+                    total += animal->say().size();
+                }
+            }
+            std::print("{} - ", total);
+        }
+
+        {
+            std::print("std::vector<SboValue> (32 Bytes):      ");
+            ScopedTimer watch{};
+
+            size_t total{};
+            for (size_t n{}; n != NumIterations; ++n) {
+                for (const auto& animal : smallAnimals) {
+                    total += animal->say().size();
+                }
+            }
+            std::print("{} - ", total);
+        }
+
+        {
+            std::print("std::vector<SboValue> (64 Bytes):      ");
+            ScopedTimer watch{};
+
+            size_t total{};
+            for (size_t n{}; n != NumIterations; ++n) {
+                for (const auto& animal : animals) {
+                    total += animal->say().size();
+                }
+            }
+            std::print("{} - ", total);
+        }
+
+        std::println("Benchmark - Copying {} Animals", NumAnimals);
+
+        {
+            std::print("std::vector<std::shared_ptr<IAnimal>>: ");
+            ScopedTimer watch{};
+
+            auto copy{ sharedAnimals };
+        }
+
+        {
+            std::print("std::vector<SboValue> (64 Bytes):      ");
+            ScopedTimer watch{};
+
+            auto copy{ animals };
+        }
+    }
+}
+
+// =====================================================================================
+
+void main_type_erasure_sbo()
+{
+    using namespace TypeErasureUsingSmallBufferOptimization;
+
+    test_sbo_01();
+    test_sbo_02();
+    test_sbo_03_benchmark();
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================
@@ -0,0 +1,292 @@
+// =====================================================================================
+// TypeErasureStaticVtable.cpp // Type Erasure with Static Function Pointer Tables
+// =====================================================================================
+
+module;
+
+#include "../ScopedTimer/ScopedTimer.h"
+
+module modern_cpp:type_erasure;
+
+import :bookstore;
+import :static_vtable;
+
+// =====================================================================================
+
+namespace TypeErasureUsingStaticVtables {
+
+    class Dog
+    {
+    public:
+        std::string see() const { return "dog"; }
+        std::string say() const { return "woof"; }
+    };
+
+    class Cat
+    {
+    public:
+        std::string see() const { return "cat"; }
+        std::string say() const { return "meow"; }
+    };
+
+    // table of function pointers, one instance per concrete type
+    struct AnimalInterface
+    {
+        std::string (*m_see)(const void*);
+        std::string (*m_say)(const void*);
+
+        template <typename T>
+        static constexpr AnimalInterface forType()
+        {
+            return {
+                [](const void* object) { return static_cast<const T*>(object)->see(); },
+                [](const void* object) { return static_cast<const T*>(object)->say(); }
+            };
+        }
+    };
+
+    class Animal : public StaticVtableValue<AnimalInterface>
+    {
+    public:
+        using StaticVtableValue::StaticVtableValue;
+
+        std::string see() const { return vtable().m_see(object()); }
+        std::string say() const { return vtable().m_say(object()); }
+    };
+
+    static void test_static_vtable_01()
+    {
+        std::vector<Animal> animals{ Cat{}, Dog{} };
+
+        for (const auto& animal : animals) {
+            std::println("{}: {}", animal.see(), animal.say());
+        }
+
+        // value semantics
+        Animal animal{ animals[0] };
+        animal = Dog{};
+        std::println("{}: {} - {}: {}", animal.see(), animal.say(), animals[0].see(), animals[0].say());
+        std::println();
+    }
+
+    // =================================================================================
+
+    // the media types of the bookstore with type erasure (Bookstore.ixx)
+    using BookStoreUsingTypeErasure::Book;
+    using BookStoreUsingTypeErasure::Movie;
+
+    struct MediaInterface
+    {
+        double (*m_getPrice)(const void*);
+        size_t (*m_getCount)(const void*);
+
+        template <typename T>
+        static constexpr MediaInterface forType()
+        {
+            return {
+                [](const void* object) { return static_cast<const T*>(object)->getPrice(); },
+                [](const void* object) { return static_cast<const T*>(object)->getCount(); }
+            };
+        }
+    };
+
+    constexpr size_t MediaBufferSize{ sizeof(Book) > sizeof(Movie) ? sizeof(Book) : sizeof(Movie) };
+
+    class Media : public StaticVtableValue<MediaInterface, MediaBufferSize>
+    {
+    public:
+        using StaticVtableValue::StaticVtableValue;
+
+        double getPrice() const { return vtable().m_getPrice(object()); }
+        size_t getCount() const { return vtable().m_getCount(object()); }
+    };
+
+    // single method interface: the function pointer is stored in the object itself
+    struct BalanceInterface
+    {
+        double (*m_balance)(const void*);
+
+        template <typename T>
+        static constexpr BalanceInterface forType()
+        {
+            return {
+                [](const void* object) {
+                    const T* media{ static_cast<const T*>(object) };
+                    return media->getPrice() * media->getCount();
+                }
+            };
+        }
+    };
+
+    class MediaBalance : public StaticVtableValue<BalanceInterface, MediaBufferSize, VtablePlacement::Inline>
+    {
+    public:
+        using StaticVtableValue::StaticVtableValue;
+
+        double balance() const { return vtable().m_balance(object()); }
+    };
+
+    static void test_static_vtable_02()
+    {
+        std::vector<Media> stock{
+            Book{ "C", "Dennis Ritchie", 11.99, 12 },
+            Movie{ "Spectre", "Sam Mendes", 8.99, 6 },
+            Book{ "C++", "Bjarne Stroustrup", 16.99, 4 }
+        };
+
+        double total{};
+        for (const auto& media : stock) {
+            total += media.getPrice() * media.getCount();
+        }
+        std::println("Total value of Bookstore: {:.{}f}", total, 2);
+
+        std::vector<MediaBalance> balances{
+            Book{ "C", "Dennis Ritchie", 11.99, 12 },
+            Movie{ "Spectre", "Sam Mendes", 8.99, 6 },
+            Book{ "C++", "Bjarne Stroustrup", 16.99, 4 }
+        };
+
+        total = 0.0;
+        for (const auto& media : balances) {
+            total += media.balance();
+        }
+        std::println("Total value of Bookstore: {:.{}f}", total, 2);
+
+        std::println("sizeof(Media):        {}", sizeof(Media));
+        std::println("sizeof(MediaBalance): {}", sizeof(MediaBalance));
+        std::println();
+    }
+
+    // =================================================================================
+
+    // reference: the same media with virtual methods (see :bookstore)
+    namespace Polymorphic = BookStoreUsingDynamicPolymorphism;
+
+    constexpr size_t NumMedia{ 1000000 };
+    constexpr size_t NumIterations{ 20 };
+    constexpr size_t NumCalls{ 100000000 };
+
+    static void test_static_vtable_03_benchmark()
+    {
+        Book cBook{ "C", "Dennis Ritchie", 11.99, 12 };
+        Movie movieBond{ "Spectre", "Sam Mendes", 8.99, 6 };
+
+        Polymorphic::Book cBookVirtual{ "C", "Dennis Ritchie", 11.99, 12 };
+        Polymorphic::Movie movieBondVirtual{ "Spectre", "Sam Mendes", 8.99, 6 };
+
+        std::vector<std::shared_ptr<Polymorphic::IMedia>> virtualStock;
+        std::vector<Media> staticStock;
+        std::vector<MediaBalance> inlineStock;
+
+        virtualStock.reserve(NumMedia);
+        staticStock.reserve(NumMedia);
+        inlineStock.reserve(NumMedia);
+
+        for (size_t i{}; i != NumMedia; ++i) {
+            if (i % 2 == 0) {
+                virtualStock.push_back(std::make_shared<Polymorphic::Book>(cBookVirtual));
+                staticStock.push_back(cBook);
+                inlineStock.push_back(cBook);
+            }
+            else {
+                virtualStock.push_back(std::make_shared<Polymorphic::Movie>(movieBondVirtual));
+                staticStock.push_back(movieBond);
+                inlineStock.push_back(movieBond);
+            }
+        }
+
+        std::println("Benchmark - Call Latency ({} Calls on one Object)", NumCalls);
+
+        {
+            std::print("Virtual Methods:       ");
+            ScopedTimer watch{};
+
+            const Polymorphic::IMedia& media{ *virtualStock[NumMedia / 2] };
+            double total{};
+            for (size_t i{}; i != NumCalls; ++i) {
+                total += media.getPrice() * media.getCount();
+            }
+            std::print("{:.0f} - ", total);
+        }
+
+        {
+            std::print("Static Vtable:         ");
+            ScopedTimer watch{};
+
+            const Media& media{ staticStock[NumMedia / 2] };
+            double total{};
+            for (size_t i{}; i != NumCalls; ++i) {
+                total += media.getPrice() * media.getCount();
+            }
+            std::print("{:.0f} - ", total);
+        }
+
+        {
+            std::print("Inline Vtable:         ");
+            ScopedTimer watch{};
+
+            const MediaBalance& media{ inlineStock[NumMedia / 2] };
+            double total{};
+            for (size_t i{}; i != NumCalls; ++i) {
+                total += media.balance();
+            }
+            std::print("{:.0f} - ", total);
+        }
+
+        std::println("Benchmark - Throughput ({} x {} Objects)", NumIterations, NumMedia);
+
+        {
+            std::print("Virtual Methods:       ");
+            ScopedTimer watch{};
+
+            double total{};
+            for (size_t n{}; n != NumIterations; ++n) {
+                for (const auto& media : virtualStock) {
+                    total += media->getPrice() * media->getCount();
+                }
+            }
+            std::print("{:.0f} - ", total);
+        }
+
+        {
+            std::print("Static Vtable:         ");
+            ScopedTimer watch{};
+
+            double total{};
+            for (size_t n{}; n != NumIterations; ++n) {
+                for (const auto& media : staticStock) {
+                    total += media.getPrice() * media.getCount();
+                }
+            }
+            std::print("{:.0f} - ", total);
+        }
+
+        {
+            std::print("Inline Vtable:         ");
+            ScopedTimer watch{};
+
+            double total{};
+            for (size_t n{}; n != NumIterations; ++n) {
+                for (const auto& media : inlineStock) {
+                    total += media.balance();
+                }
+            }
+            std::print("{:.0f} - ", total);
+        }
+    }
+}
+
+// =====================================================================================
+
+void main_type_erasure_static_vtable()
+{
+    using namespace TypeErasureUsingStaticVtables;
+
+    test_static_vtable_01();
+    test_static_vtable_02();
+    test_static_vtable_03_benchmark();
+}
+
+// =====================================================================================
+// End-of-File
+// =====================================================================================